@@ -30,7 +30,9 @@ extern "C"
 
   /**
    *  @brief      init NTIA NN system and PCIe card initialization
-   *  @details    TODO ...
+   *  @details    every call creates independent handle (own transport state), so process
+   *              may hold several handles (one per card) and use them concurrently
+   *              (every handle must be used by one thread at a time)
    *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
    *  @param[in]  devs_list pointer to nta_pcidev_list_t struct for get list of devices in system
    *              must be allocated in programm
@@ -38,6 +40,18 @@ extern "C"
    */
   enum ntpcie_nn_error_t NTIA_API ntpcie_sys_init(struct nta_dev_handle_t  * const dev_handle,
                                                   struct nta_pcidev_list_t * const devs_list);
+  /**
+   *  @brief      init NTIA NN system (with options) and PCIe card initialization
+   *  @details    same as ntpcie_sys_init, but IO transport (sysfs, VFIO, UMDFv2, emulator) is selected at runtime
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  devs_list pointer to nta_pcidev_list_t struct for get list of devices in system
+   *              must be allocated in programm
+   *  @param[in]  options pointer to options of init (NULL - default options)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_sys_init_ex(struct nta_dev_handle_t  * const dev_handle,
+                                                     struct nta_pcidev_list_t * const devs_list,
+                                                     const struct nta_sys_options_t * const options);
   /**
    *  @brief      deinit NTIA NN system and PCIe card
    *  @details    TODO
@@ -76,6 +90,110 @@ extern "C"
    */
   enum ntpcie_nn_error_t NTIA_API ntpcie_device_reset(struct nta_dev_handle_t * const dev_handle);
 
+  /**
+   *  @brief      start IO thread (and lock-free submission queue) of card
+   *  @details    after start API calls for card from any number of application threads are
+   *              passed to IO thread of card and executed one by one (caller waits for result),
+   *              i.e. device handle may be shared by threads without external locking;
+   *              handle (nta_dev_handle_t) must not be moved while IO thread is running
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card (card must be opened)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_device_queue_start(struct nta_dev_handle_t * const dev_handle);
+
+  /**
+   *  @brief      stop IO thread of card
+   *  @details    requests already submitted are finished, then IO thread is joined
+   *              (there must be no concurrent API calls for card); called by ntpcie_device_close()
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_device_queue_stop(struct nta_dev_handle_t * const dev_handle);
+
+  /**
+   *  @brief      get state of IO thread of card
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[out] started true - IO thread is running (see ntpcie_device_queue_start)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_device_queue_is_started(const struct nta_dev_handle_t * const dev_handle,
+                               bool * const started);
+
+  /**
+   *  @brief      start cache of classify results of card
+   *  @details    ntpcie_nn_vector_classify() of request (context, dist_eval, classifier, number of
+   *              responses, components) classified already is answered from cache without card;
+   *              least recently used results are replaced; cache is dropped by every change of
+   *              knowledge base (learn, ntpcie_nn_reset(), register write, KB load, device reset);
+   *              while asynchronous requests are pending NTPCIE_ERROR_BUSY is returned as without
+   *              cache; started cache is replaced by new (empty) one
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  entries_count max amount of cached results (1 .. 2^20, ~800 bytes per entry)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_device_cache_start(struct nta_dev_handle_t * const dev_handle,
+                               const size_t entries_count);
+
+  /**
+   *  @brief      stop (and free) cache of classify results of card
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_device_cache_stop(struct nta_dev_handle_t * const dev_handle);
+
+  /**
+   *  @brief      set max time of single wait for card
+   *  @details    every wait for card (ready, results) ends with NTPCIE_ERROR_WAIT_TIMEOUT after
+   *              timeout_ns of wall-clock time, independently of speed of host and PCIe reads
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  timeout_ns max time of wait in nanoseconds (0 - default, NTPCIE_TIMEOUT_STD_NS)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_device_timeout_set(struct nta_dev_handle_t * const dev_handle,
+                               const uint64_t timeout_ns);
+
+  /**
+   *  @brief      set deadline of calls for card
+   *  @details    all waits for card of following calls end by deadline (NTPCIE_ERROR_WAIT_TIMEOUT),
+   *              even if timeout of handle isn't over yet; deadline of single call is set by
+   *              ntpcie_clock_now_ns() + budget before call and cleared (0) after it
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  deadline_ns time of ntpcie_clock_now_ns() (0 - no deadline)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_device_deadline_set(struct nta_dev_handle_t * const dev_handle,
+                               const uint64_t deadline_ns);
+
+  /**
+   *  @brief      monotonic time in nanoseconds (origin is undefined, only differences are meaningful)
+   *  @return     current time (for ntpcie_device_deadline_set())
+   */
+  uint64_t NTIA_API ntpcie_clock_now_ns(void);
+
+  /**
+   *  @brief      get latency statistics of card operations
+   *  @details    for every operation (enum nn_stats_oper_t) count, total and max latency and
+   *              histogram of latencies with log2 buckets of nanoseconds (NN_STATS_BUCKETS) are
+   *              returned; time of call is split to phases too (enum nn_stats_phase_t: validate,
+   *              pack build, wait ready, upload, compute, readback), phase_total_ns is total time
+   *              of phase (async requests are counted in latency only); latency is taken from
+   *              API call (queued operations include wait in queue), requests answered by cache
+   *              of classify results are counted in cache_hits (and in count/latency too);
+   *              statistics are kept since device open or ntpcie_stats_reset()
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[out] stats statistics of card operations
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_stats_get(struct nta_dev_handle_t * const dev_handle,
+                               struct nn_stats_t * const stats);
+
+  /**
+   *  @brief      clear latency statistics of card operations
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_stats_reset(struct nta_dev_handle_t * const dev_handle);
+
   /// NN service functions
   /**
    *  @brief      reset (soft) neuron net (FORGET)
@@ -109,6 +227,61 @@ extern "C"
                                const size_t   comps_count,
                                const nn_vector_comp_t data_vector[]);
 
+  /**
+   *  @brief      Learn vector, outcome of learn is returned too
+   *  @details    outcome is derived from answer of card (category of closest fired neuron and
+   *              committed neurons count) and committed neurons count before learn, so training
+   *              loops may skip recognized vectors and stop on full NN without classify of vector;
+   *              outcome is set of flags: COMMITTED and SHRUNK may be set together, SHRUNK is not
+   *              reported when the closest fired neuron has category of vector (farther neurons of
+   *              other category may still shrink), category 0 gives only SHRUNK or NONE
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  category
+   *  @param[in]  maxif
+   *  @param[in]  minif
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @param[out] result category, ncount and outcome (NN_LEARN_... flags) of learn (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_learn_ex(struct nta_dev_handle_t * const dev_handle,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const uint16_t category,
+                               const uint16_t maxif,
+                               const uint16_t minif,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               struct nn_learn_result_t * const result);
+
+  /**
+   *  @brief      Learn batch of vectors (in one call)
+   *  @details    all records are checked before first vector is sent,
+   *              common part of pack header is built once, card "ready" state is checked
+   *              before every record (single read of status register when card is ready)
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  dist_eval
+   *  @param[in]  maxif
+   *  @param[in]  minif
+   *  @param[in]  comps_count components count in every vector
+   *  @param[in]  records_count amount of records in batch
+   *  @param[in]  records array of (context, category, vector) records
+   *  @param[out] results array (records_count size) with ncount, category and outcome for every vector (may be NULL)
+   *  @param[out] records_done amount of vectors learned successfully (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vectors_learn_batch(struct nta_dev_handle_t * const dev_handle,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t maxif,
+                               const uint16_t minif,
+                               const size_t comps_count,
+                               const size_t records_count,
+                               const struct nn_learn_record_t records[],
+                               struct nn_learn_result_t results[],
+                               size_t * const records_done);
+
   /**
    *  @brief          Classify vector
    *  @details        TODO
@@ -131,6 +304,427 @@ extern "C"
                                size_t * const number_of_responses,
                                struct response_neuron_state_t resp[]);
 
+  /**
+   *  @brief          Classify vector, recognition status of card is returned too
+   *  @details        status (fired neurons count, ID and UNC flags) comes with first word of results,
+   *                  so request of status only (number_of_responses 0, resp may be NULL) reads
+   *                  back single word from card
+   *  @param[in]      dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]      dist_eval
+   *  @param[in]      context
+   *  @param[in]      classifier
+   *  @param[in]      comps_count
+   *  @param[in]      data_vector
+   *  @param[in/out]  number_of_responses [in] - desired number of responses (0 - status only); [out] - real number of responses
+   *  @param[out]     resp array with recognize results (must be at least number_of_responses[in] size)
+   *  @param[out]     status recognition status of vector (may be NULL, then at least 1 response must be requested)
+   *  @return         status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_classify_ex(struct nta_dev_handle_t * const dev_handle,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               size_t * const number_of_responses,
+                               struct response_neuron_state_t resp[],
+                               struct nn_classify_status_t * const status);
+
+  /**
+   *  @brief          Classify vector, asking more responses of card only if they are needed
+   *  @details        vector is classified with answers_first responses first; it is classified again
+   *                  with number_of_responses[in] responses only if card fired more neurons than returned
+   *                  and result is uncertain (UNC) or category of some returned neuron is degenerated;
+   *                  number_of_responses[out] <= answers_first means that one query was enough
+   *  @param[in]      dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]      dist_eval
+   *  @param[in]      context
+   *  @param[in]      classifier
+   *  @param[in]      comps_count
+   *  @param[in]      data_vector
+   *  @param[in]      answers_first number of responses of first query (1 is enough to decide most vectors)
+   *  @param[in/out]  number_of_responses [in] - max number of responses; [out] - real number of responses
+   *  @param[out]     resp array with recognize results (must be at least number_of_responses[in] size)
+   *  @param[out]     status recognition status of vector (of last query, may be NULL)
+   *  @return         status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_classify_adaptive(struct nta_dev_handle_t * const dev_handle,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               const size_t answers_first,
+                               size_t * const number_of_responses,
+                               struct response_neuron_state_t resp[],
+                               struct nn_classify_status_t * const status);
+
+  /**
+   *  @brief          Classify batch of vectors (in one call)
+   *  @details        arguments are checked once for whole batch, pack header is built once,
+   *                  only components are copied per vector; card "ready" state is checked before
+   *                  every pack (single read of status register when card is ready);
+   *                  vector #i is taken from data_vectors[i * vectors_stride],
+   *                  its responses are placed to resp[i * number_of_responses]
+   *  @param[in]      dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]      dist_eval
+   *  @param[in]      context
+   *  @param[in]      classifier
+   *  @param[in]      comps_count components count in every vector
+   *  @param[in]      vectors_count amount of vectors in batch (at least 1)
+   *  @param[in]      data_vectors buffer with vectors (array of vectors or strided buffer)
+   *  @param[in]      vectors_stride distance (in components) between vectors in data_vectors (0 - equal to comps_count)
+   *  @param[in]      number_of_responses desired number of responses for every vector
+   *  @param[out]     responses_count array (vectors_count size) with real number of responses for every vector
+   *  @param[out]     resp array with recognize results (must be at least vectors_count * number_of_responses size)
+   *  @param[out]     vectors_done amount of vectors classified successfully (may be NULL)
+   *  @return         status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vectors_classify_batch(struct nta_dev_handle_t * const dev_handle,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t comps_count,
+                               const size_t vectors_count,
+                               const nn_vector_comp_t data_vectors[],
+                               const size_t vectors_stride,
+                               const size_t number_of_responses,
+                               size_t responses_count[],
+                               struct response_neuron_state_t resp[],
+                               size_t * const vectors_done);
+
+  /**
+   *  @brief          Classify batch of vectors given by array of pointers (in one call)
+   *  @details        same as ntpcie_nn_vectors_classify_batch(), but vector #i is taken from vectors[i]
+   *                  (vectors don't need to be placed in one buffer)
+   *  @param[in]      dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]      dist_eval
+   *  @param[in]      context
+   *  @param[in]      classifier
+   *  @param[in]      comps_count components count in every vector
+   *  @param[in]      vectors_count amount of vectors in batch (at least 1)
+   *  @param[in]      vectors array (vectors_count size) of pointers to vectors
+   *  @param[in]      number_of_responses desired number of responses for every vector
+   *  @param[out]     responses_count array (vectors_count size) with real number of responses for every vector
+   *  @param[out]     resp array with recognize results (must be at least vectors_count * number_of_responses size)
+   *  @param[out]     vectors_done amount of vectors classified successfully (may be NULL)
+   *  @return         status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vectors_classify_batch_ptr(struct nta_dev_handle_t * const dev_handle,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t comps_count,
+                               const size_t vectors_count,
+                               const nn_vector_comp_t * const vectors[],
+                               const size_t number_of_responses,
+                               size_t responses_count[],
+                               struct response_neuron_state_t resp[],
+                               size_t * const vectors_done);
+
+  /**
+   *  @brief      Submit vector to classify (asynchronous, returns without waiting for results)
+   *  @details    pack is uploaded to card at once if card is idle, otherwise it is queued (up to
+   *              NTPCIE_ASYNC_DEPTH requests per card) and uploaded by ntpcie_poll_completions();
+   *              synchronous NN calls return NTPCIE_ERROR_BUSY until all submitted requests are polled;
+   *              pending requests are dropped by ntpcie_device_reset() and ntpcie_device_close()
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  classifier
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components (copied, may be reused after return)
+   *  @param[in]  number_of_responses max amount of responses
+   *  @param[out] resp[] responses of NN, filled at completion (must be valid until request is polled)
+   *  @param[out] token token of request (the same token is reported by completion)
+   *  @return     status of operation (NTPCIE_ERROR_..., NTPCIE_ERROR_BUSY - too many requests in flight)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_submit_classify(struct nta_dev_handle_t * const dev_handle,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               const size_t   number_of_responses,
+                               struct response_neuron_state_t resp[],
+                               uint32_t * const token);
+
+  /**
+   *  @brief      Poll completions of asynchronous requests (non-blocking)
+   *  @details    requests are completed in order of submission; next queued request is uploaded
+   *              to card as soon as results of previous one are read; request which isn't done by
+   *              card within timeout/deadline of handle (from its upload) is completed with
+   *              NTPCIE_ERROR_WAIT_TIMEOUT; after timeout or failed read of card status, requests
+   *              not uploaded yet are completed with the same error (state of card is unknown)
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[out] completions[] array for completions
+   *  @param[in]  completions_max size of completions[]
+   *  @param[out] completions_count amount of completions returned (0 - card is still busy or nothing submitted)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_poll_completions(struct nta_dev_handle_t * const dev_handle,
+                               struct nta_completion_t completions[],
+                               const size_t completions_max,
+                               size_t * const completions_count);
+
+  /// card groups (one logical knowledge base spread over several cards)
+
+  /**
+   *  @brief      init group of cards
+   *  @details    every card of group holds partition of knowledge base; cards must be opened
+   *              and stay opened while group is used
+   *  @param[out] group group to init
+   *  @param[in]  cards[] handles of cards
+   *  @param[in]  cards_count amount of cards (1 .. NTIA_PCIE_MAX_CARDS)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_group_init(struct nta_card_group_t * const group,
+                               struct nta_dev_handle_t * const cards[],
+                               const size_t cards_count);
+
+  /**
+   *  @brief      reset (soft) neuron nets of all cards of group (FORGET)
+   *  @param[in]  group group of cards
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_group_nn_reset(struct nta_card_group_t * const group);
+
+  /**
+   *  @brief      Learn vector by group
+   *  @details    group learns as single card holding whole KB: RBF classify of group is run first,
+   *              vector recognized by some card is not committed, otherwise it is committed by card
+   *              with most free neurons (partitions are kept balanced); fired neurons of other
+   *              category are shrunk on every card; NB: only NN_MAX_RESP_COUNT closest neurons of
+   *              every card are seen by classify, new neuron limited by other card down to MINIF
+   *              is not marked degenerated
+   *  @param[in]  group group of cards
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  category
+   *  @param[in]  maxif
+   *  @param[in]  minif
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @param[out] card_ix index of card (in group) which committed or recognized vector
+   *              (NTIA_PCIE_MAX_CARDS - category 0), may be NULL
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_group_vector_learn(struct nta_card_group_t * const group,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const uint16_t category,
+                               const uint16_t maxif,
+                               const uint16_t minif,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               size_t * const card_ix);
+
+  /**
+   *  @brief      Classify vector by group
+   *  @details    vector is classified by all cards in parallel, responses of cards are merged
+   *              by distance into one list of closest responses (top-K, K <= NN_MAX_RESP_COUNT);
+   *              cards must not have asynchronous requests of application pending (NTPCIE_ERROR_BUSY);
+   *              requests of group are completed on all cards before return (card which doesn't
+   *              respond within its timeout/deadline fails call by NTPCIE_ERROR_WAIT_TIMEOUT)
+   *  @param[in]  group group of cards
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  classifier
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @param[in,out] number_of_responses max amount of responses / amount of responses returned
+   *  @param[out] resp[] merged responses (neuron id is id inside of card)
+   *  @param[out] resp_cards_ix[] index of card (in group) of every response (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_group_vector_classify(struct nta_card_group_t * const group,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               size_t * const number_of_responses,
+                               struct response_neuron_state_t resp[],
+                               size_t resp_cards_ix[]);
+
+  /// card pools (the same knowledge base replicated on several cards)
+
+  /**
+   *  @brief      init pool of cards
+   *  @details    every card of pool holds replica of knowledge base; IO threads of cards are
+   *              started (see ntpcie_device_queue_start), so pool may be used by any number of
+   *              application threads; cards must stay opened while pool is used; if init fails
+   *              IO threads started by it are stopped (cards are left as they were)
+   *  @param[out] pool pool to init
+   *  @param[in]  cards[] handles of opened cards
+   *  @param[in]  cards_count amount of cards (1 .. NTIA_PCIE_MAX_CARDS)
+   *  @return     status of operation (NTPCIE_ERROR_INVALID_HANDLE - invalid handle or the same card
+   *              given twice)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_pool_init(struct nta_card_pool_t * const pool,
+                               struct nta_dev_handle_t * const cards[],
+                               const size_t cards_count);
+
+  /**
+   *  @brief      deinit pool of cards (cards stay opened)
+   *  @param[in]  pool pool of cards
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_pool_deinit(struct nta_card_pool_t * const pool);
+
+  /**
+   *  @brief      reset (soft) neuron nets of all cards of pool (FORGET)
+   *  @details    replicas are consistent again: cards excluded after failed learn are served again
+   *              (except cards which failed reset)
+   *  @param[in]  pool pool of cards
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_pool_nn_reset(struct nta_card_pool_t * const pool);
+
+  /**
+   *  @brief      Learn vector by all cards of pool
+   *  @details    learns of concurrent threads are serialized: all replicas stay identical;
+   *              card which fails learn holds diverged replica: it is excluded from classify
+   *              till ntpcie_pool_nn_reset, other cards learn vector anyway (status of first
+   *              failed card is returned; NTPCIE_ERROR_POOL_INCONSISTENT - no card left)
+   *  @param[in]  pool pool of cards
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  category
+   *  @param[in]  maxif
+   *  @param[in]  minif
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @param[out] card_ix index of first card (in pool) which failed learn (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_pool_vector_learn(struct nta_card_pool_t * const pool,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const uint16_t category,
+                               const uint16_t maxif,
+                               const uint16_t minif,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               size_t * const card_ix);
+
+  /**
+   *  @brief      Classify vector by least loaded card of pool
+   *  @details    card with min (requests in flight + 1) * recent service time / chips is selected,
+   *              excluded cards are skipped (NTPCIE_ERROR_POOL_INCONSISTENT - every card excluded)
+   *  @param[in]  pool pool of cards
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  classifier
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @param[in,out] number_of_responses max amount of responses / amount of responses returned
+   *  @param[out] resp[] responses of NN
+   *  @param[out] card_ix index of card (in pool) which classified vector (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_pool_vector_classify(struct nta_card_pool_t * const pool,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               size_t * const number_of_responses,
+                               struct response_neuron_state_t resp[],
+                               size_t * const card_ix);
+
+  /// hybrid card/CPU (overflow of card is spilled to CPU engine)
+
+  /**
+   *  @brief      init hybrid of card and host mirror of its knowledge base
+   *  @details    knowledge base of card is read to host memory (see ntpcie_kbase_store_all);
+   *              IO thread of card is started (see ntpcie_device_queue_start), so hybrid may be used
+   *              by any number of application threads; card must stay opened while hybrid is used
+   *  @param[out] hybrid hybrid to init
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  latency_budget_us expected wait of card (microseconds) over which request is spilled
+   *  @param[in]  host_slots max amount of requests classified by CPU at once (0 - card only)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_init(struct nta_card_hybrid_t * const hybrid,
+                               struct nta_dev_handle_t * const dev_handle,
+                               const uint32_t latency_budget_us,
+                               const size_t   host_slots);
+
+  /**
+   *  @brief      deinit hybrid (card stays opened)
+   *  @param[in]  hybrid hybrid of card
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_deinit(struct nta_card_hybrid_t * const hybrid);
+
+  /**
+   *  @brief      reset (soft) neuron net of card and its mirror (FORGET)
+   *  @param[in]  hybrid hybrid of card
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_nn_reset(struct nta_card_hybrid_t * const hybrid);
+
+  /**
+   *  @brief      Learn vector by card of hybrid
+   *  @details    mirror is patched after learn: committed neuron and neurons of other category fired
+   *              by vector (their AIF may shrink) are read back from card (ntpcie_nn_neuron_read());
+   *              requests go to card while learn is in progress; if learn or read back fails,
+   *              mirror is dropped and requests go to card until ntpcie_hybrid_mirror_sync()
+   *  @param[in]  hybrid hybrid of card
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  category
+   *  @param[in]  maxif
+   *  @param[in]  minif
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_vector_learn(struct nta_card_hybrid_t * const hybrid,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const uint16_t category,
+                               const uint16_t maxif,
+                               const uint16_t minif,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[]);
+
+  /**
+   *  @brief      re-read mirror of knowledge base from card
+   *  @details    to be called after knowledge base of card was changed directly (not by hybrid)
+   *              or after failed ntpcie_hybrid_vector_learn(); cost of ntpcie_kbase_store_all()
+   *  @param[in]  hybrid hybrid of card
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_mirror_sync(struct nta_card_hybrid_t * const hybrid);
+
+  /**
+   *  @brief      Classify vector by card or (on overflow of card) by CPU engine
+   *  @details    CPU engine is used if mirror is valid, free host slot exists and
+   *              (requests in flight on card + 1) * recent service time of card > latency budget;
+   *              mirror is never read from card by classify; responses are the same for both engines
+   *  @param[in]  hybrid hybrid of card
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  classifier
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @param[in,out] number_of_responses max amount of responses / amount of responses returned
+   *  @param[out] resp[] responses of NN
+   *  @param[out] on_host true if vector was classified by CPU engine (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_vector_classify(struct nta_card_hybrid_t * const hybrid,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t   comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               size_t * const number_of_responses,
+                               struct response_neuron_state_t resp[],
+                               bool * const on_host);
+
 
   /// NN neuron read state
 
@@ -184,6 +778,160 @@ extern "C"
                                                     const size_t comps_count,
                                                     const struct nn_neuron_t * const _neuron);
 
+  /**
+   *  @brief      transfer all committed neurons from NN to main PC RAM as "knowledge base" by one call
+   *  @details    NCOUNT is read internally (NR mode of NN is set), validation and dispatch to IO thread
+   *              are done once, card readiness is checked before every neuron;
+   *              if array is too small NTPCIE_ERROR_ARGS_NEURONS_COUNT is returned and neurons_count
+   *              is set to required size (neurons == NULL and neurons_max == 0 may be used as size query)
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[out] neurons[] array of neurons (all (256) components of neuron will be filled)
+   *  @param[in]  neurons_max size of array neurons[]
+   *  @param[out] neurons_count amount of neurons stored
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_store_all(struct nta_dev_handle_t * const dev_handle,
+                                                         struct nn_neuron_t neurons[],
+                                                         const size_t neurons_max,
+                                                         size_t * const neurons_count);
+
+  /**
+   *  @brief      transfer array of neurons from main PC RAM to NN by one call
+   *  @details    knowledge base of NN is replaced: NN is reset and NCOUNT is read internally
+   *              (NR mode of NN is set), validation and dispatch to IO thread are done once,
+   *              card readiness is checked before every neuron
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  comps_count components count in neurons to be restored
+   *  @param[in]  neurons[] array of neurons
+   *  @param[in]  neurons_count amount of neurons in array (max is neurons_overall of card)
+   *  @param[out] neurons_done amount of neurons loaded (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_load_all(struct nta_dev_handle_t * const dev_handle,
+                                                        const size_t comps_count,
+                                                        const struct nn_neuron_t neurons[],
+                                                        const size_t neurons_count,
+                                                        size_t * const neurons_done);
+
+  /**
+   *  @brief      save knowledge base of NN to file
+   *  @details    file (see nta_kbase_file_header_t) is mapped to memory and neurons are stored
+   *              directly to it; KB is written to "<path>.tmp", flushed to disk and renamed to path,
+   *              so existing file is replaced only by complete KB (temporary file is removed on error)
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  comps_count components count in neurons of KB
+   *  @param[in]  path name of file (existing file is replaced)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_save_file(struct nta_dev_handle_t * const dev_handle,
+                                                         const size_t comps_count,
+                                                         const char * const path);
+
+  /**
+   *  @brief      load knowledge base from file to NN
+   *  @details    file is mapped to memory, header and CRCs of all chunks are checked before
+   *              KB of NN is replaced; neurons are loaded directly from mapping
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  path name of file
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_load_file(struct nta_dev_handle_t * const dev_handle,
+                                                         const char * const path);
+
+  /**
+   *  @brief      read knowledge base from file to main PC RAM (card isn't used)
+   *  @details    header and CRCs of all chunks are checked; if array is too small
+   *              NTPCIE_ERROR_ARGS_NEURONS_COUNT is returned and neurons_count is set to required size
+   *  @param[in]  path name of file
+   *  @param[out] neurons[] array of neurons
+   *  @param[in]  neurons_max size of array neurons[]
+   *  @param[out] neurons_count amount of neurons read
+   *  @param[out] comps_count components count in neurons of KB (may be NULL)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_file_read(const char * const path,
+                                                         struct nn_neuron_t neurons[],
+                                                         const size_t neurons_max,
+                                                         size_t * const neurons_count,
+                                                         size_t * const comps_count);
+
+  /**
+   *  @brief      Classify batch of vectors over knowledge base larger than card
+   *  @details    KB in main PC RAM is split to partitions of neurons_overall neurons; every partition
+   *              is loaded to card once (see ntpcie_kbase_load_all) and whole batch is classified against it,
+   *              responses of partitions are merged by distance; responses are the same as of one card
+   *              holding whole KB (id of neuron is its position in neurons[], 1-based);
+   *              ATT: KB of card is replaced (last partition stays loaded), card must not be used
+   *              by other threads during call
+   *  @param[in]  dev_handle pointer to structure with internal id's PCIe card
+   *  @param[in]  neurons[] knowledge base
+   *  @param[in]  neurons_count amount of neurons in KB (max is 0xFFFE)
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  classifier
+   *  @param[in]  comps_count components count in every vector (and in neurons loaded to card)
+   *  @param[in]  vectors_count amount of vectors in batch (at least 1)
+   *  @param[in]  data_vectors buffer with vectors (array of vectors or strided buffer)
+   *  @param[in]  vectors_stride distance (in components) between vectors in data_vectors (0 - equal to comps_count)
+   *  @param[in]  number_of_responses desired number of responses for every vector
+   *  @param[out] responses_count array (vectors_count size) with real number of responses for every vector
+   *  @param[out] resp array with recognize results (must be at least vectors_count * number_of_responses size)
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_paged_classify_batch(struct nta_dev_handle_t * const dev_handle,
+                                                         const struct nn_neuron_t neurons[],
+                                                         const size_t neurons_count,
+                                                         const enum nn_dist_eval_t dist_eval,
+                                                         const uint16_t context,
+                                                         const enum nn_classifier_t classifier,
+                                                         const size_t comps_count,
+                                                         const size_t vectors_count,
+                                                         const nn_vector_comp_t data_vectors[],
+                                                         const size_t vectors_stride,
+                                                         const size_t number_of_responses,
+                                                         size_t responses_count[],
+                                                         struct response_neuron_state_t resp[]);
+
+  /// CPU (host) engine
+
+  /**
+   *  @brief      Classify vector by CPU over knowledge base in main PC RAM (card isn't used)
+   *  @details    results are the same as results of ntpcie_nn_vector_classify() for card holding
+   *              the same neurons (distances, AIF gating, contexts, order of responses, neuron ids);
+   *              distances are computed by AVX-512/AVX2 (x86-64) or NEON (aarch64) kernels if available;
+   *              function is reentrant (may be called by many threads for the same KB)
+   *  @param[in]  neurons[] knowledge base (e.g. from ntpcie_kbase_store_all() or ntpcie_kbase_file_read())
+   *  @param[in]  neurons_count amount of neurons in KB
+   *  @param[in]  dist_eval
+   *  @param[in]  context
+   *  @param[in]  classifier
+   *  @param[in]  comps_count components count in vector
+   *  @param[in]  data_vector[] array of components
+   *  @param[in,out] number_of_responses max amount of responses / amount of responses returned
+   *  @param[out] resp[] responses of NN
+   *  @return     status of operation (NTPCIE_ERROR_...)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_cpu_vector_classify(const struct nn_neuron_t neurons[],
+                               const size_t neurons_count,
+                               const enum nn_dist_eval_t dist_eval,
+                               const uint16_t context,
+                               const enum nn_classifier_t classifier,
+                               const size_t comps_count,
+                               const nn_vector_comp_t data_vector[],
+                               size_t * const number_of_responses,
+                               struct response_neuron_state_t resp[]);
+
+  /**
+   *  @brief      select distance kernels of CPU engine (for tests and benchmarks)
+   *  @details    kernels are selected for whole process (all callers of ntpcie_cpu_vector_classify(),
+   *              hybrid and pool), results of all kernels are the same; NN_CPU_KERNEL_AUTO restores
+   *              the fastest kernel supported by CPU (selected by default at first call)
+   *  @param[in]  kernel kernel to use
+   *  @return     status of operation (NTPCIE_ERROR_ARGS_CPU_KERNEL - not supported by build or CPU,
+   *              selected kernel is not changed)
+   */
+  enum ntpcie_nn_error_t NTIA_API ntpcie_cpu_kernel_select(const enum nn_cpu_kernel_t kernel);
+
 
   const char *ntpcie_error_text(enum ntpcie_nn_error_t const _ec);
 
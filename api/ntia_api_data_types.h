@@ -57,10 +57,20 @@ struct nta_pcidev_list_t
 // general NN parameters
 #define NN_NEURON_COMPONENTS        (256)
 #define NN_MAX_RESP_COUNT           (85)
+
+// max amount of asynchronous requests submitted to card and not polled yet (ntpcie_submit_classify())
+#ifndef NTPCIE_ASYNC_DEPTH
+#define NTPCIE_ASYNC_DEPTH          (16u)
+#endif // NTPCIE_ASYNC_DEPTH
 // influence fields default values
 #define NN_DEF_MAXIF                (0x4000)
 #define NN_DEF_MINIF                (0x0002)
 
+// knowledge base file format
+#define NTA_KBASE_FILE_MAGIC        (0x424B544Eu)   // "NTKB"
+#define NTA_KBASE_FILE_VERSION      (1u)
+#define NTA_KBASE_FILE_CHUNK        (256u)          // neuron records covered by single CRC
+
 enum ntpcie_nn_error_t
 {
   NTPCIE_ERROR_SUCCESS               = 0x00000000L,
@@ -93,9 +103,31 @@ enum ntpcie_nn_error_t
 
   NTPCIE_ERROR_KBASE_EOF,
 
+  NTPCIE_ERROR_ARGS_TRANSPORT,
+  NTPCIE_ERROR_QUEUE,
+  NTPCIE_ERROR_BUSY,
+  NTPCIE_ERROR_ARGS_CARDS_COUNT,
+  NTPCIE_ERROR_ARGS_NEURONS_COUNT,
+  NTPCIE_ERROR_KBASE_FILE_IO,
+  NTPCIE_ERROR_KBASE_FILE_FORMAT,
+  NTPCIE_ERROR_ARGS_ENTRIES_COUNT,
+  NTPCIE_ERROR_POOL_INCONSISTENT,
+  NTPCIE_ERROR_ARGS_VECTORS_COUNT,
+  NTPCIE_ERROR_ARGS_CPU_KERNEL,
+
   NTPCIE_ERROR_ITEMS_COUNT    // MAX value for ERROR codes
 };
 
+// distance kernels of CPU engine (ntpcie_cpu_kernel_select())
+enum nn_cpu_kernel_t
+{
+  NN_CPU_KERNEL_AUTO   = 0x00u,  ///< the fastest kernel supported by CPU (default)
+  NN_CPU_KERNEL_SCALAR = 0x01u,  ///< plain C
+  NN_CPU_KERNEL_AVX2   = 0x02u,  ///< x86-64 AVX2
+  NN_CPU_KERNEL_AVX512 = 0x03u,  ///< x86-64 AVX-512BW
+  NN_CPU_KERNEL_NEON   = 0x04u,  ///< aarch64 NEON
+};
+
 enum nn_classifier_t
 {
   NN_CLASSIFIER_RBF = 0x00u,
@@ -108,6 +140,46 @@ enum nn_dist_eval_t
   NN_DIST_EVAL_LSUP = 0x01u,
 };
 
+// what learn of vector did with knowledge base of card (set of flags, as far as card answer tells):
+// card returns only category of the closest fired neuron and committed neurons count, so
+// - SHRUNK is known only if the closest fired neuron has other category; neurons of other
+//   category fired farther than recognizing neuron of the same category may shrink unreported;
+// - amount of shrunk neurons and their new AIF are unknown (read them back if needed);
+// - category 0 (counter example) never commits and is never RECOGNIZED: it is either SHRUNK or NONE
+enum nn_learn_outcome_t
+{
+  NN_LEARN_NONE       = 0x00u,  ///< no neuron fired, nothing committed (category 0 only)
+  NN_LEARN_COMMITTED  = 0x01u,  ///< new neuron is committed
+  NN_LEARN_SHRUNK     = 0x02u,  ///< the closest fired neuron has other category: it (and maybe others) is shrunk
+  NN_LEARN_RECOGNIZED = 0x04u,  ///< the closest fired neuron has category of vector: nothing committed
+  NN_LEARN_FULL       = 0x08u,  ///< new neuron is needed, but NN is full
+};
+
+// IO transport (backend) to access card
+enum nta_io_transport_t
+{
+  NTA_IO_TRANSPORT_DEFAULT = 0x00u,   ///< env. variable NTIA_PCIE_TRANSPORT or default of platform
+  NTA_IO_TRANSPORT_SYSFS   = 0x01u,   ///< GNU/Linux sysfs (mmap of PCI resource)
+  NTA_IO_TRANSPORT_UMDFV2  = 0x02u,   ///< Windows UMDFv2 driver
+  NTA_IO_TRANSPORT_EMU     = 0x03u,   ///< software emulator of card
+  NTA_IO_TRANSPORT_VFIO    = 0x04u,   ///< GNU/Linux vfio-pci (completion by interrupt)
+};
+
+// IO options (flags, may be combined), ignored by transports which don't support them
+enum nta_io_flags_t
+{
+  NTA_IO_FLAG_NONE            = 0x00000000u,
+  NTA_IO_FLAG_WRITE_COMBINING = 0x00000001u,     ///< sysfs: upload data packs through write-combining mapping (resource0_wc)
+  NTA_IO_FLAG_WIDE_READ       = 0x00000002u,     ///< sysfs, vfio: read results with 64/128 bit loads (card must accept wide reads)
+};
+
+// options of NTIA NN system init (see ntpcie_sys_init_ex)
+struct nta_sys_options_t
+{
+  enum nta_io_transport_t  transport;            ///< IO transport to access cards
+  uint32_t                 io_flags;             ///< IO options (enum nta_io_flags_t)
+};
+
 struct nn_state_t
 {
   size_t               neurons_overall;          ///< overall neurons count on NN
@@ -122,6 +194,84 @@ struct nn_state_t
   size_t               vecs_count_total_class;   ///< total vectors classified (since last reset)
 };
 
+// operations of card with latency statistics (ntpcie_stats_get())
+enum nn_stats_oper_t
+{
+  NN_STATS_OPER_LEARN       = 0x00u,  ///< learn of vector
+  NN_STATS_OPER_CLASSIFY    = 0x01u,  ///< classify of vector (synchronous and asynchronous)
+  NN_STATS_OPER_KBASE_STORE = 0x02u,  ///< read of single neuron of KB from card
+  NN_STATS_OPER_KBASE_LOAD  = 0x03u,  ///< write of single neuron of KB to card
+  NN_STATS_OPER_NEURON_READ = 0x04u,  ///< read of single neuron by index
+  NN_STATS_OPER_REG_READ    = 0x05u,  ///< read of NN register
+  NN_STATS_OPER_REG_WRITE   = 0x06u,  ///< write of NN register
+  NN_STATS_OPER_COUNT,
+};
+
+// phases of card operation (time of every phase is accumulated separately)
+enum nn_stats_phase_t
+{
+  NN_STATS_PHASE_VALIDATE   = 0x00u,  ///< check of arguments (host)
+  NN_STATS_PHASE_PACK_BUILD = 0x01u,  ///< build of pack for card (host)
+  NN_STATS_PHASE_WAIT_READY = 0x02u,  ///< wait for "ready" of card before operation
+  NN_STATS_PHASE_UPLOAD     = 0x03u,  ///< write of pack to card (PCIe)
+  NN_STATS_PHASE_COMPUTE    = 0x04u,  ///< polling of card until results are ready (NN)
+  NN_STATS_PHASE_READBACK   = 0x05u,  ///< read of results from card (PCIe)
+  NN_STATS_PHASE_COUNT,
+};
+
+// buckets of latency histogram: bucket #i counts latencies of [2^i .. 2^(i+1)) ns,
+// the last bucket counts all longer latencies (2^31 ns = ~2.1 s and more)
+#define NN_STATS_BUCKETS            (32)
+
+// latency statistics of single operation of card (since device open or ntpcie_stats_reset())
+struct nn_oper_stats_t
+{
+  uint64_t             count;                                ///< operations done successfully
+  uint64_t             cache_hits;                           ///< operations answered by cache of results (counted in count too)
+  uint64_t             time_total_ns;                        ///< sum of latencies
+  uint64_t             time_max_ns;                          ///< max latency
+  uint64_t             buckets[NN_STATS_BUCKETS];            ///< histogram of latencies (log2 of ns)
+  uint64_t             phase_total_ns[NN_STATS_PHASE_COUNT]; ///< sum of times of every phase (enum nn_stats_phase_t)
+};
+
+struct nn_stats_t
+{
+  struct nn_oper_stats_t oper[NN_STATS_OPER_COUNT]; ///< statistics of every operation (enum nn_stats_oper_t)
+};
+
+// record of vector to learn (for batch learn)
+struct nn_learn_record_t
+{
+  uint16_t                 context;              ///< context of vector
+  uint16_t                 category;             ///< category of vector
+  const nn_vector_comp_t*  comps;                ///< components of vector (comps_count of batch)
+};
+
+// result of learn for single vector (as returned by card)
+struct nn_learn_result_t
+{
+  uint16_t                 category;             ///< category returned by NN (of closest fired neuron)
+  uint16_t                 ncount;               ///< committed neurons count after learn (0xFFFF - NN is full)
+  uint16_t                 outcome;              ///< what learn did (set of NN_LEARN_... flags)
+};
+
+// recognition status of classified vector (as returned by card together with responses):
+// identified - fired neurons agree on category, uncertain - categories differ, neither - unknown
+struct nn_classify_status_t
+{
+  uint16_t             ncount;                   ///< fired neurons count (card reports max NN_FIRED_NCOUNT_MAX)
+  bool                 identified;               ///< ID flag of card
+  bool                 uncertain;                ///< UNC flag of card
+};
+
+// completion of asynchronous request (ntpcie_poll_completions)
+struct nta_completion_t
+{
+  uint32_t               token;                  ///< token returned by ntpcie_submit_...()
+  enum ntpcie_nn_error_t result;                 ///< status of request
+  size_t                 number_of_responses;    ///< responses written to resp[] given at submit
+};
+
 struct nta_dev_handle_t
 {
   void*                _iox_handle;
@@ -129,6 +279,25 @@ struct nta_dev_handle_t
   struct nn_state_t    nn_state;
 };
 
+// group of opened cards holding one logical knowledge base (every card holds partition of it)
+struct nta_card_group_t
+{
+  size_t                   cards_count;
+  struct nta_dev_handle_t* cards[NTIA_PCIE_MAX_CARDS];  ///< handles of opened cards (owned by application)
+};
+
+// pool of opened cards holding replicas of the same knowledge base (requests are routed to least loaded card)
+struct nta_card_pool_t
+{
+  void*                    _pool_handle;
+};
+
+// opened card with host mirror of its knowledge base (overflow of classify requests is spilled to CPU engine)
+struct nta_card_hybrid_t
+{
+  void*                    _hybrid_handle;
+};
+
 // "wire" datatypes for IO: must be exact size and fixed fields order
 #pragma pack(push)
 #pragma pack(1)
@@ -168,6 +337,32 @@ struct nn_neuron_t
                   "sizeof(struct nn_neuron_t) != 264");
 // +-------------------------------------------------------------------------------------------+
 
+// header of knowledge base file (ntpcie_kbase_save_file/ntpcie_kbase_load_file)
+// layout of file: header | nn_neuron_t records[neurons_count] | uint32_t crc32 of chunks[chunks_count]
+struct nta_kbase_file_header_t
+{
+  uint32_t           magic;                      ///< NTA_KBASE_FILE_MAGIC
+  uint16_t           version;                    ///< NTA_KBASE_FILE_VERSION
+  uint16_t           header_size;                ///< offset of first neuron record
+  uint32_t           record_size;                ///< stride of neuron records (sizeof(struct nn_neuron_t))
+  uint32_t           neurons_count;              ///< neuron records in file
+  uint32_t           neurons_overall;            ///< neurons count of card KB was saved from
+  uint16_t           comps_count;                ///< components count of neurons
+  uint16_t           chunk_neurons;              ///< neuron records covered by single CRC
+  uint64_t           kbase_id;                   ///< ID of knowledge base
+  uint8_t            contexts[16];               ///< set of contexts used by neurons (bit per context)
+  uint32_t           chunks_count;               ///< CRCs after neuron records
+  uint8_t            reserved[8];                ///< must be zero
+  uint32_t           header_crc32;               ///< CRC of header (all previous fields)
+};
+// +--------------------------------+ static checks +------------------------------------------+
+#ifdef __cplusplus
+    static_assert(std::is_pod<struct nta_kbase_file_header_t>::value, "nta_kbase_file_header_t is not POD");
+#endif // __cplusplus
+    static_assert((sizeof(struct nta_kbase_file_header_t) == 64),
+                  "sizeof(struct nta_kbase_file_header_t) != 64");
+// +-------------------------------------------------------------------------------------------+
+
 #pragma pack(pop)
 
 // *INDENT-ON*
@@ -38,7 +38,17 @@
 // IO transfer block size in bytes
 #define NTPCIE_DATA_BLOCK_SIZE          (sizeof(uint32_t))
 
-// MAX wait loop counters
+// MAX fired neurons reported by card in answer of classify (ncount is 6 bits)
+#define NN_FIRED_NCOUNT_MAX             (0x3Fu)
+
+// neurons of single NM500 chip (card reports neurons_overall = chips * NN_CHIP_NEURONS)
+#define NN_CHIP_NEURONS                 (576)
+
+// MAX wait times for card (default of handle and card reset)
+#define NTPCIE_TIMEOUT_STD_NS           (20000000ull)
+#define NTPCIE_TIMEOUT_EXT_NS           (200000000ull)
+
+// DEPRECATED: MAX wait loop counters (waits are bounded by NTPCIE_TIMEOUT_*_NS now, not used by library)
 #define NTPCIE_MAX_CYCLES_STD           (2500)
 #define NTPCIE_MAX_CYCLES_EXT           (5000)
 
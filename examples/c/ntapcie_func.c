@@ -604,3 +604,39 @@ void nntest_kbs_compare(struct nta_dev_handle_t * const dev_handle)
     puts(" KB's is NOT EQ");
   }
 }
+
+void nntest_kb_save_file(struct nta_dev_handle_t* const dev_handle)
+{
+  char file_name[256] = { 0 };
+
+  fputs(" input KB file name: ", stdout);
+  scanf("%255s", file_name);
+
+  enum ntpcie_nn_error_t nn_result = ntpcie_kbase_save_file(dev_handle, NN_NEURON_COMPONENTS, file_name);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    puts(" error: save KB to file failed");
+    ntpcie_error_viewer(nn_result);
+    return;
+  }
+
+  printf(" KB save to file - OK (neurons %" PRIu64 ")\n", dev_handle->nn_state.neurons_committed);
+}
+
+void nntest_kb_load_file(struct nta_dev_handle_t* const dev_handle)
+{
+  char file_name[256] = { 0 };
+
+  fputs(" input KB file name: ", stdout);
+  scanf("%255s", file_name);
+
+  enum ntpcie_nn_error_t nn_result = ntpcie_kbase_load_file(dev_handle, file_name);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    puts(" error: load KB from file failed");
+    ntpcie_error_viewer(nn_result);
+    return;
+  }
+
+  printf(" KB load from file - OK (neurons %" PRIu64 ")\n", dev_handle->nn_state.neurons_committed);
+}
@@ -70,5 +70,7 @@ void nntest_forget_all(struct nta_dev_handle_t* const dev_handle);
 void nntest_kb_store(struct nta_dev_handle_t* const dev_handle);
 void nntest_kb_load(struct nta_dev_handle_t* const dev_handle);
 void nntest_kbs_compare(struct nta_dev_handle_t* const dev_handle);
+void nntest_kb_save_file(struct nta_dev_handle_t* const dev_handle);
+void nntest_kb_load_file(struct nta_dev_handle_t* const dev_handle);
 
 #endif // ONCE_INC_NTAPCIE_FUNC_H_
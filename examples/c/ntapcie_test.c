@@ -140,6 +140,8 @@ static const struct menu_item_t main_menu[] = {
   { "KB:   KB store",                &nntest_kb_store },
   { "KB:   KB load",                 &nntest_kb_load },
   { "KB:   KB's compare",            &nntest_kbs_compare },
+  { "KB:   KB save to file",         &nntest_kb_save_file },
+  { "KB:   KB load from file",       &nntest_kb_load_file },
   { NULL, NULL },
 };
 
@@ -2,6 +2,7 @@
 #ifndef ONCE_INC_CRC32_H_
 #define ONCE_INC_CRC32_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -12,6 +13,25 @@ extern "C"
 
 extern const uint32_t ntia_crc32_table[];
 
+// buffers shorter than this are processed byte by byte inline (e.g. hash of device handle)
+#define CRC32_INLINE_BYTES_MAX (16u)
+
+// add buffer to CRC accumulator: slicing-by-8, PCLMULQDQ (x86-64) or ARMv8 CRC32 (selected at runtime)
+uint32_t crc32_update(uint32_t crc_acc, const void* const mem, const size_t count);
+
+// implementations of crc32_update()
+enum crc32_impl_t
+{
+  CRC32_IMPL_AUTO = 0,  // the fastest one supported by CPU (default)
+  CRC32_IMPL_SLICE8,
+  CRC32_IMPL_PCLMUL,
+  CRC32_IMPL_ARMV8,
+};
+
+// select implementation of crc32_update() for whole process (for tests and benchmarks),
+// false - not supported by build or CPU (implementation is not changed)
+bool crc32_impl_select(const enum crc32_impl_t impl);
+
 // *INDENT-OFF*
 // clang-format off
 
@@ -36,6 +56,11 @@ void crc32_add_single_byte(uint32_t* const crc_acc, const uint8_t single_byte)
 static inline
 void crc32_add_multi_byte(uint32_t* const crc_acc, const void* const mem, size_t count)
 {
+  if (count >= CRC32_INLINE_BYTES_MAX)
+  {
+    *crc_acc = crc32_update(*crc_acc, mem, count);
+    return;
+  }
   for (const uint8_t* pointer = (const uint8_t*)mem; count--; ++pointer)
   {
     crc32_add_single_byte(crc_acc, *pointer);
@@ -46,6 +71,10 @@ static inline
 uint32_t crc32_mem_value(const void* const mem, size_t count)
 {
   uint32_t crc_acc = 0xFFFFFFFFu;
+  if (count >= CRC32_INLINE_BYTES_MAX)
+  {
+    return crc32_update(crc_acc, mem, count) ^ 0xFFFFFFFFu;
+  }
   const uint8_t* pointer = (const uint8_t*)mem;
   while (count--)
   {
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntia_api_data_types.h"
+
+#include "crc32.h"
+
+#include "ntapcie_cache.h"
+
+/// internal functions
+static bool cache_entry_matches(const struct ntpcie_cache_entry_t* const entry, const struct ntpcie_cache_key_t* const key);
+static void cache_lru_unlink(struct ntpcie_cache_t* const cache, const uint32_t ix);
+static void cache_lru_push_front(struct ntpcie_cache_t* const cache, const uint32_t ix);
+static void cache_bucket_unlink(struct ntpcie_cache_t* const cache, const uint32_t ix);
+static void cache_reset(struct ntpcie_cache_t* const cache);
+
+struct ntpcie_cache_t* ntpcie_cache_create(const size_t entries_max)
+{
+  struct ntpcie_cache_t* cache = NULL;
+
+  if ((entries_max < 1) || (entries_max > NTPCIE_CACHE_ENTRIES_MAX))
+  {
+    goto ret_result;
+  }
+
+  // table is at least twice larger than cache: chains of buckets stay short
+  size_t buckets_count = 1;
+  while (buckets_count < entries_max * 2)
+  {
+    buckets_count <<= 1;
+  }
+
+  cache = (struct ntpcie_cache_t*)calloc(1, sizeof(*cache));
+  if (cache == NULL)
+  {
+    goto ret_result;
+  }
+
+  cache->entries = (struct ntpcie_cache_entry_t*)malloc(entries_max * sizeof(cache->entries[0]));
+  cache->buckets = (uint32_t*)malloc(buckets_count * sizeof(cache->buckets[0]));
+  if ((cache->entries == NULL) || (cache->buckets == NULL))
+  {
+    ntpcie_cache_destroy(cache);
+    cache = NULL;
+    goto ret_result;
+  }
+
+  cache->entries_max  = (uint32_t)entries_max;
+  cache->buckets_mask = (uint32_t)(buckets_count - 1);
+  cache_reset(cache);
+
+ret_result:
+  return cache;
+}
+
+void ntpcie_cache_destroy(struct ntpcie_cache_t* const cache)
+{
+  if (cache == NULL)
+  {
+    return;
+  }
+
+  free(cache->buckets);
+  free(cache->entries);
+  free(cache);
+}
+
+// called on every change of knowledge base: cheap if cache is empty already
+void ntpcie_cache_clear(struct ntpcie_cache_t* const cache)
+{
+  if ((cache == NULL) || (cache->entries_count == 0))
+  {
+    return;
+  }
+
+  cache_reset(cache);
+}
+
+void ntpcie_cache_key_make(struct ntpcie_cache_key_t* const key,
+                           const enum nn_dist_eval_t dist_eval,
+                           const uint16_t context,
+                           const enum nn_classifier_t classifier,
+                           const size_t answers,
+                           const size_t comps_count,
+                           const nn_vector_comp_t data_vector[])
+{
+  key->dist_eval   = (uint8_t)dist_eval;
+  key->classifier  = (uint8_t)classifier;
+  key->answers     = (uint8_t)answers;
+  key->context     = context;
+  key->comps_count = (uint16_t)comps_count;
+  key->comp        = data_vector;
+
+  const uint8_t settings[7] = {
+    key->dist_eval,
+    key->classifier,
+    key->answers,
+    (uint8_t)(context & 0xFFu),
+    (uint8_t)(context >> 8),
+    (uint8_t)(comps_count & 0xFFu),
+    (uint8_t)(comps_count >> 8),
+  };
+
+  uint32_t crc_acc;
+  crc32_reset_crc_acc(&crc_acc);
+  crc32_add_multi_byte(&crc_acc, settings, sizeof(settings));
+  crc32_add_multi_byte(&crc_acc, data_vector, comps_count * sizeof(data_vector[0]));
+  key->hash = crc32_get_value(&crc_acc);
+}
+
+bool ntpcie_cache_lookup(struct ntpcie_cache_t* const cache,
+                         const struct ntpcie_cache_key_t* const key,
+                         size_t* const number_of_responses,
+                         struct response_neuron_state_t resp[],
+                         struct nn_classify_status_t* const status)
+{
+  for (uint32_t ix = cache->buckets[key->hash & cache->buckets_mask]; ix != NTPCIE_CACHE_NIL;
+       ix = cache->entries[ix].bucket_next)
+  {
+    const struct ntpcie_cache_entry_t* const entry = &cache->entries[ix];
+    if (cache_entry_matches(entry, key) != true)
+    {
+      continue;
+    }
+
+    if (entry->resp_count > 0)
+    {
+      memcpy(resp, entry->resp, entry->resp_count * sizeof(resp[0]));
+    }
+    *number_of_responses = entry->resp_count;
+    *status              = entry->status;
+
+    cache_lru_unlink(cache, ix);
+    cache_lru_push_front(cache, ix);
+    return true;
+  }
+
+  return false;
+}
+
+void ntpcie_cache_insert(struct ntpcie_cache_t* const cache,
+                         const struct ntpcie_cache_key_t* const key,
+                         const size_t number_of_responses,
+                         const struct response_neuron_state_t resp[],
+                         const struct nn_classify_status_t* const status)
+{
+  uint32_t ix;
+
+  if (cache->entries_count < cache->entries_max)
+  {
+    ix = cache->entries_count++;
+  }
+  else
+  {
+    // least recently used entry is reused
+    ix = cache->lru_tail;
+    cache_lru_unlink(cache, ix);
+    cache_bucket_unlink(cache, ix);
+  }
+
+  struct ntpcie_cache_entry_t* const entry = &cache->entries[ix];
+
+  entry->hash        = key->hash;
+  entry->dist_eval   = key->dist_eval;
+  entry->classifier  = key->classifier;
+  entry->answers     = key->answers;
+  entry->context     = key->context;
+  entry->comps_count = key->comps_count;
+  entry->resp_count  = (uint8_t)number_of_responses;
+  entry->status      = *status;
+  memcpy(entry->comp, key->comp, key->comps_count * sizeof(entry->comp[0]));
+  if (number_of_responses > 0)
+  {
+    memcpy(entry->resp, resp, number_of_responses * sizeof(entry->resp[0]));
+  }
+
+  uint32_t* const bucket = &cache->buckets[key->hash & cache->buckets_mask];
+  entry->bucket_next     = *bucket;
+  *bucket                = ix;
+
+  cache_lru_push_front(cache, ix);
+}
+
+/// internal functions
+static bool cache_entry_matches(const struct ntpcie_cache_entry_t* const entry, const struct ntpcie_cache_key_t* const key)
+{
+  return (entry->hash == key->hash)
+      && (entry->dist_eval == key->dist_eval)
+      && (entry->classifier == key->classifier)
+      && (entry->answers == key->answers)
+      && (entry->context == key->context)
+      && (entry->comps_count == key->comps_count)
+      && (memcmp(entry->comp, key->comp, key->comps_count * sizeof(entry->comp[0])) == 0);
+}
+
+static void cache_lru_unlink(struct ntpcie_cache_t* const cache, const uint32_t ix)
+{
+  struct ntpcie_cache_entry_t* const entry = &cache->entries[ix];
+
+  if (entry->lru_prev != NTPCIE_CACHE_NIL)
+  {
+    cache->entries[entry->lru_prev].lru_next = entry->lru_next;
+  }
+  else
+  {
+    cache->lru_head = entry->lru_next;
+  }
+
+  if (entry->lru_next != NTPCIE_CACHE_NIL)
+  {
+    cache->entries[entry->lru_next].lru_prev = entry->lru_prev;
+  }
+  else
+  {
+    cache->lru_tail = entry->lru_prev;
+  }
+}
+
+static void cache_lru_push_front(struct ntpcie_cache_t* const cache, const uint32_t ix)
+{
+  struct ntpcie_cache_entry_t* const entry = &cache->entries[ix];
+
+  entry->lru_prev = NTPCIE_CACHE_NIL;
+  entry->lru_next = cache->lru_head;
+
+  if (cache->lru_head != NTPCIE_CACHE_NIL)
+  {
+    cache->entries[cache->lru_head].lru_prev = ix;
+  }
+  else
+  {
+    cache->lru_tail = ix;
+  }
+  cache->lru_head = ix;
+}
+
+static void cache_bucket_unlink(struct ntpcie_cache_t* const cache, const uint32_t ix)
+{
+  uint32_t* link = &cache->buckets[cache->entries[ix].hash & cache->buckets_mask];
+
+  while (*link != ix)
+  {
+    link = &cache->entries[*link].bucket_next;
+  }
+  *link = cache->entries[ix].bucket_next;
+}
+
+static void cache_reset(struct ntpcie_cache_t* const cache)
+{
+  memset(cache->buckets, 0xFF, ((size_t)cache->buckets_mask + 1) * sizeof(cache->buckets[0]));
+  cache->entries_count = 0;
+  cache->lru_head      = NTPCIE_CACHE_NIL;
+  cache->lru_tail      = NTPCIE_CACHE_NIL;
+}
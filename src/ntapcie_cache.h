@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#pragma once
+#ifndef ONCE_INC_NTAPCIE_CACHE_H_
+#define ONCE_INC_NTAPCIE_CACHE_H_
+
+// cache of classify results of card: LRU list of (request, responses) with hash table over it,
+// key is CRC32 of request (classify settings and components), full request is compared on hit;
+// cache is used only by thread which owns card (IO thread of card if queue is started): no locking
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ntia_api_data_types.h"
+
+#define NTPCIE_CACHE_NIL (0xFFFFFFFFu)
+
+// max entries of cache (every entry is ~800 bytes)
+#define NTPCIE_CACHE_ENTRIES_MAX (1u << 20)
+
+// classify request (key of cache)
+struct ntpcie_cache_key_t
+{
+  uint32_t                hash;
+  uint8_t                 dist_eval;
+  uint8_t                 classifier;
+  uint8_t                 answers;     ///< responses requested
+  uint16_t                context;
+  uint16_t                comps_count;
+  const nn_vector_comp_t* comp;
+};
+
+struct ntpcie_cache_entry_t
+{
+  uint32_t                       hash;
+  uint32_t                       bucket_next; ///< next entry of hash bucket
+  uint32_t                       lru_prev;    ///< more recently used entry
+  uint32_t                       lru_next;    ///< less recently used entry
+  uint8_t                        dist_eval;
+  uint8_t                        classifier;
+  uint8_t                        answers;
+  uint8_t                        resp_count;  ///< responses returned by card
+  struct nn_classify_status_t    status;      ///< ncount, ID, UNC returned by card
+  uint16_t                       context;
+  uint16_t                       comps_count;
+  struct response_neuron_state_t resp[NN_MAX_RESP_COUNT];
+  nn_vector_comp_t               comp[NN_NEURON_COMPONENTS];
+};
+
+struct ntpcie_cache_t
+{
+  uint32_t                     entries_max;
+  uint32_t                     entries_count;
+  uint32_t                     buckets_mask;
+  uint32_t                     lru_head;      ///< most recently used entry
+  uint32_t                     lru_tail;      ///< least recently used entry (evicted first)
+  uint32_t*                    buckets;
+  struct ntpcie_cache_entry_t* entries;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+struct ntpcie_cache_t* ntpcie_cache_create(const size_t entries_max);
+void ntpcie_cache_destroy(struct ntpcie_cache_t* const cache);
+void ntpcie_cache_clear(struct ntpcie_cache_t* const cache);
+void ntpcie_cache_key_make(struct ntpcie_cache_key_t* const key,
+                           const enum nn_dist_eval_t dist_eval,
+                           const uint16_t context,
+                           const enum nn_classifier_t classifier,
+                           const size_t answers,
+                           const size_t comps_count,
+                           const nn_vector_comp_t data_vector[]);
+bool ntpcie_cache_lookup(struct ntpcie_cache_t* const cache,
+                         const struct ntpcie_cache_key_t* const key,
+                         size_t* const number_of_responses,
+                         struct response_neuron_state_t resp[],
+                         struct nn_classify_status_t* const status);
+void ntpcie_cache_insert(struct ntpcie_cache_t* const cache,
+                         const struct ntpcie_cache_key_t* const key,
+                         const size_t number_of_responses,
+                         const struct response_neuron_state_t resp[],
+                         const struct nn_classify_status_t* const status);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ONCE_INC_NTAPCIE_CACHE_H_
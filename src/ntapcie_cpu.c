@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntia_api_data_types.h"
+#include "ntia_api.h"
+#include "ntia_api_data_types_ll.h"
+
+#include "ntapcie_int.h"
+#include "ntapcie_thread.h"
+
+// CPU (host) engine: RBF/KNN classify over knowledge base in RAM (array of nn_neuron_t, e.g. stored
+// from card or read from KB file) with the same semantics as card (see model of NN in transport_emu.c):
+// - distance L1 or Lsup over the first comps_count components;
+// - only neurons of context are used, neuron fires in RBF mode if distance < AIF,
+//   in KNN mode all neurons of context fire;
+// - responses are sorted by distance (and by position in chain for equal distances),
+//   neuron id is position in chain (1-based), ncount of card is limited by NN_FIRED_NCOUNT_MAX
+//
+// distance kernels: AVX-512BW / AVX2 (psadbw, pmaxub) on x86-64, NEON on aarch64, scalar otherwise
+
+#if (defined(__amd64__) || defined(__x86_64__)) && (defined(__GNUC__) || defined(__clang__))
+#define CPU_HAVE_X86_SIMD (1)
+#include <immintrin.h>
+#else
+#define CPU_HAVE_X86_SIMD (0)
+#endif // __amd64__
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define CPU_HAVE_NEON (1)
+#include <arm_neon.h>
+#else
+#define CPU_HAVE_NEON (0)
+#endif // __aarch64__
+
+// vector to classify: components (zero padded) and mask of valid components
+struct cpu_query_t
+{
+  NTPCIE_ALIGNAS(64) uint8_t comp[NN_NEURON_COMPONENTS];
+  NTPCIE_ALIGNAS(64) uint8_t mask[NN_NEURON_COMPONENTS];
+  size_t  comps_count;
+};
+
+typedef uint32_t (*cpu_distance_fn_t)(const uint8_t* const comp, const struct cpu_query_t* const query);
+
+struct cpu_kernels_t
+{
+  cpu_distance_fn_t l1;
+  cpu_distance_fn_t lsup;
+};
+
+/// internal functions
+static cpu_distance_fn_t cpu_distance_fn_get(const enum nn_dist_eval_t dist_eval);
+static void cpu_query_build(struct cpu_query_t* const query, const size_t comps_count, const nn_vector_comp_t data_vector[]);
+static const struct cpu_kernels_t* cpu_kernels_resolve(void);
+static const struct cpu_kernels_t* cpu_kernels_find(const enum nn_cpu_kernel_t kernel);
+static uint32_t cpu_distance_l1_scalar(const uint8_t* const comp, const struct cpu_query_t* const query);
+static uint32_t cpu_distance_lsup_scalar(const uint8_t* const comp, const struct cpu_query_t* const query);
+#if CPU_HAVE_X86_SIMD
+static uint32_t cpu_distance_l1_avx2(const uint8_t* const comp, const struct cpu_query_t* const query);
+static uint32_t cpu_distance_lsup_avx2(const uint8_t* const comp, const struct cpu_query_t* const query);
+static uint32_t cpu_distance_l1_avx512(const uint8_t* const comp, const struct cpu_query_t* const query);
+static uint32_t cpu_distance_lsup_avx512(const uint8_t* const comp, const struct cpu_query_t* const query);
+#endif // CPU_HAVE_X86_SIMD
+#if CPU_HAVE_NEON
+static uint32_t cpu_distance_l1_neon(const uint8_t* const comp, const struct cpu_query_t* const query);
+static uint32_t cpu_distance_lsup_neon(const uint8_t* const comp, const struct cpu_query_t* const query);
+#endif // CPU_HAVE_NEON
+
+static const struct cpu_kernels_t cpu_kernels_scalar = { cpu_distance_l1_scalar, cpu_distance_lsup_scalar };
+#if CPU_HAVE_X86_SIMD
+static const struct cpu_kernels_t cpu_kernels_avx2   = { cpu_distance_l1_avx2, cpu_distance_lsup_avx2 };
+static const struct cpu_kernels_t cpu_kernels_avx512 = { cpu_distance_l1_avx512, cpu_distance_lsup_avx512 };
+#endif // CPU_HAVE_X86_SIMD
+#if CPU_HAVE_NEON
+static const struct cpu_kernels_t cpu_kernels_neon   = { cpu_distance_l1_neon, cpu_distance_lsup_neon };
+#endif // CPU_HAVE_NEON
+
+// kernels are selected by features of CPU at first call (NULL - not selected yet)
+// or by ntpcie_cpu_kernel_select()
+static ntpcie_atomic_ptr_t cpu_kernels;
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_cpu_kernel_select(const enum nn_cpu_kernel_t kernel)
+{
+  const struct cpu_kernels_t* const kernels = cpu_kernels_find(kernel);
+  if (kernels == NULL)
+  {
+    return NTPCIE_ERROR_ARGS_CPU_KERNEL;
+  }
+
+  ntpcie_atomic_ptr_store(&cpu_kernels, (void*)kernels, NTPCIE_MEMORY_ORDER_RELAXED);
+  return NTPCIE_ERROR_SUCCESS;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_cpu_vector_classify(const struct nn_neuron_t neurons[],
+                                                           const size_t neurons_count,
+                                                           const enum nn_dist_eval_t dist_eval,
+                                                           const uint16_t context,
+                                                           const enum nn_classifier_t classifier,
+                                                           const size_t comps_count,
+                                                           const nn_vector_comp_t data_vector[],
+                                                           size_t* const number_of_responses,
+                                                           struct response_neuron_state_t resp[])
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if ((neurons == NULL && neurons_count > 0) || (data_vector == NULL) || (number_of_responses == NULL) || (resp == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((comps_count < 1) || (comps_count > NN_NEURON_COMPONENTS))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
+    goto ret_result;
+  }
+  else if ((dist_eval != NN_DIST_EVAL_L1) && (dist_eval != NN_DIST_EVAL_LSUP))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_DIST_EVAL;
+    goto ret_result;
+  }
+  else if ((context < 1) || (context > 127))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CONTEXT;
+    goto ret_result;
+  }
+  else if ((classifier != NN_CLASSIFIER_KNN) && (classifier != NN_CLASSIFIER_RBF))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CLASSIFIER;
+    goto ret_result;
+  }
+  else if ((*number_of_responses < 1) || (*number_of_responses > NN_MAX_RESP_COUNT))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_RESP_COUNT;
+    goto ret_result;
+  }
+
+  const cpu_distance_fn_t distance_calc = cpu_distance_fn_get(dist_eval);
+  const bool knn                        = (classifier == NN_CLASSIFIER_KNN);
+  const size_t answers                  = *number_of_responses;
+
+  struct cpu_query_t query;
+
+  cpu_query_build(&query, comps_count, data_vector);
+
+  size_t fired_count = 0;
+  size_t resp_count  = 0;
+
+  for (size_t ix = 0; ix < neurons_count; ++ix)
+  {
+    const struct nn_neuron_t* const neuron = &neurons[ix];
+    if ((neuron->ncr & 0x7Fu) != context)
+    {
+      continue;
+    }
+
+    uint32_t distance = distance_calc(neuron->comp, &query);
+    // ATT: 0xFFFF is reserved as "no response" marker
+    if (distance >= 0xFFFFu)
+    {
+      distance = 0xFFFEu;
+    }
+
+    if (knn == false && distance >= neuron->aif)
+    {
+      continue;
+    }
+
+    ++fired_count;
+
+    // list is full and response is not closer than the last one (neurons are visited in chain order)
+    if (resp_count == answers && resp[resp_count - 1].distance <= distance)
+    {
+      continue;
+    }
+
+    size_t pos = resp_count;
+    while (pos > 0 && resp[pos - 1].distance > distance)
+    {
+      --pos;
+    }
+    if (resp_count < answers)
+    {
+      ++resp_count;
+    }
+    memmove(&resp[pos + 1], &resp[pos], (resp_count - 1 - pos) * sizeof(resp[0]));
+
+    resp[pos].distance    = (uint16_t)distance;
+    resp[pos].category    = neuron->category & 0x7FFFu;
+    resp[pos].degenerated = (neuron->category >> 15) & 0x01u;
+    resp[pos].id          = (uint16_t)(ix + 1);
+  }
+
+  // ATT: card reports not more than NN_FIRED_NCOUNT_MAX fired neurons, responses are limited by it
+  if (fired_count > NN_FIRED_NCOUNT_MAX)
+  {
+    fired_count = NN_FIRED_NCOUNT_MAX;
+  }
+  *number_of_responses = (resp_count > fired_count) ? fired_count : resp_count;
+
+ret_result:
+  return nn_result;
+}
+
+// neurons of context fired by vector (distance < AIF), as by learn of card: indices of them are written
+// to fired_ix[] (neurons_count size), their amount is returned; arguments are checked by caller
+size_t ntpcie_cpu_vector_fire(const struct nn_neuron_t neurons[],
+                              const size_t neurons_count,
+                              const enum nn_dist_eval_t dist_eval,
+                              const uint16_t context,
+                              const size_t comps_count,
+                              const nn_vector_comp_t data_vector[],
+                              size_t fired_ix[])
+{
+  const cpu_distance_fn_t distance_calc = cpu_distance_fn_get(dist_eval);
+  size_t fired_count                    = 0;
+
+  struct cpu_query_t query;
+
+  cpu_query_build(&query, comps_count, data_vector);
+
+  for (size_t ix = 0; ix < neurons_count; ++ix)
+  {
+    if (((neurons[ix].ncr & 0x7Fu) == context) && (distance_calc(neurons[ix].comp, &query) < neurons[ix].aif))
+    {
+      fired_ix[fired_count++] = ix;
+    }
+  }
+
+  return fired_count;
+}
+
+/// internal functions
+
+static cpu_distance_fn_t cpu_distance_fn_get(const enum nn_dist_eval_t dist_eval)
+{
+  const struct cpu_kernels_t* kernels = ntpcie_atomic_ptr_load(&cpu_kernels, NTPCIE_MEMORY_ORDER_RELAXED);
+  if (kernels == NULL)
+  {
+    kernels = cpu_kernels_resolve();
+  }
+
+  return (dist_eval == NN_DIST_EVAL_LSUP) ? kernels->lsup : kernels->l1;
+}
+
+static void cpu_query_build(struct cpu_query_t* const query, const size_t comps_count, const nn_vector_comp_t data_vector[])
+{
+  memset(query, 0, sizeof(*query));
+  memcpy(query->comp, data_vector, comps_count * sizeof(data_vector[0]));
+  memset(query->mask, 0xFFu, comps_count);
+  query->comps_count = comps_count;
+}
+
+// first classify of process: threads racing here store the same (detected) kernels
+static const struct cpu_kernels_t* cpu_kernels_resolve(void)
+{
+  const struct cpu_kernels_t* const kernels = cpu_kernels_find(NN_CPU_KERNEL_AUTO);
+
+  ntpcie_atomic_ptr_store(&cpu_kernels, (void*)kernels, NTPCIE_MEMORY_ORDER_RELAXED);
+  return kernels;
+}
+
+// kernels of given kind (NULL - not supported by build or CPU), AUTO - the fastest supported ones
+static const struct cpu_kernels_t* cpu_kernels_find(const enum nn_cpu_kernel_t kernel)
+{
+  const struct cpu_kernels_t* kernels = NULL;
+
+#if CPU_HAVE_X86_SIMD
+  __builtin_cpu_init();
+  const bool have_avx512 = __builtin_cpu_supports("avx512bw");
+  const bool have_avx2   = __builtin_cpu_supports("avx2");
+#endif // CPU_HAVE_X86_SIMD
+
+  switch (kernel)
+  {
+    case NN_CPU_KERNEL_AUTO:
+      kernels = &cpu_kernels_scalar;
+#if CPU_HAVE_X86_SIMD
+      if (have_avx512)
+      {
+        kernels = &cpu_kernels_avx512;
+      }
+      else if (have_avx2)
+      {
+        kernels = &cpu_kernels_avx2;
+      }
+#endif // CPU_HAVE_X86_SIMD
+#if CPU_HAVE_NEON
+      kernels = &cpu_kernels_neon;
+#endif // CPU_HAVE_NEON
+      break;
+    case NN_CPU_KERNEL_SCALAR:
+      kernels = &cpu_kernels_scalar;
+      break;
+#if CPU_HAVE_X86_SIMD
+    case NN_CPU_KERNEL_AVX2:
+      kernels = (have_avx2) ? &cpu_kernels_avx2 : NULL;
+      break;
+    case NN_CPU_KERNEL_AVX512:
+      kernels = (have_avx512) ? &cpu_kernels_avx512 : NULL;
+      break;
+#endif // CPU_HAVE_X86_SIMD
+#if CPU_HAVE_NEON
+    case NN_CPU_KERNEL_NEON:
+      kernels = &cpu_kernels_neon;
+      break;
+#endif // CPU_HAVE_NEON
+    default:
+      break;
+  }
+
+  return kernels;
+}
+
+static uint32_t cpu_distance_l1_scalar(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  uint32_t distance = 0;
+
+  for (size_t ix = 0; ix < query->comps_count; ++ix)
+  {
+    distance += (comp[ix] > query->comp[ix]) ? (uint32_t)(comp[ix] - query->comp[ix]) : (uint32_t)(query->comp[ix] - comp[ix]);
+  }
+  return distance;
+}
+
+static uint32_t cpu_distance_lsup_scalar(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  uint32_t distance = 0;
+
+  for (size_t ix = 0; ix < query->comps_count; ++ix)
+  {
+    const uint32_t delta = (comp[ix] > query->comp[ix]) ? (uint32_t)(comp[ix] - query->comp[ix]) : (uint32_t)(query->comp[ix] - comp[ix]);
+    if (delta > distance)
+    {
+      distance = delta;
+    }
+  }
+  return distance;
+}
+
+#if CPU_HAVE_X86_SIMD
+
+// components of neuron beyond comps_count are masked out (query is zero padded)
+
+__attribute__((target("avx2")))
+static uint32_t cpu_distance_l1_avx2(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  __m256i acc = _mm256_setzero_si256();
+
+  for (size_t ix = 0; ix < query->comps_count; ix += 32)
+  {
+    const __m256i n = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(comp + ix)),
+                                       _mm256_load_si256((const __m256i*)(query->mask + ix)));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(n, _mm256_load_si256((const __m256i*)(query->comp + ix))));
+  }
+
+  const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  return (uint32_t)(_mm_cvtsi128_si32(sum) + _mm_extract_epi32(sum, 2));
+}
+
+__attribute__((target("avx2")))
+static uint32_t cpu_distance_lsup_avx2(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  __m256i acc = _mm256_setzero_si256();
+
+  for (size_t ix = 0; ix < query->comps_count; ix += 32)
+  {
+    const __m256i n = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(comp + ix)),
+                                       _mm256_load_si256((const __m256i*)(query->mask + ix)));
+    const __m256i q = _mm256_load_si256((const __m256i*)(query->comp + ix));
+    acc = _mm256_max_epu8(acc, _mm256_or_si256(_mm256_subs_epu8(n, q), _mm256_subs_epu8(q, n)));
+  }
+
+  __m128i max = _mm_max_epu8(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 8));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 4));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 2));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 1));
+  return (uint32_t)_mm_cvtsi128_si32(max) & 0xFFu;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static uint32_t cpu_distance_l1_avx512(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  __m512i acc = _mm512_setzero_si512();
+
+  for (size_t ix = 0; ix < query->comps_count; ix += 64)
+  {
+    const size_t remains = query->comps_count - ix;
+    const __mmask64 mask = (remains >= 64) ? ~(__mmask64)0 : (((__mmask64)1 << remains) - 1);
+    const __m512i n      = _mm512_maskz_loadu_epi8(mask, comp + ix);
+    acc = _mm512_add_epi64(acc, _mm512_sad_epu8(n, _mm512_load_si512((const void*)(query->comp + ix))));
+  }
+
+  return (uint32_t)_mm512_reduce_add_epi64(acc);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static uint32_t cpu_distance_lsup_avx512(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  __m512i acc = _mm512_setzero_si512();
+
+  for (size_t ix = 0; ix < query->comps_count; ix += 64)
+  {
+    const size_t remains = query->comps_count - ix;
+    const __mmask64 mask = (remains >= 64) ? ~(__mmask64)0 : (((__mmask64)1 << remains) - 1);
+    const __m512i n      = _mm512_maskz_loadu_epi8(mask, comp + ix);
+    const __m512i q      = _mm512_load_si512((const void*)(query->comp + ix));
+    acc = _mm512_max_epu8(acc, _mm512_or_si512(_mm512_subs_epu8(n, q), _mm512_subs_epu8(q, n)));
+  }
+
+  // max of bytes: 512 -> 256 -> 128 bits, then as in AVX2 kernel
+  const __m256i acc256 = _mm256_max_epu8(_mm512_castsi512_si256(acc), _mm512_extracti64x4_epi64(acc, 1));
+  __m128i max = _mm_max_epu8(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 8));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 4));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 2));
+  max = _mm_max_epu8(max, _mm_srli_si128(max, 1));
+  return (uint32_t)_mm_cvtsi128_si32(max) & 0xFFu;
+}
+
+#endif // CPU_HAVE_X86_SIMD
+
+#if CPU_HAVE_NEON
+
+static uint32_t cpu_distance_l1_neon(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  // ATT: 16 bit lanes can't overflow: max is 2 * 255 * (NN_NEURON_COMPONENTS / 16)
+  uint16x8_t acc = vdupq_n_u16(0);
+
+  for (size_t ix = 0; ix < query->comps_count; ix += 16)
+  {
+    const uint8x16_t n = vandq_u8(vld1q_u8(comp + ix), vld1q_u8(query->mask + ix));
+    acc = vpadalq_u8(acc, vabdq_u8(n, vld1q_u8(query->comp + ix)));
+  }
+
+  return vaddlvq_u16(acc);
+}
+
+static uint32_t cpu_distance_lsup_neon(const uint8_t* const comp, const struct cpu_query_t* const query)
+{
+  uint8x16_t acc = vdupq_n_u8(0);
+
+  for (size_t ix = 0; ix < query->comps_count; ix += 16)
+  {
+    const uint8x16_t n = vandq_u8(vld1q_u8(comp + ix), vld1q_u8(query->mask + ix));
+    acc = vmaxq_u8(acc, vabdq_u8(n, vld1q_u8(query->comp + ix)));
+  }
+
+  return vmaxvq_u8(acc);
+}
+
+#endif // CPU_HAVE_NEON
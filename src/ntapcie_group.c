@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntia_api_data_types.h"
+#include "ntia_api.h"
+#include "ntia_api_data_types_ll.h"
+#include "ntia_api_ll.h"
+
+#include "ntapcie_int.h"
+
+// card group: one logical knowledge base is spread over several cards (every card holds
+// partition of it), classify runs on all cards in parallel (asynchronous submit/poll),
+// responses of cards are merged by distance into one global top-K list
+
+/// internal functions
+static bool group_is_valid(const struct nta_card_group_t* const group);
+static enum ntpcie_nn_error_t group_classify_cards(struct nta_card_group_t* const group,
+                                                  const enum nn_dist_eval_t dist_eval,
+                                                  const uint16_t context,
+                                                  const enum nn_classifier_t classifier,
+                                                  const size_t comps_count,
+                                                  const nn_vector_comp_t data_vector[],
+                                                  const size_t number_of_responses,
+                                                  struct response_neuron_state_t cards_resp[][NN_MAX_RESP_COUNT],
+                                                  size_t cards_resp_count[]);
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_group_init(struct nta_card_group_t* const group,
+                                                  struct nta_dev_handle_t* const cards[],
+                                                  const size_t cards_count)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if ((group == NULL) || (cards == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((cards_count < 1) || (cards_count > NTIA_PCIE_MAX_CARDS))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CARDS_COUNT;
+    goto ret_result;
+  }
+
+  memset(group, 0, sizeof(*group));
+
+  for (size_t ix = 0; ix < cards_count; ++ix)
+  {
+    if (dev_handle_is_valid(cards[ix]) != true)
+    {
+      nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+      goto ret_result;
+    }
+    group->cards[ix] = cards[ix];
+  }
+  group->cards_count = cards_count;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_group_nn_reset(struct nta_card_group_t* const group)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (group_is_valid(group) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+
+  for (size_t ix = 0; ix < group->cards_count; ++ix)
+  {
+    nn_result = ntpcie_nn_reset(group->cards[ix]);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+  }
+
+ret_result:
+  return nn_result;
+}
+
+// group learns as single card holding whole KB: neurons of other category fired by vector shrink
+// on every card (learn of category 0 there), vector recognized by some card is not committed
+// (learn on recognizing card shrinks its neurons only), otherwise it is committed by card with most
+// free neurons, AIF of new neuron is limited by the closest neuron of other category of all cards;
+// ATT: only NN_MAX_RESP_COUNT closest neurons of every card are seen by classify of group
+enum ntpcie_nn_error_t NTIA_API ntpcie_group_vector_learn(struct nta_card_group_t* const group,
+                                                          const enum nn_dist_eval_t dist_eval,
+                                                          const uint16_t context,
+                                                          const uint16_t category,
+                                                          const uint16_t maxif,
+                                                          const uint16_t minif,
+                                                          const size_t comps_count,
+                                                          const nn_vector_comp_t data_vector[],
+                                                          size_t* const card_ix)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  size_t ix_learned                = NTIA_PCIE_MAX_CARDS;
+  size_t ix_best                   = 0;
+  size_t free_best                 = 0;
+  uint16_t maxif_commit            = maxif;
+
+  struct response_neuron_state_t cards_resp[NTIA_PCIE_MAX_CARDS][NN_MAX_RESP_COUNT];
+  size_t cards_resp_count[NTIA_PCIE_MAX_CARDS];
+  bool cards_recognized[NTIA_PCIE_MAX_CARDS];
+  bool cards_fired[NTIA_PCIE_MAX_CARDS];
+
+  if (group_is_valid(group) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+
+  // neurons fired by vector (RBF) on every card
+  nn_result = group_classify_cards(group, dist_eval, context, NN_CLASSIFIER_RBF, comps_count, data_vector,
+                                   NN_MAX_RESP_COUNT, cards_resp, cards_resp_count);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  for (size_t ix = 0; ix < group->cards_count; ++ix)
+  {
+    cards_recognized[ix] = false;
+    cards_fired[ix]      = (cards_resp_count[ix] > 0);
+    for (size_t ix_resp = 0; (ix_resp < cards_resp_count[ix]) && (category != 0); ++ix_resp)
+    {
+      if (cards_resp[ix][ix_resp].category == category)
+      {
+        cards_recognized[ix] = true;
+        ix_learned           = (ix_learned == NTIA_PCIE_MAX_CARDS) ? ix : ix_learned;
+        break;
+      }
+    }
+  }
+
+  if ((category != 0) && (ix_learned == NTIA_PCIE_MAX_CARDS))
+  {
+    // partitions are kept balanced: vector is committed by card with most free neurons
+    for (size_t ix = 0; ix < group->cards_count; ++ix)
+    {
+      const struct nn_state_t* const nn_state = &group->cards[ix]->nn_state;
+      const size_t neurons_free = (nn_state->neurons_overall > nn_state->neurons_committed)
+                                ? (nn_state->neurons_overall - nn_state->neurons_committed)
+                                : 0;
+      if (neurons_free > free_best)
+      {
+        ix_best   = ix;
+        free_best = neurons_free;
+      }
+    }
+
+    // closest neurons of other category on other cards (KNN): card limits AIF by its own neurons only
+    nn_result = group_classify_cards(group, dist_eval, context, NN_CLASSIFIER_KNN, comps_count, data_vector,
+                                     NN_MAX_RESP_COUNT, cards_resp, cards_resp_count);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+
+    for (size_t ix = 0; ix < group->cards_count; ++ix)
+    {
+      for (size_t ix_resp = 0; (ix_resp < cards_resp_count[ix]) && (ix != ix_best); ++ix_resp)
+      {
+        if (cards_resp[ix][ix_resp].category != category)
+        {
+          maxif_commit = (cards_resp[ix][ix_resp].distance < maxif_commit) ? cards_resp[ix][ix_resp].distance : maxif_commit;
+          break;
+        }
+      }
+    }
+    // ATT: new neuron limited by other card down to MINIF gets AIF MINIF, but it is not marked degenerated
+    maxif_commit = (maxif_commit > minif) ? maxif_commit : minif;
+
+    cards_recognized[ix_best] = true;
+    ix_learned                = ix_best;
+  }
+
+  for (size_t ix = 0; ix < group->cards_count; ++ix)
+  {
+    if (cards_recognized[ix])
+    {
+      nn_result = ntpcie_nn_vector_learn(group->cards[ix], dist_eval, context, category,
+                                         maxif_commit, minif, comps_count, data_vector);
+    }
+    else if (cards_fired[ix])
+    {
+      // only neurons of other category fired on card: they are shrunk, nothing is committed
+      nn_result = ntpcie_nn_vector_learn(group->cards[ix], dist_eval, context, 0,
+                                         maxif, minif, comps_count, data_vector);
+    }
+
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+  }
+
+  if (card_ix != NULL)
+  {
+    *card_ix = ix_learned;
+  }
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_group_vector_classify(struct nta_card_group_t* const group,
+                                                             const enum nn_dist_eval_t dist_eval,
+                                                             const uint16_t context,
+                                                             const enum nn_classifier_t classifier,
+                                                             const size_t comps_count,
+                                                             const nn_vector_comp_t data_vector[],
+                                                             size_t* const number_of_responses,
+                                                             struct response_neuron_state_t resp[],
+                                                             size_t resp_cards_ix[])
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  struct response_neuron_state_t cards_resp[NTIA_PCIE_MAX_CARDS][NN_MAX_RESP_COUNT];
+  const struct response_neuron_state_t* cards_lists[NTIA_PCIE_MAX_CARDS];
+  size_t cards_resp_count[NTIA_PCIE_MAX_CARDS];
+
+  if (group_is_valid(group) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if ((number_of_responses == NULL) || (resp == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((*number_of_responses < 1) || (*number_of_responses > NN_MAX_RESP_COUNT))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_RESP_COUNT;
+    goto ret_result;
+  }
+
+  nn_result = group_classify_cards(group, dist_eval, context, classifier, comps_count, data_vector,
+                                   *number_of_responses, cards_resp, cards_resp_count);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  for (size_t ix = 0; ix < group->cards_count; ++ix)
+  {
+    cards_lists[ix] = cards_resp[ix];
+  }
+  *number_of_responses = nn_resp_merge(cards_lists, cards_resp_count, group->cards_count,
+                                       resp, resp_cards_ix, *number_of_responses);
+
+ret_result:
+  return nn_result;
+}
+
+/// internal functions
+static bool group_is_valid(const struct nta_card_group_t* const group)
+{
+  if ((group == NULL) || (group->cards_count < 1) || (group->cards_count > NTIA_PCIE_MAX_CARDS))
+  {
+    return false;
+  }
+
+  for (size_t ix = 0; ix < group->cards_count; ++ix)
+  {
+    if (dev_handle_is_valid(group->cards[ix]) != true)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// vector is classified by all cards of group in parallel, every card returns own list of responses
+static enum ntpcie_nn_error_t group_classify_cards(struct nta_card_group_t* const group,
+                                                  const enum nn_dist_eval_t dist_eval,
+                                                  const uint16_t context,
+                                                  const enum nn_classifier_t classifier,
+                                                  const size_t comps_count,
+                                                  const nn_vector_comp_t data_vector[],
+                                                  const size_t number_of_responses,
+                                                  struct response_neuron_state_t cards_resp[][NN_MAX_RESP_COUNT],
+                                                  size_t cards_resp_count[])
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  size_t pending_count             = 0;
+
+  uint32_t cards_token[NTIA_PCIE_MAX_CARDS];
+  bool cards_pending[NTIA_PCIE_MAX_CARDS];
+
+  // completions are taken in order of submission: request of group must be the only one of card
+  for (size_t ix = 0; ix < group->cards_count; ++ix)
+  {
+    size_t async_count = 0;
+
+    nn_result = ntpcie_async_pending(group->cards[ix], &async_count);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+    else if (async_count > 0)
+    {
+      nn_result = NTPCIE_ERROR_BUSY;
+      goto ret_result;
+    }
+  }
+
+  // vector is uploaded to all cards first, then cards compute in parallel
+  for (size_t ix = 0; ix < group->cards_count; ++ix)
+  {
+    cards_resp_count[ix] = 0;
+    cards_pending[ix]    = false;
+
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      continue;
+    }
+
+    nn_result = ntpcie_submit_classify(group->cards[ix], dist_eval, context, classifier, comps_count, data_vector,
+                                       number_of_responses, cards_resp[ix], &cards_token[ix]);
+    if (nn_result == NTPCIE_ERROR_SUCCESS)
+    {
+      cards_pending[ix] = true;
+      ++pending_count;
+    }
+  }
+
+  // ATT: requests already submitted are polled even if submit to other card failed: responses are
+  // written to buffers on stack, so every request is completed before return (by result of card or
+  // by NTPCIE_ERROR_WAIT_TIMEOUT at deadline of request, see ntpcie_poll_completions())
+  while (pending_count > 0)
+  {
+    size_t ix_waiting = NTIA_PCIE_MAX_CARDS;
+
+    for (size_t ix = 0; ix < group->cards_count; ++ix)
+    {
+      if (cards_pending[ix] != true)
+      {
+        continue;
+      }
+
+      struct nta_completion_t completion;
+      size_t completions_count = 0;
+
+      enum ntpcie_nn_error_t poll_result = ntpcie_poll_completions(group->cards[ix], &completion, 1, &completions_count);
+      if (poll_result == NTPCIE_ERROR_SUCCESS && completions_count == 0)
+      {
+        // card is still busy
+        if (ix_waiting == NTIA_PCIE_MAX_CARDS)
+        {
+          ix_waiting = ix;
+        }
+        continue;
+      }
+      else if (poll_result == NTPCIE_ERROR_SUCCESS)
+      {
+        poll_result          = completion.result;
+        cards_resp_count[ix] = completion.number_of_responses;
+      }
+
+      cards_pending[ix] = false;
+      --pending_count;
+
+      if (poll_result != NTPCIE_ERROR_SUCCESS && nn_result == NTPCIE_ERROR_SUCCESS)
+      {
+        nn_result = poll_result;
+      }
+    }
+
+    // no busy spin: block until event of the first busy card (if transport supports it)
+    if (ix_waiting != NTIA_PCIE_MAX_CARDS)
+    {
+      ntpcie_async_wait_event(group->cards[ix_waiting]);
+    }
+  }
+
+ret_result:
+  return nn_result;
+}
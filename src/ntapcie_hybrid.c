@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntia_api_data_types.h"
+#include "ntia_api.h"
+#include "ntia_api_data_types_ll.h"
+#include "ntia_api_ll.h"
+
+#include "ntapcie_int.h"
+#include "ntapcie_thread.h"
+
+// hybrid card/CPU: card holds knowledge base, host keeps mirror (snapshot) of the same knowledge base;
+// classify request goes to card while its expected wait
+//     (requests in flight + 1) * recent service time of card
+// fits into latency budget, otherwise request is classified by CPU engine against mirror
+// (at most host_slots requests on CPU at once); responses of both engines are identical;
+// learn patches mirror: committed neuron and neurons which AIF may shrink are read back from card
+
+// immutable snapshot of knowledge base, released by last user (classify may run during re-sync)
+struct hybrid_mirror_t
+{
+  ntpcie_atomic_u32_t refs;
+  size_t              neurons_count;
+  struct nn_neuron_t  neurons[];
+};
+
+struct hybrid_t
+{
+  struct nta_dev_handle_t* dev_handle;
+  uint64_t                 budget_ns;
+  unsigned                 host_slots;
+  ntpcie_mutex_t           learn_lock;       ///< changes of knowledge base and sync of mirror are serialized
+  ntpcie_mutex_t           mirror_lock;      ///< protects only replace/acquire of mirror
+  struct hybrid_mirror_t*  mirror;           ///< NULL - mirror is not valid (no spill until sync)
+  size_t                   neurons_max;      ///< capacity of mirror (neurons of card)
+  size_t*                  fired_ix;         ///< neurons fired by learned vector (neurons_max size, under learn_lock)
+  uint8_t                  _pad[64];         ///< counters below are updated by every classify
+  ntpcie_atomic_u32_t      card_inflight;    ///< requests routed to card and not finished yet
+  ntpcie_atomic_u64_t      card_service_ns;  ///< smoothed service time of card (0 - not measured yet)
+  ntpcie_atomic_u32_t      host_inflight;    ///< requests classified by CPU engine now
+};
+
+/// internal functions
+static struct hybrid_t* hybrid_get(const struct nta_card_hybrid_t* const hybrid);
+static struct hybrid_mirror_t* hybrid_mirror_alloc(const struct hybrid_t* const _hybrid);
+static enum ntpcie_nn_error_t hybrid_mirror_sync(struct hybrid_t* const _hybrid);
+static struct hybrid_mirror_t* hybrid_mirror_patch(struct hybrid_t* const _hybrid,
+                                                   struct hybrid_mirror_t* mirror,
+                                                   const enum nn_dist_eval_t dist_eval,
+                                                   const uint16_t context,
+                                                   const uint16_t category,
+                                                   const size_t comps_count,
+                                                   const nn_vector_comp_t data_vector[],
+                                                   const uint16_t ncount);
+static void hybrid_mirror_replace(struct hybrid_t* const _hybrid, struct hybrid_mirror_t* const mirror);
+static struct hybrid_mirror_t* hybrid_mirror_detach(struct hybrid_t* const _hybrid);
+static struct hybrid_mirror_t* hybrid_mirror_acquire(struct hybrid_t* const _hybrid);
+static void hybrid_mirror_release(struct hybrid_mirror_t* const mirror);
+static bool hybrid_card_is_late(struct hybrid_t* const _hybrid);
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_init(struct nta_card_hybrid_t* const hybrid,
+                                                   struct nta_dev_handle_t* const dev_handle,
+                                                   const uint32_t latency_budget_us,
+                                                   const size_t host_slots)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct hybrid_t* _hybrid         = NULL;
+
+  if (hybrid == NULL)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  hybrid->_hybrid_handle = NULL;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+
+  // requests of many application threads are executed by card one by one
+  nn_result = ntpcie_device_queue_start(dev_handle);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  _hybrid = (struct hybrid_t*)calloc(1, sizeof(*_hybrid));
+  if (_hybrid == NULL)
+  {
+    nn_result = NTPCIE_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  _hybrid->dev_handle  = dev_handle;
+  _hybrid->budget_ns   = (uint64_t)latency_budget_us * 1000u;
+  _hybrid->host_slots  = (unsigned)host_slots;
+  _hybrid->mirror      = NULL;
+  _hybrid->neurons_max = dev_handle->nn_state.neurons_overall;
+  _hybrid->fired_ix    = (size_t*)malloc((_hybrid->neurons_max + 1) * sizeof(*_hybrid->fired_ix));
+  if (_hybrid->fired_ix == NULL)
+  {
+    nn_result = NTPCIE_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  ntpcie_mutex_init(&_hybrid->learn_lock);
+  ntpcie_mutex_init(&_hybrid->mirror_lock);
+  ntpcie_atomic_u32_init(&_hybrid->card_inflight, 0);
+  ntpcie_atomic_u64_init(&_hybrid->card_service_ns, 0);
+  ntpcie_atomic_u32_init(&_hybrid->host_inflight, 0);
+
+  nn_result = hybrid_mirror_sync(_hybrid);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    ntpcie_mutex_destroy(&_hybrid->mirror_lock);
+    ntpcie_mutex_destroy(&_hybrid->learn_lock);
+    goto ret_result;
+  }
+
+  hybrid->_hybrid_handle = _hybrid;
+  _hybrid                = NULL;
+
+ret_result:
+  if (_hybrid != NULL)
+  {
+    free(_hybrid->fired_ix);
+    free(_hybrid);
+  }
+  return nn_result;
+}
+
+// mirror is freed by last classify which still uses it; IO queue of card is left to its owner
+enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_deinit(struct nta_card_hybrid_t* const hybrid)
+{
+  struct hybrid_t* const _hybrid = hybrid_get(hybrid);
+  if (_hybrid == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  hybrid_mirror_replace(_hybrid, NULL);
+  ntpcie_mutex_destroy(&_hybrid->mirror_lock);
+  ntpcie_mutex_destroy(&_hybrid->learn_lock);
+  free(_hybrid->fired_ix);
+  free(_hybrid);
+  hybrid->_hybrid_handle = NULL;
+
+  return NTPCIE_ERROR_SUCCESS;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_nn_reset(struct nta_card_hybrid_t* const hybrid)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct hybrid_t* const _hybrid   = hybrid_get(hybrid);
+
+  if (_hybrid == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  ntpcie_mutex_lock(&_hybrid->learn_lock);
+  hybrid_mirror_replace(_hybrid, NULL);
+  nn_result = ntpcie_nn_reset(_hybrid->dev_handle);
+  if (nn_result == NTPCIE_ERROR_SUCCESS)
+  {
+    // empty knowledge base is known without reading it back
+    hybrid_mirror_replace(_hybrid, hybrid_mirror_alloc(_hybrid));
+  }
+  ntpcie_mutex_unlock(&_hybrid->learn_lock);
+
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_vector_learn(struct nta_card_hybrid_t* const hybrid,
+                                                           const enum nn_dist_eval_t dist_eval,
+                                                           const uint16_t context,
+                                                           const uint16_t category,
+                                                           const uint16_t maxif,
+                                                           const uint16_t minif,
+                                                           const size_t comps_count,
+                                                           const nn_vector_comp_t data_vector[])
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct hybrid_t* const _hybrid   = hybrid_get(hybrid);
+
+  struct nn_learn_result_t result;
+
+  if (_hybrid == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  // requests go to card while knowledge base changes, mirror is patched and put back after learn
+  ntpcie_mutex_lock(&_hybrid->learn_lock);
+  struct hybrid_mirror_t* mirror = hybrid_mirror_detach(_hybrid);
+
+  nn_result = ntpcie_nn_vector_learn_ex(_hybrid->dev_handle, dist_eval, context, category,
+                                        maxif, minif, comps_count, data_vector, &result);
+  if (mirror != NULL)
+  {
+    if (nn_result == NTPCIE_ERROR_SUCCESS)
+    {
+      mirror = hybrid_mirror_patch(_hybrid, mirror, dist_eval, context, category, comps_count, data_vector, result.ncount);
+    }
+    else
+    {
+      // knowledge base of card is unknown (pack may be executed): no spill until sync
+      hybrid_mirror_release(mirror);
+      mirror = NULL;
+    }
+  }
+
+  hybrid_mirror_replace(_hybrid, mirror);
+  ntpcie_mutex_unlock(&_hybrid->learn_lock);
+
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_mirror_sync(struct nta_card_hybrid_t* const hybrid)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct hybrid_t* const _hybrid   = hybrid_get(hybrid);
+
+  if (_hybrid == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  ntpcie_mutex_lock(&_hybrid->learn_lock);
+  nn_result = hybrid_mirror_sync(_hybrid);
+  ntpcie_mutex_unlock(&_hybrid->learn_lock);
+
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_hybrid_vector_classify(struct nta_card_hybrid_t* const hybrid,
+                                                              const enum nn_dist_eval_t dist_eval,
+                                                              const uint16_t context,
+                                                              const enum nn_classifier_t classifier,
+                                                              const size_t comps_count,
+                                                              const nn_vector_comp_t data_vector[],
+                                                              size_t* const number_of_responses,
+                                                              struct response_neuron_state_t resp[],
+                                                              bool* const on_host)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct hybrid_t* const _hybrid   = hybrid_get(hybrid);
+  struct hybrid_mirror_t* mirror   = NULL;
+
+  if (_hybrid == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  if (hybrid_card_is_late(_hybrid))
+  {
+    // slot of host is taken first: requests over host_slots wait in queue of card
+    if (ntpcie_atomic_u32_fetch_add(&_hybrid->host_inflight, 1, NTPCIE_MEMORY_ORDER_RELAXED) < _hybrid->host_slots)
+    {
+      mirror = hybrid_mirror_acquire(_hybrid);
+    }
+    if (mirror == NULL)
+    {
+      ntpcie_atomic_u32_fetch_sub(&_hybrid->host_inflight, 1, NTPCIE_MEMORY_ORDER_RELAXED);
+    }
+  }
+
+  if (mirror != NULL)
+  {
+    nn_result = ntpcie_cpu_vector_classify(mirror->neurons, mirror->neurons_count, dist_eval, context, classifier,
+                                           comps_count, data_vector, number_of_responses, resp);
+    hybrid_mirror_release(mirror);
+    ntpcie_atomic_u32_fetch_sub(&_hybrid->host_inflight, 1, NTPCIE_MEMORY_ORDER_RELAXED);
+  }
+  else
+  {
+    const unsigned queued  = ntpcie_atomic_u32_fetch_add(&_hybrid->card_inflight, 1, NTPCIE_MEMORY_ORDER_RELAXED);
+    const uint64_t t_start = ntpcie_clock_ns();
+
+    nn_result = ntpcie_nn_vector_classify(_hybrid->dev_handle, dist_eval, context, classifier,
+                                          comps_count, data_vector, number_of_responses, resp);
+
+    const uint64_t t_stop = ntpcie_clock_ns();
+    ntpcie_atomic_u32_fetch_sub(&_hybrid->card_inflight, 1, NTPCIE_MEMORY_ORDER_RELAXED);
+
+    if (nn_result == NTPCIE_ERROR_SUCCESS)
+    {
+      ntpcie_service_update(&_hybrid->card_service_ns, t_stop - t_start, queued);
+    }
+  }
+
+  if (on_host != NULL)
+  {
+    *on_host = (mirror != NULL);
+  }
+
+  return nn_result;
+}
+
+/// internal functions
+static struct hybrid_t* hybrid_get(const struct nta_card_hybrid_t* const hybrid)
+{
+  if (hybrid == NULL)
+  {
+    return NULL;
+  }
+  return (struct hybrid_t*)hybrid->_hybrid_handle;
+}
+
+// empty mirror of capacity of card (NULL - no memory)
+static struct hybrid_mirror_t* hybrid_mirror_alloc(const struct hybrid_t* const _hybrid)
+{
+  struct hybrid_mirror_t* const mirror = (struct hybrid_mirror_t*)calloc(1, offsetof(struct hybrid_mirror_t, neurons)
+                                                                              + _hybrid->neurons_max * sizeof(struct nn_neuron_t));
+  if (mirror != NULL)
+  {
+    ntpcie_atomic_u32_init(&mirror->refs, 1);
+    mirror->neurons_count = 0;
+  }
+  return mirror;
+}
+
+// ATT: learn_lock must be held by caller
+static enum ntpcie_nn_error_t hybrid_mirror_sync(struct hybrid_t* const _hybrid)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  struct hybrid_mirror_t* mirror = hybrid_mirror_alloc(_hybrid);
+  if (mirror == NULL)
+  {
+    nn_result = NTPCIE_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  nn_result = ntpcie_kbase_store_all(_hybrid->dev_handle, mirror->neurons, _hybrid->neurons_max, &mirror->neurons_count);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  hybrid_mirror_replace(_hybrid, mirror);
+  mirror = NULL;
+
+ret_result:
+  free(mirror);
+  return nn_result;
+}
+
+// mirror (detached, before learn) is updated by neurons changed by learn: neurons of other category
+// fired by learned vector (their AIF may shrink) and committed neurons are read back from card;
+// mirror still used by classify is copied first; NULL is returned on error (mirror is released)
+// ATT: learn_lock must be held by caller
+static struct hybrid_mirror_t* hybrid_mirror_patch(struct hybrid_t* const _hybrid,
+                                                   struct hybrid_mirror_t* mirror,
+                                                   const enum nn_dist_eval_t dist_eval,
+                                                   const uint16_t context,
+                                                   const uint16_t category,
+                                                   const size_t comps_count,
+                                                   const nn_vector_comp_t data_vector[],
+                                                   const uint16_t ncount)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const size_t neurons_count       = (ncount == 0xFFFFu) ? mirror->neurons_count : ncount;
+
+  if ((neurons_count < mirror->neurons_count) || (neurons_count > _hybrid->neurons_max))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NEURONS_COUNT;
+    goto ret_result;
+  }
+
+  if (ntpcie_atomic_u32_load(&mirror->refs, NTPCIE_MEMORY_ORDER_ACQUIRE) != 1)
+  {
+    struct hybrid_mirror_t* const mirror_copy = hybrid_mirror_alloc(_hybrid);
+    if (mirror_copy == NULL)
+    {
+      nn_result = NTPCIE_ERROR_UNKNOWN;
+      goto ret_result;
+    }
+
+    mirror_copy->neurons_count = mirror->neurons_count;
+    memcpy(mirror_copy->neurons, mirror->neurons, mirror->neurons_count * sizeof(mirror->neurons[0]));
+    hybrid_mirror_release(mirror);
+    mirror = mirror_copy;
+  }
+
+  const size_t fired_count = ntpcie_cpu_vector_fire(mirror->neurons, mirror->neurons_count, dist_eval, context,
+                                                    comps_count, data_vector, _hybrid->fired_ix);
+  for (size_t ix = 0; ix < fired_count; ++ix)
+  {
+    const size_t ix_neuron = _hybrid->fired_ix[ix];
+    if ((mirror->neurons[ix_neuron].category & 0x7FFFu) != category)
+    {
+      nn_result = ntpcie_nn_neuron_read(_hybrid->dev_handle, (uint16_t)ix_neuron, &mirror->neurons[ix_neuron]);
+      if (nn_result != NTPCIE_ERROR_SUCCESS)
+      {
+        goto ret_result;
+      }
+    }
+  }
+
+  for (size_t ix_neuron = mirror->neurons_count; ix_neuron < neurons_count; ++ix_neuron)
+  {
+    nn_result = ntpcie_nn_neuron_read(_hybrid->dev_handle, (uint16_t)ix_neuron, &mirror->neurons[ix_neuron]);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+  }
+  mirror->neurons_count = neurons_count;
+
+ret_result:
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    hybrid_mirror_release(mirror);
+    mirror = NULL;
+  }
+  return mirror;
+}
+
+// old mirror is released (freed by last classify which still uses it)
+static void hybrid_mirror_replace(struct hybrid_t* const _hybrid, struct hybrid_mirror_t* const mirror)
+{
+  ntpcie_mutex_lock(&_hybrid->mirror_lock);
+  struct hybrid_mirror_t* const mirror_old = _hybrid->mirror;
+  _hybrid->mirror                          = mirror;
+  ntpcie_mutex_unlock(&_hybrid->mirror_lock);
+
+  if (mirror_old != NULL)
+  {
+    hybrid_mirror_release(mirror_old);
+  }
+}
+
+// reference of hybrid to mirror is passed to caller (classify doesn't get mirror until it is put back)
+static struct hybrid_mirror_t* hybrid_mirror_detach(struct hybrid_t* const _hybrid)
+{
+  ntpcie_mutex_lock(&_hybrid->mirror_lock);
+  struct hybrid_mirror_t* const mirror = _hybrid->mirror;
+  _hybrid->mirror                      = NULL;
+  ntpcie_mutex_unlock(&_hybrid->mirror_lock);
+
+  return mirror;
+}
+
+static struct hybrid_mirror_t* hybrid_mirror_acquire(struct hybrid_t* const _hybrid)
+{
+  ntpcie_mutex_lock(&_hybrid->mirror_lock);
+  struct hybrid_mirror_t* const mirror = _hybrid->mirror;
+  if (mirror != NULL)
+  {
+    ntpcie_atomic_u32_fetch_add(&mirror->refs, 1, NTPCIE_MEMORY_ORDER_RELAXED);
+  }
+  ntpcie_mutex_unlock(&_hybrid->mirror_lock);
+
+  return mirror;
+}
+
+static void hybrid_mirror_release(struct hybrid_mirror_t* const mirror)
+{
+  if (ntpcie_atomic_u32_fetch_sub(&mirror->refs, 1, NTPCIE_MEMORY_ORDER_ACQ_REL) == 1)
+  {
+    free(mirror);
+  }
+}
+
+// card is idle or service time is not measured yet: request goes to card
+static bool hybrid_card_is_late(struct hybrid_t* const _hybrid)
+{
+  const uint64_t inflight = ntpcie_atomic_u32_load(&_hybrid->card_inflight, NTPCIE_MEMORY_ORDER_RELAXED);
+  const uint64_t service  = ntpcie_atomic_u64_load(&_hybrid->card_service_ns, NTPCIE_MEMORY_ORDER_RELAXED);
+
+  return (service != 0) && ((inflight + 1) * service > _hybrid->budget_ns);
+}
+
@@ -16,6 +16,8 @@
 #include "ntia_api_ll.h"
 
 #include "ntapcie_int.h"
+#include "ntapcie_queue.h"
+#include "ntapcie_thread.h"
 
 #include "pcie/transport_pcie.h"
 
@@ -33,15 +35,189 @@ void nn_state_reset(struct nn_state_t* const _state)
   _state->vecs_count_total_class = 0;
 }
 
+// time of API call: call executed by IO thread of card was made when it was queued
+// (time_call_ns is taken by IO thread, wait in queue is part of latency of call)
+uint64_t ntpcie_call_time_ns(const struct nta_dev_handle_t* const dev_handle, const uint64_t time_call_ns)
+{
+  const struct ntpcie_dev_ctx_t* const dev_ctx = (const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+
+  const uint64_t time_submit_ns = ntpcie_queue_submit_time_take(dev_ctx->queue);
+  return (time_submit_ns != 0) ? time_submit_ns : time_call_ns;
+}
+
+// latency of operation since its API call (ntpcie_phase_start()) is added to statistics of card;
+// every record of batch is added separately: the next one is timed from end of previous
+void ntpcie_stats_add(const struct nta_dev_handle_t* const dev_handle, const enum nn_stats_oper_t oper)
+{
+  struct ntpcie_dev_ctx_t* const dev_ctx = (struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+
+  const uint64_t time_start_ns = dev_ctx->oper_time_ns;
+  dev_ctx->oper_time_ns        = ntpcie_clock_ns();
+  ntpcie_stats_latency_add(dev_handle, oper, time_start_ns);
+}
+
+// latency of operation (from time_start_ns until now) is added to statistics of card
+void ntpcie_stats_latency_add(const struct nta_dev_handle_t* const dev_handle,
+                              const enum nn_stats_oper_t oper,
+                              const uint64_t time_start_ns)
+{
+  struct ntpcie_dev_ctx_t* const dev_ctx = (struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+  struct nn_oper_stats_t* const stats    = &dev_ctx->stats.oper[oper];
+
+  const uint64_t time_ns = ntpcie_clock_ns() - time_start_ns;
+
+  // bucket is log2 of latency
+  size_t ix_bucket = 0;
+  for (uint64_t rest = time_ns >> 1; (rest > 0) && (ix_bucket < NN_STATS_BUCKETS - 1); rest >>= 1)
+  {
+    ++ix_bucket;
+  }
+
+  ++stats->count;
+  ++stats->buckets[ix_bucket];
+  stats->time_total_ns += time_ns;
+  if (time_ns > stats->time_max_ns)
+  {
+    stats->time_max_ns = time_ns;
+  }
+}
+
+// phases of operation: operation is started when its arguments are validated (time since
+// API call is validation, wait in queue of card included), then every mark adds time since
+// previous mark to phase, so phases must be marked in order they are executed
+void ntpcie_phase_start(const struct nta_dev_handle_t* const dev_handle,
+                        const enum nn_stats_oper_t oper,
+                        const uint64_t time_call_ns)
+{
+  struct ntpcie_dev_ctx_t* const dev_ctx = (struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+
+  const uint64_t time_ns = ntpcie_call_time_ns(dev_handle, time_call_ns);
+
+  dev_ctx->phase_oper    = oper;
+  dev_ctx->phase_time_ns = time_ns;
+  dev_ctx->oper_time_ns  = time_ns;
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_VALIDATE);
+}
+
+// time of mark is returned
+uint64_t ntpcie_phase_mark(const struct nta_dev_handle_t* const dev_handle, const enum nn_stats_phase_t phase)
+{
+  struct ntpcie_dev_ctx_t* const dev_ctx = (struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+
+  const uint64_t time_ns = ntpcie_clock_ns();
+  dev_ctx->stats.oper[dev_ctx->phase_oper].phase_total_ns[phase] += time_ns - dev_ctx->phase_time_ns;
+  dev_ctx->phase_time_ns = time_ns;
+  return time_ns;
+}
+
+// merge lists of responses (every list is sorted by distance, as returned by card) into
+// one list of out_max closest responses; equal distances are ordered by index of list;
+// out_lists_ix[] (may be NULL) gets index of source list for every response
+size_t nn_resp_merge(const struct response_neuron_state_t* const lists[],
+                     const size_t counts[],
+                     const size_t lists_count,
+                     struct response_neuron_state_t out[],
+                     size_t out_lists_ix[],
+                     const size_t out_max)
+{
+  size_t heads[NTIA_PCIE_MAX_CARDS] = { 0 };
+  size_t out_count                  = 0;
+
+  if (lists_count > NTIA_PCIE_MAX_CARDS)
+  {
+    return 0;
+  }
+
+  for (; out_count < out_max; ++out_count)
+  {
+    size_t ix_best         = lists_count;
+    uint32_t distance_best = 0x10000ul;
+
+    for (size_t ix = 0; ix < lists_count; ++ix)
+    {
+      if (heads[ix] < counts[ix] && lists[ix][heads[ix]].distance < distance_best)
+      {
+        ix_best       = ix;
+        distance_best = lists[ix][heads[ix]].distance;
+      }
+    }
+
+    if (ix_best == lists_count)
+    {
+      // all lists are exhausted
+      break;
+    }
+
+    out[out_count] = lists[ix_best][heads[ix_best]];
+    if (out_lists_ix != NULL)
+    {
+      out_lists_ix[out_count] = ix_best;
+    }
+    ++heads[ix_best];
+  }
+
+  return out_count;
+}
+
+// smoothed service time of card (used by routing of pool and hybrid, 0 - not measured yet);
+// elapsed time of request includes service of requests queued before it (card executes them one by one);
+// lossy update by concurrent threads is acceptable: value is used only as hint for routing
+void ntpcie_service_update(ntpcie_atomic_u64_t* const service_ns, const uint64_t elapsed_ns, const unsigned queued)
+{
+  const uint64_t sample  = elapsed_ns / ((uint64_t)queued + 1);
+  const uint64_t service = ntpcie_atomic_u64_load(service_ns, NTPCIE_MEMORY_ORDER_RELAXED);
+
+  if (service == 0)
+  {
+    ntpcie_atomic_u64_store(service_ns, (sample != 0) ? sample : 1, NTPCIE_MEMORY_ORDER_RELAXED);
+  }
+  else
+  {
+    const int64_t delta = (int64_t)(sample - service) / (1 << NTPCIE_SERVICE_EWMA_SHIFT);
+    ntpcie_atomic_u64_store(service_ns, (uint64_t)((int64_t)service + delta), NTPCIE_MEMORY_ORDER_RELAXED);
+  }
+}
+
+// deadline of wait for card: timeout of handle from now, but not later than deadline of handle
+uint64_t ntpcie_card_deadline_ns(const struct nta_dev_handle_t* const dev_handle)
+{
+  const struct ntpcie_dev_ctx_t* const dev_ctx = (const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+
+  const uint64_t timeout_ns  = (dev_ctx->timeout_ns > 0) ? dev_ctx->timeout_ns : NTPCIE_TIMEOUT_STD_NS;
+  const uint64_t deadline_ns = ntpcie_clock_ns() + timeout_ns;
+
+  if ((dev_ctx->deadline_ns > 0) && (dev_ctx->deadline_ns < deadline_ns))
+  {
+    return dev_ctx->deadline_ns;
+  }
+  return deadline_ns;
+}
+
+// condition of wait loop: status of card is read at least once (deadline may be over already)
+bool ntpcie_card_wait_goes_on(const size_t cnt, const uint64_t deadline_ns)
+{
+  return (cnt == 0) || (ntpcie_clock_ns() < deadline_ns);
+}
+
 enum ntpcie_nn_error_t ntpcie_card_wait_ready(const struct nta_dev_handle_t* const dev_handle,
-                                              size_t wait_cycles,
+                                              const uint64_t deadline_ns,
                                               union pcie_card_status_t* const _status)
 {
   enum ntpcie_io_error_t io_result;
   enum ntpcie_nn_error_t nn_result;
   union pcie_card_status_t dev_status;
 
-  for (; wait_cycles > 0; --wait_cycles)
+  dev_status.data = 0;
+
+  // card belongs to asynchronous requests until all of them are polled
+  const struct ntpcie_dev_ctx_t* const dev_ctx = (const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+  if (dev_ctx->async.count > 0)
+  {
+    nn_result = NTPCIE_ERROR_BUSY;
+    goto ret_result;
+  }
+
+  for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
   {
     io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
     if (io_result != NTPCIE_IO_ERROR_SUCCESS)
@@ -59,6 +235,13 @@ enum ntpcie_nn_error_t ntpcie_card_wait_ready(const struct nta_dev_handle_t* con
       nn_result = NTPCIE_ERROR_SUCCESS;
       goto ret_result;
     }
+
+    // card is busy with previous pack: block until card event (if transport supports it)
+    nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
   }
 
   nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
@@ -74,14 +257,14 @@ ret_result:
 }
 
 enum ntpcie_nn_error_t ntpcie_card_wait_ready_data(const struct nta_dev_handle_t* const dev_handle,
-                                                   size_t wait_cycles,
+                                                   const uint64_t deadline_ns,
                                                    union pcie_card_status_t* const _status)
 {
   enum ntpcie_io_error_t io_result;
   enum ntpcie_nn_error_t nn_result;
   union pcie_card_status_t dev_status;
 
-  for (; wait_cycles > 0; --wait_cycles)
+  for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
   {
     io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
     if (io_result != NTPCIE_IO_ERROR_SUCCESS)
@@ -99,6 +282,12 @@ enum ntpcie_nn_error_t ntpcie_card_wait_ready_data(const struct nta_dev_handle_t
       nn_result = NTPCIE_ERROR_SUCCESS;
       goto ret_result;
     }
+
+    nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
   }
 
   nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
@@ -113,6 +302,30 @@ ret_result:
   return nn_result;
 }
 
+enum ntpcie_nn_error_t ntpcie_card_wait_event(const struct nta_dev_handle_t* const dev_handle,
+                                              const uint64_t deadline_ns)
+{
+  enum ntpcie_io_error_t io_result;
+
+  // event isn't waited longer than deadline of wait
+  const uint64_t now_ns = ntpcie_clock_ns();
+  if (now_ns >= deadline_ns)
+  {
+    return NTPCIE_ERROR_SUCCESS;
+  }
+
+  const uint64_t left_us = (deadline_ns - now_ns) / 1000u;
+  const uint32_t wait_us = (left_us < NTPCIE_WAIT_EVENT_TIMEOUT_US) ? (uint32_t)left_us : NTPCIE_WAIT_EVENT_TIMEOUT_US;
+
+  // returns immediately for transports without events (status polling)
+  io_result = ntia_pcie_io_device_wait_event(dev_handle->_iox_handle, wait_us);
+  if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+  {
+    return NTPCIE_ERROR_SERV_READ;
+  }
+  return NTPCIE_ERROR_SUCCESS;
+}
+
 enum ntpcie_nn_error_t ntpcie_card_reset(struct nta_dev_handle_t* const dev_handle)
 {
   enum ntpcie_io_error_t io_result;
@@ -127,9 +340,12 @@ enum ntpcie_nn_error_t ntpcie_card_reset(struct nta_dev_handle_t* const dev_hand
   io_result = ntia_pcie_io_device_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_RESET, 0xDEADBEEFul);
   if (io_result == NTPCIE_IO_ERROR_SUCCESS)
   {
+    // reset (with self test of NN) is longer than any other operation of card
+    const uint64_t deadline_ns = ntpcie_clock_ns() + NTPCIE_TIMEOUT_EXT_NS;
+
     // HACK: wait for TESTCAT is 2*ready
-    nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
-    nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
+    nn_result = ntpcie_card_wait_ready(dev_handle, deadline_ns, NULL);
+    nn_result = ntpcie_card_wait_ready(dev_handle, deadline_ns, NULL);
     if (nn_result == NTPCIE_ERROR_SUCCESS)
     {
       uint32_t data = 0;
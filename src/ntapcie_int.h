@@ -19,10 +19,62 @@
 
 #include "crc32.h"
 
+#include "ntapcie_thread.h"
+
+#include "pcie/transport_pcie.h"
+
 #ifdef __amd64__
 #include <x86intrin.h>
 #endif // __amd64__
 
+// max time of single wait for card event (interrupt), status is re-read after it
+#define NTPCIE_WAIT_EVENT_TIMEOUT_US (1000u)
+
+// smoothing of service time of card: new = old + (sample - old) / 2^NTPCIE_SERVICE_EWMA_SHIFT
+#define NTPCIE_SERVICE_EWMA_SHIFT (3u)
+
+// asynchronous classify request: pack is kept until it is uploaded to card
+struct ntpcie_async_req_t
+{
+  struct pcie_data_xpack_t         tx_data;
+  uint32_t                         pack_size_bytes;
+  uint32_t                         token;
+  enum ntpcie_nn_error_t           result;              ///< error of upload (request is completed by next poll)
+  size_t                           number_of_responses;
+  struct response_neuron_state_t*  resp;                ///< buffer of application
+  uint64_t                         cpu_ticks_start;     ///< tick count at upload
+  uint64_t                         time_start_ns;       ///< time of submit call (latency of request starts here)
+  uint64_t                         deadline_ns;         ///< results must be ready by this time (set at upload)
+};
+
+// ring of asynchronous requests: first one (head) is executed by card, others wait for upload
+struct ntpcie_async_ring_t
+{
+  struct ntpcie_async_req_t reqs[NTPCIE_ASYNC_DEPTH];
+  size_t                    head;
+  size_t                    count;
+  uint32_t                  token_last;
+};
+
+struct ntpcie_dev_queue_t;
+struct ntpcie_cache_t;
+
+// per device handle state of library, every ntpcie_sys_init() allocates own context,
+// so handles are independent and several cards may be used by process concurrently
+struct ntpcie_dev_ctx_t
+{
+  struct pcie_io_handle_t    io_handle;     ///< must be first: nta_dev_handle_t::_iox_handle is used as IO handle
+  struct ntpcie_dev_queue_t* queue;         ///< submission queue and IO thread of card (NULL - not started)
+  struct ntpcie_async_ring_t async;         ///< requests of ntpcie_submit_...() not polled yet
+  struct ntpcie_cache_t*     cache;         ///< results of classify (NULL - not started)
+  uint64_t                   timeout_ns;    ///< max time of single wait for card (0 - NTPCIE_TIMEOUT_STD_NS)
+  uint64_t                   deadline_ns;   ///< all waits end by this time of ntpcie_clock_ns() (0 - none)
+  struct nn_stats_t          stats;         ///< latency histograms of card operations
+  enum nn_stats_oper_t       phase_oper;    ///< operation which phases are timed now
+  uint64_t                   phase_time_ns; ///< end of previous phase of operation (ntpcie_clock_ns())
+  uint64_t                   oper_time_ns;  ///< start of latency of operation (API call, see ntpcie_stats_add())
+};
+
 #if defined(__GNUC__) || defined(__CLANG__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -100,13 +152,44 @@ extern "C"
 #endif // __cplusplus
 
 enum ntpcie_nn_error_t ntpcie_card_reset(struct nta_dev_handle_t* const dev_handle);
+uint64_t ntpcie_card_deadline_ns(const struct nta_dev_handle_t* const dev_handle);
+bool ntpcie_card_wait_goes_on(const size_t cnt, const uint64_t deadline_ns);
 enum ntpcie_nn_error_t ntpcie_card_wait_ready(const struct nta_dev_handle_t* const dev_handle,
-                                              size_t wait_cycles,
+                                              const uint64_t deadline_ns,
                                               union pcie_card_status_t* const _status);
 enum ntpcie_nn_error_t ntpcie_card_wait_ready_data(const struct nta_dev_handle_t* const dev_handle,
-                                                   size_t wait_cycles,
+                                                   const uint64_t deadline_ns,
                                                    union pcie_card_status_t* const _status);
+enum ntpcie_nn_error_t ntpcie_card_wait_event(const struct nta_dev_handle_t* const dev_handle,
+                                              const uint64_t deadline_ns);
+enum ntpcie_nn_error_t ntpcie_async_pending(struct nta_dev_handle_t* const dev_handle, size_t* const count);
+enum ntpcie_nn_error_t ntpcie_async_wait_event(struct nta_dev_handle_t* const dev_handle);
+enum ntpcie_nn_error_t ntpcie_kbase_id_get(struct nta_dev_handle_t* const dev_handle, uint64_t* const kbase_id);
+enum ntpcie_nn_error_t ntpcie_kbase_id_set(struct nta_dev_handle_t* const dev_handle, const uint64_t kbase_id);
 void nn_state_reset(struct nn_state_t* const _state);
+uint64_t ntpcie_call_time_ns(const struct nta_dev_handle_t* const dev_handle, const uint64_t time_call_ns);
+void ntpcie_stats_add(const struct nta_dev_handle_t* const dev_handle, const enum nn_stats_oper_t oper);
+void ntpcie_stats_latency_add(const struct nta_dev_handle_t* const dev_handle,
+                              const enum nn_stats_oper_t oper,
+                              const uint64_t time_start_ns);
+void ntpcie_phase_start(const struct nta_dev_handle_t* const dev_handle,
+                        const enum nn_stats_oper_t oper,
+                        const uint64_t time_call_ns);
+uint64_t ntpcie_phase_mark(const struct nta_dev_handle_t* const dev_handle, const enum nn_stats_phase_t phase);
+void ntpcie_service_update(ntpcie_atomic_u64_t* const service_ns, const uint64_t elapsed_ns, const unsigned queued);
+size_t ntpcie_cpu_vector_fire(const struct nn_neuron_t neurons[],
+                              const size_t neurons_count,
+                              const enum nn_dist_eval_t dist_eval,
+                              const uint16_t context,
+                              const size_t comps_count,
+                              const nn_vector_comp_t data_vector[],
+                              size_t fired_ix[]);
+size_t nn_resp_merge(const struct response_neuron_state_t* const lists[],
+                     const size_t counts[],
+                     const size_t lists_count,
+                     struct response_neuron_state_t out[],
+                     size_t out_lists_ix[],
+                     const size_t out_max);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include "ntia_api_data_types.h"
+#include "ntia_api.h"
+#include "ntia_api_data_types_ll.h"
+#include "ntia_api_ll.h"
+
+#include "ntapcie_int.h"
+
+// knowledge base file: header, neuron records in layout of card (nn_neuron_t), CRCs of chunks;
+// file is mapped to memory, card reads/writes neuron records directly in mapping (no copies);
+// file is saved to "<path>.tmp" and renamed over destination when it is complete and flushed
+// (old file stays intact if save fails)
+
+#define KBFILE_TMP_SUFFIX ".tmp"
+
+// file mapped to memory
+struct kbfile_map_t
+{
+  uint8_t* data;
+  size_t   size;
+#if defined(_WIN32)
+  HANDLE   _file;
+  HANDLE   _mapping;
+#else
+  int      _fd;
+#endif // _WIN32
+};
+
+/// internal functions
+static bool kbfile_map_read(const char* const path, struct kbfile_map_t* const map);
+static bool kbfile_map_create(const char* const path, const size_t size, struct kbfile_map_t* const map);
+static bool kbfile_map_flush(struct kbfile_map_t* const map);
+static void kbfile_unmap(struct kbfile_map_t* const map);
+static bool kbfile_replace(const char* const path_tmp, const char* const path);
+static size_t kbfile_size_calc(const size_t neurons_count, const size_t chunks_count);
+static size_t kbfile_chunks_count_calc(const size_t neurons_count);
+static uint32_t kbfile_header_crc32_calc(const struct nta_kbase_file_header_t* const header);
+static enum ntpcie_nn_error_t kbfile_header_check(const struct nta_kbase_file_header_t* const header, const size_t file_size);
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_save_file(struct nta_dev_handle_t* const dev_handle,
+                                                       const size_t comps_count,
+                                                       const char* const path)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  size_t neurons_count             = 0;
+  char* path_tmp                   = NULL;
+  bool file_created                = false;
+
+  struct kbfile_map_t map;
+
+  memset(&map, 0, sizeof(map));
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (path == NULL)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((comps_count < 1) || (comps_count > NN_NEURON_COMPONENTS))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
+    goto ret_result;
+  }
+
+  // size query: committed neurons count is returned
+  nn_result = ntpcie_kbase_store_all(dev_handle, NULL, 0, &neurons_count);
+  if (nn_result != NTPCIE_ERROR_SUCCESS && nn_result != NTPCIE_ERROR_ARGS_NEURONS_COUNT)
+  {
+    goto ret_result;
+  }
+
+  const size_t chunks_count = kbfile_chunks_count_calc(neurons_count);
+
+  path_tmp = (char*)malloc(strlen(path) + sizeof(KBFILE_TMP_SUFFIX));
+  if (path_tmp == NULL)
+  {
+    nn_result = NTPCIE_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+  strcpy(path_tmp, path);
+  strcat(path_tmp, KBFILE_TMP_SUFFIX);
+
+  if (kbfile_map_create(path_tmp, kbfile_size_calc(neurons_count, chunks_count), &map) != true)
+  {
+    nn_result = NTPCIE_ERROR_KBASE_FILE_IO;
+    goto ret_result;
+  }
+  file_created = true;
+
+  struct nta_kbase_file_header_t* const header = (struct nta_kbase_file_header_t*)map.data;
+  struct nn_neuron_t* const neurons            = (struct nn_neuron_t*)(map.data + sizeof(*header));
+  uint32_t* const chunks_crc32                 = (uint32_t*)(map.data + kbfile_size_calc(neurons_count, 0));
+
+  size_t neurons_stored = 0;
+
+  // ATT: KB must not be changed by other threads of application while it is saved
+  nn_result = ntpcie_kbase_store_all(dev_handle, neurons, neurons_count, &neurons_stored);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+  else if (neurons_stored != neurons_count)
+  {
+    nn_result = NTPCIE_ERROR_KBASE_EOF;
+    goto ret_result;
+  }
+
+  memset(header, 0, sizeof(*header));
+
+  nn_result = ntpcie_kbase_id_get(dev_handle, &header->kbase_id);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  for (size_t ix = 0; ix < neurons_count; ++ix)
+  {
+    const uint8_t context = neurons[ix].ncr & 0x7Fu;
+    header->contexts[context >> 3] |= (uint8_t)(1u << (context & 0x07u));
+  }
+
+  for (size_t ix_chunk = 0; ix_chunk < chunks_count; ++ix_chunk)
+  {
+    const size_t ix_first = ix_chunk * NTA_KBASE_FILE_CHUNK;
+    const size_t count    = (neurons_count - ix_first > NTA_KBASE_FILE_CHUNK) ? NTA_KBASE_FILE_CHUNK : (neurons_count - ix_first);
+    chunks_crc32[ix_chunk] = crc32_mem_value(&neurons[ix_first], count * sizeof(neurons[0]));
+  }
+
+  header->magic           = NTA_KBASE_FILE_MAGIC;
+  header->version         = NTA_KBASE_FILE_VERSION;
+  header->header_size     = sizeof(*header);
+  header->record_size     = sizeof(struct nn_neuron_t);
+  header->neurons_count   = (uint32_t)neurons_count;
+  header->neurons_overall = (uint32_t)dev_handle->nn_state.neurons_overall;
+  header->comps_count     = (uint16_t)comps_count;
+  header->chunk_neurons   = NTA_KBASE_FILE_CHUNK;
+  header->chunks_count    = (uint32_t)chunks_count;
+  header->header_crc32    = kbfile_header_crc32_calc(header);
+
+  // file is on disk before it replaces old one: crash leaves either old or new KB
+  if (kbfile_map_flush(&map) != true)
+  {
+    nn_result = NTPCIE_ERROR_KBASE_FILE_IO;
+    goto ret_result;
+  }
+  kbfile_unmap(&map);
+
+  if (kbfile_replace(path_tmp, path) != true)
+  {
+    nn_result = NTPCIE_ERROR_KBASE_FILE_IO;
+    goto ret_result;
+  }
+
+ret_result:
+  kbfile_unmap(&map);
+  if (nn_result != NTPCIE_ERROR_SUCCESS && file_created == true)
+  {
+    // incomplete file must not be taken for valid KB (destination isn't touched)
+    remove(path_tmp);
+  }
+  free(path_tmp);
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_load_file(struct nta_dev_handle_t* const dev_handle,
+                                                       const char* const path)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  struct kbfile_map_t map;
+
+  memset(&map, 0, sizeof(map));
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (path == NULL)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  if (kbfile_map_read(path, &map) != true)
+  {
+    nn_result = NTPCIE_ERROR_KBASE_FILE_IO;
+    goto ret_result;
+  }
+
+  const struct nta_kbase_file_header_t* const header = (const struct nta_kbase_file_header_t*)map.data;
+
+  nn_result = kbfile_header_check(header, map.size);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+  else if (header->neurons_count > dev_handle->nn_state.neurons_overall)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NEURONS_COUNT;
+    goto ret_result;
+  }
+
+  const struct nn_neuron_t* const neurons = (const struct nn_neuron_t*)(map.data + header->header_size);
+  const uint32_t* const chunks_crc32      = (const uint32_t*)((const uint8_t*)neurons + (size_t)header->neurons_count * header->record_size);
+
+  // whole file is checked before NN is touched: KB of card isn't replaced by damaged one
+  for (size_t ix_chunk = 0; ix_chunk < header->chunks_count; ++ix_chunk)
+  {
+    const size_t ix_first = ix_chunk * header->chunk_neurons;
+    const size_t count    = (header->neurons_count - ix_first > header->chunk_neurons) ? header->chunk_neurons : (header->neurons_count - ix_first);
+    if (chunks_crc32[ix_chunk] != crc32_mem_value(&neurons[ix_first], count * sizeof(neurons[0])))
+    {
+      nn_result = NTPCIE_ERROR_KBASE_FILE_FORMAT;
+      goto ret_result;
+    }
+  }
+
+  nn_result = ntpcie_kbase_load_all(dev_handle, header->comps_count, neurons, header->neurons_count, NULL);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  nn_result = ntpcie_kbase_id_set(dev_handle, header->kbase_id);
+
+ret_result:
+  kbfile_unmap(&map);
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_file_read(const char* const path,
+                                                       struct nn_neuron_t neurons[],
+                                                       const size_t neurons_max,
+                                                       size_t* const neurons_count,
+                                                       size_t* const comps_count)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  struct kbfile_map_t map;
+
+  memset(&map, 0, sizeof(map));
+
+  if ((path == NULL) || (neurons_count == NULL) || (neurons == NULL && neurons_max > 0))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  *neurons_count = 0;
+
+  if (kbfile_map_read(path, &map) != true)
+  {
+    nn_result = NTPCIE_ERROR_KBASE_FILE_IO;
+    goto ret_result;
+  }
+
+  const struct nta_kbase_file_header_t* const header = (const struct nta_kbase_file_header_t*)map.data;
+
+  nn_result = kbfile_header_check(header, map.size);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+  else if (header->neurons_count > neurons_max)
+  {
+    // ATT: required size of array is returned
+    *neurons_count = header->neurons_count;
+    nn_result      = NTPCIE_ERROR_ARGS_NEURONS_COUNT;
+    goto ret_result;
+  }
+
+  const struct nn_neuron_t* const records = (const struct nn_neuron_t*)(map.data + header->header_size);
+  const uint32_t* const chunks_crc32      = (const uint32_t*)((const uint8_t*)records + (size_t)header->neurons_count * header->record_size);
+
+  // chunk is checked in array of application (it is in cache after copy)
+  for (size_t ix_chunk = 0; ix_chunk < header->chunks_count; ++ix_chunk)
+  {
+    const size_t ix_first = ix_chunk * header->chunk_neurons;
+    const size_t count    = (header->neurons_count - ix_first > header->chunk_neurons) ? header->chunk_neurons : (header->neurons_count - ix_first);
+
+    memcpy(&neurons[ix_first], &records[ix_first], count * sizeof(neurons[0]));
+    if (chunks_crc32[ix_chunk] != crc32_mem_value(&neurons[ix_first], count * sizeof(neurons[0])))
+    {
+      nn_result = NTPCIE_ERROR_KBASE_FILE_FORMAT;
+      goto ret_result;
+    }
+  }
+
+  *neurons_count = header->neurons_count;
+  if (comps_count != NULL)
+  {
+    *comps_count = header->comps_count;
+  }
+
+ret_result:
+  kbfile_unmap(&map);
+  return nn_result;
+}
+
+/// internal functions
+
+#if defined(_WIN32)
+
+static bool kbfile_map_read(const char* const path, struct kbfile_map_t* const map)
+{
+  LARGE_INTEGER file_size;
+
+  map->_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (map->_file == INVALID_HANDLE_VALUE)
+  {
+    map->_file = NULL;
+    return false;
+  }
+  else if (GetFileSizeEx(map->_file, &file_size) != TRUE || file_size.QuadPart < (LONGLONG)sizeof(struct nta_kbase_file_header_t))
+  {
+    return false;
+  }
+
+  map->_mapping = CreateFileMappingA(map->_file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (map->_mapping == NULL)
+  {
+    return false;
+  }
+
+  map->data = (uint8_t*)MapViewOfFile(map->_mapping, FILE_MAP_READ, 0, 0, 0);
+  map->size = (size_t)file_size.QuadPart;
+  return (map->data != NULL);
+}
+
+static bool kbfile_map_create(const char* const path, const size_t size, struct kbfile_map_t* const map)
+{
+  map->_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (map->_file == INVALID_HANDLE_VALUE)
+  {
+    map->_file = NULL;
+    return false;
+  }
+
+  // file is extended to size of mapping
+  map->_mapping = CreateFileMappingA(map->_file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+  if (map->_mapping == NULL)
+  {
+    return false;
+  }
+
+  map->data = (uint8_t*)MapViewOfFile(map->_mapping, FILE_MAP_WRITE, 0, 0, size);
+  map->size = size;
+  return (map->data != NULL);
+}
+
+static bool kbfile_map_flush(struct kbfile_map_t* const map)
+{
+  return (FlushViewOfFile(map->data, map->size) == TRUE) && (FlushFileBuffers(map->_file) == TRUE);
+}
+
+static void kbfile_unmap(struct kbfile_map_t* const map)
+{
+  if (map->data != NULL)
+  {
+    UnmapViewOfFile(map->data);
+  }
+  if (map->_mapping != NULL)
+  {
+    CloseHandle(map->_mapping);
+  }
+  if (map->_file != NULL)
+  {
+    CloseHandle(map->_file);
+  }
+  memset(map, 0, sizeof(*map));
+}
+
+static bool kbfile_replace(const char* const path_tmp, const char* const path)
+{
+  return (MoveFileExA(path_tmp, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == TRUE);
+}
+
+#else
+
+static bool kbfile_map_read(const char* const path, struct kbfile_map_t* const map)
+{
+  struct stat file_stat;
+
+  map->_fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (map->_fd < 0)
+  {
+    return false;
+  }
+  else if (fstat(map->_fd, &file_stat) != 0 || file_stat.st_size < (off_t)sizeof(struct nta_kbase_file_header_t))
+  {
+    return false;
+  }
+
+  void* const data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, map->_fd, 0);
+  if (data == MAP_FAILED)
+  {
+    return false;
+  }
+
+  // records are read once from first to last
+  madvise(data, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+
+  map->data = (uint8_t*)data;
+  map->size = (size_t)file_stat.st_size;
+  return true;
+}
+
+static bool kbfile_map_create(const char* const path, const size_t size, struct kbfile_map_t* const map)
+{
+  map->_fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (map->_fd < 0)
+  {
+    return false;
+  }
+  else if (ftruncate(map->_fd, (off_t)size) != 0)
+  {
+    return false;
+  }
+
+  void* const data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, map->_fd, 0);
+  if (data == MAP_FAILED)
+  {
+    return false;
+  }
+
+  map->data = (uint8_t*)data;
+  map->size = size;
+  return true;
+}
+
+static bool kbfile_map_flush(struct kbfile_map_t* const map)
+{
+  return (msync(map->data, map->size, MS_SYNC) == 0) && (fsync(map->_fd) == 0);
+}
+
+static void kbfile_unmap(struct kbfile_map_t* const map)
+{
+  if (map->data != NULL)
+  {
+    munmap(map->data, map->size);
+  }
+  // ATT: descriptor 0 is never owned by map (memset by caller)
+  if (map->_fd > 0)
+  {
+    close(map->_fd);
+  }
+  memset(map, 0, sizeof(*map));
+}
+
+// rename is atomic: readers see either old or new file
+static bool kbfile_replace(const char* const path_tmp, const char* const path)
+{
+  return (rename(path_tmp, path) == 0);
+}
+
+#endif // _WIN32
+
+static size_t kbfile_size_calc(const size_t neurons_count, const size_t chunks_count)
+{
+  return sizeof(struct nta_kbase_file_header_t)
+         + neurons_count * sizeof(struct nn_neuron_t)
+         + chunks_count * sizeof(uint32_t);
+}
+
+static size_t kbfile_chunks_count_calc(const size_t neurons_count)
+{
+  return (neurons_count + NTA_KBASE_FILE_CHUNK - 1) / NTA_KBASE_FILE_CHUNK;
+}
+
+static uint32_t kbfile_header_crc32_calc(const struct nta_kbase_file_header_t* const header)
+{
+  return crc32_mem_value(header, offsetof(struct nta_kbase_file_header_t, header_crc32));
+}
+
+static enum ntpcie_nn_error_t kbfile_header_check(const struct nta_kbase_file_header_t* const header, const size_t file_size)
+{
+  if ((header->magic != NTA_KBASE_FILE_MAGIC) ||
+      (header->version != NTA_KBASE_FILE_VERSION) ||
+      (header->header_crc32 != kbfile_header_crc32_calc(header)))
+  {
+    return NTPCIE_ERROR_KBASE_FILE_FORMAT;
+  }
+  else if ((header->header_size != sizeof(*header)) ||
+           (header->record_size != sizeof(struct nn_neuron_t)) ||
+           (header->comps_count < 1) || (header->comps_count > NN_NEURON_COMPONENTS) ||
+           (header->chunk_neurons < 1) ||
+           (header->chunks_count != (header->neurons_count + header->chunk_neurons - 1) / header->chunk_neurons))
+  {
+    return NTPCIE_ERROR_KBASE_FILE_FORMAT;
+  }
+  else if (file_size < kbfile_size_calc(header->neurons_count, header->chunks_count))
+  {
+    // file is truncated
+    return NTPCIE_ERROR_KBASE_FILE_FORMAT;
+  }
+
+  return NTPCIE_ERROR_SUCCESS;
+}
@@ -20,15 +20,271 @@
 #include "ntia_api_data_types_ll.h"
 #include "ntia_api_ll.h"
 
+#include "ntapcie_cache.h"
 #include "ntapcie_int.h"
+#include "ntapcie_queue.h"
 
 #include "pcie/transport_pcie.h"
 
-static struct pcie_io_handle_t _loc_io_handle;
+// arguments of API calls passed to IO thread of card
+struct req_device_cache_start_t
+{
+  size_t entries_count;
+};
+
+struct req_device_time_set_t
+{
+  uint64_t time_ns;
+};
+
+struct req_stats_get_t
+{
+  struct nn_stats_t* stats;
+};
+
+struct req_register_read_t
+{
+  enum nn_int_register_t reg_address;
+  uint16_t*              reg_value;
+};
+
+struct req_register_write_t
+{
+  enum nn_int_register_t reg_address;
+  uint16_t               reg_value;
+};
+
+struct req_vector_learn_t
+{
+  enum nn_dist_eval_t       dist_eval;
+  uint16_t                  context;
+  uint16_t                  category;
+  uint16_t                  maxif;
+  uint16_t                  minif;
+  size_t                    comps_count;
+  const nn_vector_comp_t*   data_vector;
+  struct nn_learn_result_t* result;
+};
+
+struct req_vectors_learn_batch_t
+{
+  enum nn_dist_eval_t             dist_eval;
+  uint16_t                        maxif;
+  uint16_t                        minif;
+  size_t                          comps_count;
+  size_t                          records_count;
+  const struct nn_learn_record_t* records;
+  struct nn_learn_result_t*       results;
+  size_t*                         records_done;
+};
+
+struct req_vector_classify_t
+{
+  enum nn_dist_eval_t             dist_eval;
+  uint16_t                        context;
+  enum nn_classifier_t            classifier;
+  size_t                          comps_count;
+  const nn_vector_comp_t*         data_vector;
+  size_t*                         number_of_responses;
+  struct response_neuron_state_t* resp;
+  struct nn_classify_status_t*    status;
+};
+
+struct req_vector_classify_adaptive_t
+{
+  enum nn_dist_eval_t             dist_eval;
+  uint16_t                        context;
+  enum nn_classifier_t            classifier;
+  size_t                          comps_count;
+  const nn_vector_comp_t*         data_vector;
+  size_t                          answers_first;
+  size_t*                         number_of_responses;
+  struct response_neuron_state_t* resp;
+  struct nn_classify_status_t*    status;
+};
+
+struct req_submit_classify_t
+{
+  enum nn_dist_eval_t              dist_eval;
+  uint16_t                         context;
+  enum nn_classifier_t             classifier;
+  size_t                           comps_count;
+  const nn_vector_comp_t*          data_vector;
+  size_t                           number_of_responses;
+  struct response_neuron_state_t*  resp;
+  uint32_t*                        token;
+};
+
+struct req_poll_completions_t
+{
+  struct nta_completion_t* completions;
+  size_t                   completions_max;
+  size_t*                  completions_count;
+};
+
+struct req_async_pending_t
+{
+  size_t* count;
+};
+
+struct req_vectors_classify_batch_t
+{
+  enum nn_dist_eval_t             dist_eval;
+  uint16_t                        context;
+  enum nn_classifier_t            classifier;
+  size_t                          comps_count;
+  size_t                          vectors_count;
+  const nn_vector_comp_t*         data_vectors;
+  size_t                          vectors_stride;
+  const nn_vector_comp_t* const*  vectors;
+  size_t                          number_of_responses;
+  size_t*                         responses_count;
+  struct response_neuron_state_t* resp;
+  size_t*                         vectors_done;
+};
+
+struct req_neuron_read_t
+{
+  uint16_t            ix_neuron;
+  struct nn_neuron_t* _neuron;
+};
+
+struct req_kbase_store_t
+{
+  struct nn_neuron_t* _neuron;
+};
+
+struct req_kbase_load_t
+{
+  size_t                    comps_count;
+  const struct nn_neuron_t* _neuron;
+};
+
+struct req_kbase_store_all_t
+{
+  struct nn_neuron_t* neurons;
+  size_t              neurons_max;
+  size_t*             neurons_count;
+};
+
+struct req_kbase_load_all_t
+{
+  size_t                    comps_count;
+  const struct nn_neuron_t* neurons;
+  size_t                    neurons_count;
+  size_t*                   neurons_done;
+};
+
+struct req_kbase_id_get_t
+{
+  uint64_t* kbase_id;
+};
+
+struct req_kbase_id_set_t
+{
+  uint64_t kbase_id;
+};
+
+/// internal functions
+static bool dev_call_is_queued(const struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t dev_call(struct nta_dev_handle_t* const dev_handle,
+                                       const ntpcie_req_exec_t exec,
+                                       void* const args);
+static void dev_cache_clear(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t req_exec_device_cache_start(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_device_cache_stop(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_device_timeout_set(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_device_deadline_set(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_stats_get(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_stats_reset(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_device_reset(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_nn_reset(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_register_read(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_register_write(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_vector_learn(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_vectors_learn_batch(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_vector_classify(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_vector_classify_adaptive(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_vectors_classify_batch(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_submit_classify(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_poll_completions(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_async_pending(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_async_wait_event(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_neuron_read(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_kbase_store(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_kbase_load(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_kbase_store_all(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_kbase_load_all(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_kbase_id_get(struct nta_dev_handle_t* const dev_handle, void* const args);
+static enum ntpcie_nn_error_t req_exec_kbase_id_set(struct nta_dev_handle_t* const dev_handle, void* const args);
+static uint32_t xpack_size_calc(const size_t comps_count);
+static uint16_t xpack_classify_resp_size_calc(const size_t number_of_responses);
+static void xpack_learn_header_build(struct pcie_data_xpack_t* const tx_data,
+                                     const enum nn_dist_eval_t dist_eval,
+                                     const uint16_t maxif,
+                                     const uint16_t minif,
+                                     const size_t comps_count);
+static enum ntpcie_nn_error_t xpack_learn_exec(struct nta_dev_handle_t* const dev_handle,
+                                               const struct pcie_data_xpack_t* const tx_data,
+                                               const uint32_t pack_size_bytes,
+                                               union rx_data_learn_t* const rx_data);
+static void learn_result_make(struct nn_learn_result_t* const result,
+                              const union rx_data_learn_t* const rx_data,
+                              const uint16_t category,
+                              const size_t neurons_committed);
+static void xpack_classify_header_build(struct pcie_data_xpack_t* const tx_data,
+                                        const enum nn_dist_eval_t dist_eval,
+                                        const uint16_t context,
+                                        const enum nn_classifier_t classifier,
+                                        const size_t number_of_responses,
+                                        const size_t comps_count);
+static enum ntpcie_nn_error_t xpack_classify_exec(struct nta_dev_handle_t* const dev_handle,
+                                                  const struct pcie_data_xpack_t* const tx_data,
+                                                  const uint32_t pack_size_bytes,
+                                                  size_t* const number_of_responses,
+                                                  struct response_neuron_state_t resp[],
+                                                  struct nn_classify_status_t* const status);
+static bool classify_is_decided(const struct nn_classify_status_t* const status,
+                                const size_t number_of_responses,
+                                const struct response_neuron_state_t resp[],
+                                const size_t answers_requested);
+static enum ntpcie_nn_error_t vectors_classify_batch_exec(struct nta_dev_handle_t* const dev_handle,
+                                                          const enum nn_dist_eval_t dist_eval,
+                                                          const uint16_t context,
+                                                          const enum nn_classifier_t classifier,
+                                                          const size_t comps_count,
+                                                          const size_t vectors_count,
+                                                          const nn_vector_comp_t data_vectors[],
+                                                          const size_t vectors_stride,
+                                                          const nn_vector_comp_t* const vectors[],
+                                                          const size_t number_of_responses,
+                                                          size_t responses_count[],
+                                                          struct response_neuron_state_t resp[],
+                                                          size_t* const vectors_done);
+static enum ntpcie_nn_error_t kbase_neuron_store_exec(struct nta_dev_handle_t* const dev_handle,
+                                                      struct nn_neuron_t* const _neuron);
+static enum ntpcie_nn_error_t kbase_neuron_load_exec(struct nta_dev_handle_t* const dev_handle,
+                                                     const size_t comps_count,
+                                                     const struct nn_neuron_t* const _neuron);
+static void async_ring_clear(struct ntpcie_async_ring_t* const ring);
+static void async_ring_fail(struct ntpcie_async_ring_t* const ring, const enum ntpcie_nn_error_t nn_result);
+static void async_req_upload(struct nta_dev_handle_t* const dev_handle, struct ntpcie_async_req_t* const req);
+static enum ntpcie_nn_error_t xpack_classify_results_read(struct nta_dev_handle_t* const dev_handle,
+                                                          const uint16_t bytes,
+                                                          size_t* const number_of_responses,
+                                                          struct response_neuron_state_t resp[],
+                                                          struct nn_classify_status_t* const status);
 
 // public library functions ------------------------------------------------------------
 enum ntpcie_nn_error_t NTIA_API ntpcie_sys_init(struct nta_dev_handle_t  * const dev_handle,
                                                 struct nta_pcidev_list_t * const devs_list)
+{
+  return ntpcie_sys_init_ex(dev_handle, devs_list, NULL);
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_sys_init_ex(struct nta_dev_handle_t  * const dev_handle,
+                                                   struct nta_pcidev_list_t * const devs_list,
+                                                   const struct nta_sys_options_t * const options)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
   enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
@@ -38,26 +294,69 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_sys_init(struct nta_dev_handle_t  * const
     return NTPCIE_ERROR_ARGS_NULL_POINTER;
   }
 
+  const char* transport_name = NULL;
+  uint32_t io_flags          = 0;
+  if (options != NULL)
+  {
+    if ((options->io_flags & NTA_IO_FLAG_WRITE_COMBINING) != 0)
+    {
+      io_flags |= NTIA_PCIE_IO_FLAG_WRITE_COMBINING;
+    }
+    if ((options->io_flags & NTA_IO_FLAG_WIDE_READ) != 0)
+    {
+      io_flags |= NTIA_PCIE_IO_FLAG_WIDE_READ;
+    }
+
+    switch (options->transport)
+    {
+      case NTA_IO_TRANSPORT_DEFAULT:
+        transport_name = NULL;
+        break;
+      case NTA_IO_TRANSPORT_SYSFS:
+        transport_name = "sysfs";
+        break;
+      case NTA_IO_TRANSPORT_UMDFV2:
+        transport_name = "umdfv2";
+        break;
+      case NTA_IO_TRANSPORT_EMU:
+        transport_name = "emu";
+        break;
+      case NTA_IO_TRANSPORT_VFIO:
+        transport_name = "vfio";
+        break;
+      default:
+        return NTPCIE_ERROR_ARGS_TRANSPORT;
+    }
+  }
+
   devs_list_clear(devs_list);
 
-  _loc_io_handle._iox_handle = NULL;
-  _loc_io_handle._u32x_space = NTIA_PCIE_INVALID_SP;
+  struct ntpcie_dev_ctx_t* const dev_ctx = (struct ntpcie_dev_ctx_t*)calloc(1, sizeof(*dev_ctx));
+  if (dev_ctx == NULL)
+  {
+    dev_handle_invalidate(dev_handle);
+    return NTPCIE_ERROR_UNKNOWN;
+  }
+
+  dev_ctx->io_handle._iox_handle = NULL;
+  dev_ctx->io_handle._u32x_space = NTIA_PCIE_INVALID_SP;
+  dev_ctx->io_handle.ops         = NULL;
+  dev_ctx->io_handle.io_flags    = 0;
 
-  io_result = ntia_pcie_io_init(&_loc_io_handle);
+  io_result = ntia_pcie_io_init(&dev_ctx->io_handle, transport_name, io_flags);
 
   if (io_result == NTPCIE_IO_ERROR_SUCCESS)
   {
-    dev_handle->_iox_handle = &_loc_io_handle;
+    dev_handle->_iox_handle = &dev_ctx->io_handle;
     dev_handle_hash_update(dev_handle);
     io_result = ntia_pcie_io_device_scan(dev_handle->_iox_handle, devs_list);
     nn_result = NTPCIE_ERROR_SUCCESS;
   }
   else
   {
-    _loc_io_handle._iox_handle = NULL;
-    _loc_io_handle._u32x_space = NTIA_PCIE_INVALID_SP;
+    free(dev_ctx);
     dev_handle_invalidate(dev_handle);
-    nn_result = NTPCIE_ERROR_UNKNOWN;
+    nn_result = (io_result == NTPCIE_IO_ERROR_NO_TRANSPORT) ? NTPCIE_ERROR_ARGS_TRANSPORT : NTPCIE_ERROR_UNKNOWN;
   }
 
   nn_state_reset(&dev_handle->nn_state);
@@ -76,7 +375,15 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_sys_deinit(struct nta_dev_handle_t* const
     return NTPCIE_ERROR_INVALID_HANDLE;
   }
 
-  io_result = ntia_pcie_io_deinit(&_loc_io_handle);
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+
+  ntpcie_queue_destroy(dev_ctx->queue);
+  dev_ctx->queue = NULL;
+  ntpcie_cache_destroy(dev_ctx->cache);
+  dev_ctx->cache = NULL;
+
+  io_result = ntia_pcie_io_deinit(&dev_ctx->io_handle);
+  free(dev_ctx);
   nn_state_reset(&dev_handle->nn_state);
   dev_handle_invalidate(dev_handle);
 
@@ -111,6 +418,10 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_device_open(struct nta_dev_handle_t * con
     return NTPCIE_ERROR_CARD_OPEN;
   }
 
+  // statistics belong to opened card
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  memset(&dev_ctx->stats, 0, sizeof(dev_ctx->stats));
+
   nn_result = ntpcie_device_reset(dev_handle); // ... and read amount of neurons
   if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
@@ -129,6 +440,10 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_device_close(struct nta_dev_handle_t* con
     return NTPCIE_ERROR_INVALID_HANDLE;
   }
 
+  // pending requests are finished before card is closed, asynchronous ones are dropped
+  ntpcie_device_queue_stop(dev_handle);
+  async_ring_clear(&((struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->async);
+
   io_result = ntia_pcie_io_device_close(dev_handle->_iox_handle);
   if (io_result != NTPCIE_IO_ERROR_SUCCESS)
   {
@@ -140,6 +455,233 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_device_close(struct nta_dev_handle_t* con
   return NTPCIE_ERROR_SUCCESS;
 }
 
+enum ntpcie_nn_error_t NTIA_API ntpcie_device_queue_start(struct nta_dev_handle_t* const dev_handle)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  if (dev_ctx->queue != NULL)
+  {
+    // already started
+    nn_result = NTPCIE_ERROR_SUCCESS;
+    goto ret_result;
+  }
+
+  dev_ctx->queue = ntpcie_queue_create(dev_handle);
+  nn_result      = (dev_ctx->queue != NULL) ? NTPCIE_ERROR_SUCCESS : NTPCIE_ERROR_QUEUE;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_device_queue_stop(struct nta_dev_handle_t* const dev_handle)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+
+  // ATT: requests already submitted are executed, IO thread is joined
+  ntpcie_queue_destroy(dev_ctx->queue);
+  dev_ctx->queue = NULL;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_device_queue_is_started(const struct nta_dev_handle_t* const dev_handle,
+                                                               bool* const started)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (started == NULL)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  *started = (((const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->queue != NULL);
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_device_cache_start(struct nta_dev_handle_t* const dev_handle,
+                                                          const size_t entries_count)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // cache is used by IO thread: it is replaced by IO thread too
+    struct req_device_cache_start_t req = { entries_count };
+    return dev_call(dev_handle, req_exec_device_cache_start, &req);
+  }
+  else if ((entries_count < 1) || (entries_count > NTPCIE_CACHE_ENTRIES_MAX))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_ENTRIES_COUNT;
+    goto ret_result;
+  }
+
+  struct ntpcie_cache_t* const cache = ntpcie_cache_create(entries_count);
+  if (cache == NULL)
+  {
+    nn_result = NTPCIE_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  ntpcie_cache_destroy(dev_ctx->cache);
+  dev_ctx->cache = cache;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_device_cache_stop(struct nta_dev_handle_t* const dev_handle)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    return dev_call(dev_handle, req_exec_device_cache_stop, NULL);
+  }
+
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  ntpcie_cache_destroy(dev_ctx->cache);
+  dev_ctx->cache = NULL;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_device_timeout_set(struct nta_dev_handle_t* const dev_handle,
+                                                          const uint64_t timeout_ns)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // timeout is used by IO thread: it is changed by IO thread too
+    struct req_device_time_set_t req = { timeout_ns };
+    return dev_call(dev_handle, req_exec_device_timeout_set, &req);
+  }
+
+  ((struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->timeout_ns = timeout_ns;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_device_deadline_set(struct nta_dev_handle_t* const dev_handle,
+                                                           const uint64_t deadline_ns)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // ATT: deadline is set in order of requests of queue (after calls submitted before)
+    struct req_device_time_set_t req = { deadline_ns };
+    return dev_call(dev_handle, req_exec_device_deadline_set, &req);
+  }
+
+  ((struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->deadline_ns = deadline_ns;
+
+ret_result:
+  return nn_result;
+}
+
+uint64_t NTIA_API ntpcie_clock_now_ns(void)
+{
+  return ntpcie_clock_ns();
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_stats_get(struct nta_dev_handle_t* const dev_handle, struct nn_stats_t* const stats)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // statistics are updated by IO thread: consistent copy is made by it too
+    struct req_stats_get_t req = { stats };
+    return dev_call(dev_handle, req_exec_stats_get, &req);
+  }
+  else if (stats == NULL)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  *stats = ((const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->stats;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_stats_reset(struct nta_dev_handle_t* const dev_handle)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    return dev_call(dev_handle, req_exec_stats_reset, NULL);
+  }
+
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  memset(&dev_ctx->stats, 0, sizeof(dev_ctx->stats));
+
+ret_result:
+  return nn_result;
+}
+
 enum ntpcie_nn_error_t NTIA_API ntpcie_device_reset(struct nta_dev_handle_t* const dev_handle)
 {
   enum ntpcie_nn_error_t nn_result;
@@ -149,8 +691,15 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_device_reset(struct nta_dev_handle_t* con
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    return dev_call(dev_handle, req_exec_device_reset, NULL);
+  }
 
   nn_state_reset(&dev_handle->nn_state);
+  async_ring_clear(&((struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->async);
+  dev_cache_clear(dev_handle);
 
   nn_result = ntpcie_card_reset(dev_handle); // NB: ... and get neurons_overall from card and set in dev_handle info struct
 
@@ -167,6 +716,11 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_reset(struct nta_dev_handle_t* const d
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    return dev_call(dev_handle, req_exec_nn_reset, NULL);
+  }
 
   dev_handle->nn_state.kbase_id          = 0;
   dev_handle->nn_state.neurons_committed = 0;
@@ -183,6 +737,7 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_register_read(struct nta_dev_handle_t*
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
   enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
 
   struct pcie_data_upack_t tx_data;
   union nn_int_reg_io_t rx_data;
@@ -192,34 +747,50 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_register_read(struct nta_dev_handle_t*
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_register_read_t req = { reg_address, reg_value };
+    return dev_call(dev_handle, req_exec_register_read, &req);
+  }
   else if (reg_value == NULL)
   {
     nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
     goto ret_result;
   }
 
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_REG_READ, time_call_ns);
+
   memset(&tx_data, 0, sizeof(tx_data));
 
   tx_data.opcode      = NTPCIE_OC_REG_READ;
   tx_data.reg_address = (uint8_t)reg_address;
 
-  nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
   if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
     goto ret_result;
   }
 
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
+
   io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, sizeof(tx_data));
   if (io_result == NTPCIE_IO_ERROR_SUCCESS)
   {
     union pcie_card_status_t dev_status;
 
-    nn_result = ntpcie_card_wait_ready_data(dev_handle, NTPCIE_MAX_CYCLES_STD, &dev_status);
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_UPLOAD);
+
+    nn_result = ntpcie_card_wait_ready_data(dev_handle, ntpcie_card_deadline_ns(dev_handle), &dev_status);
     if (nn_result != NTPCIE_ERROR_SUCCESS)
     {
       goto ret_result;
     }
 
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_COMPUTE);
+
     io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_data.data);
     if (io_result != NTPCIE_IO_ERROR_SUCCESS)
     {
@@ -230,6 +801,8 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_register_read(struct nta_dev_handle_t*
     {
       *reg_value = rx_data.part.value;
       nn_result  = NTPCIE_ERROR_SUCCESS;
+      ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_READBACK);
+      ntpcie_stats_add(dev_handle, NN_STATS_OPER_REG_READ);
       goto ret_result;
     }
     else
@@ -254,12 +827,24 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_register_write(struct nta_dev_handle_t
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
   enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
 
   if (dev_handle_is_valid(dev_handle) != true)
   {
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_register_write_t req = { reg_address, reg_value };
+    return dev_call(dev_handle, req_exec_register_write, &req);
+  }
+
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_REG_WRITE, time_call_ns);
+
+  // any register write may change knowledge base (FORGET, neuron registers)
+  dev_cache_clear(dev_handle);
 
   struct pcie_data_upack_t tx_data;
   union nn_int_reg_io_t rx_data;
@@ -270,18 +855,26 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_register_write(struct nta_dev_handle_t
   tx_data.reg_address = (uint8_t)reg_address;
   tx_data.reg_data    = reg_value;
 
-  nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
   if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
     goto ret_result;
   }
 
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
+
   // write data to memory
   io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, sizeof(tx_data));
   if (io_result == NTPCIE_IO_ERROR_SUCCESS)
   {
     union pcie_card_status_t dev_status;
-    for (size_t cnt = 0; cnt < NTPCIE_MAX_CYCLES_STD; ++cnt)
+
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_UPLOAD);
+
+    const uint64_t deadline_ns = ntpcie_card_deadline_ns(dev_handle);
+    for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
     {
       // read status register
       io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
@@ -293,6 +886,8 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_register_write(struct nta_dev_handle_t
       // check data ready
       if (dev_status.part.results_ready == 1)
       {
+        ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_COMPUTE);
+
         // read data from memory
         io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_data.data);
         if (io_result != NTPCIE_IO_ERROR_SUCCESS)
@@ -303,9 +898,18 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_register_write(struct nta_dev_handle_t
         else if (rx_data.part.opcode == tx_data.opcode && rx_data.part.address == tx_data.reg_address)
         {
           nn_result = NTPCIE_ERROR_SUCCESS;
+          ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_READBACK);
+          ntpcie_stats_add(dev_handle, NN_STATS_OPER_REG_WRITE);
           goto ret_result;
         }
       }
+
+      // results are not ready yet: block until card event (if transport supports it)
+      nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+      if (nn_result != NTPCIE_ERROR_SUCCESS)
+      {
+        goto ret_result;
+      }
     }
     nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
     goto ret_result;
@@ -329,18 +933,35 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_learn(struct nta_dev_handle_t*
                                                        const size_t comps_count,
                                                        const nn_vector_comp_t data_vector[])
 {
-  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
-  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
-  uint16_t bytes                   = 0;
-  uint32_t pack_size_bytes         = 0;
-
-  union pcie_card_status_t dev_status;
+  return ntpcie_nn_vector_learn_ex(dev_handle, dist_eval, context, category, maxif, minif,
+                                   comps_count, data_vector, NULL);
+}
 
-  if (dev_handle_is_valid(dev_handle) != true)
+enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_learn_ex(struct nta_dev_handle_t* const dev_handle,
+                                                          const enum nn_dist_eval_t dist_eval,
+                                                          const uint16_t context,
+                                                          const uint16_t category,
+                                                          const uint16_t maxif,
+                                                          const uint16_t minif,
+                                                          const size_t comps_count,
+                                                          const nn_vector_comp_t data_vector[],
+                                                          struct nn_learn_result_t* const result)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
+  uint32_t pack_size_bytes         = 0;
+
+  if (dev_handle_is_valid(dev_handle) != true)
   {
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_vector_learn_t req = { dist_eval, context, category, maxif, minif, comps_count, data_vector, result };
+    return dev_call(dev_handle, req_exec_vector_learn, &req);
+  }
   else if (data_vector == NULL)
   {
     nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
@@ -367,35 +988,21 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_learn(struct nta_dev_handle_t*
     goto ret_result;
   }
 
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_LEARN, time_call_ns);
+
   struct pcie_data_xpack_t tx_data;
   union rx_data_learn_t rx_data;
 
-  uint32_t comps_size_bytes = (uint32_t)(sizeof(tx_data.comp[0]) * comps_count);
-
   // build data pack (header) to send PCIe card
-  tx_data.upack.opcode                 = NTPCIE_OC_VECTOR_LEARN;
-  tx_data.upack.config_bits.classifier = NN_CLASSIFIER_RBF;
-  tx_data.upack.config_bits.dummy_c    = 0;
-  tx_data.upack.ncr_bits.context       = (context & 0x7Fu);
-  tx_data.upack.ncr_bits.dist_eval     = dist_eval;
-  tx_data.upack.category               = category;
-  tx_data.upack.maxif                  = maxif;
-  tx_data.upack.minif                  = minif;
-  tx_data.upack.length                 = (uint8_t)(comps_count - 1);
+  xpack_learn_header_build(&tx_data, dist_eval, maxif, minif, comps_count);
+  tx_data.upack.ncr_bits.context = (context & 0x7Fu);
+  tx_data.upack.category         = category;
 
   // copy components
-  memcpy(&tx_data.comp[0], &data_vector[0], comps_size_bytes);
+  memcpy(&tx_data.comp[0], &data_vector[0], sizeof(tx_data.comp[0]) * comps_count);
 
   // calculate size in bytes to send
-  pack_size_bytes = sizeof(tx_data.upack) + comps_size_bytes;
-
-  // HACK: workaround: componets count (sizeof *data_pack) MUST be multiple 4 (bytes)
-  uint16_t pack_size_m4_remains = pack_size_bytes & 0x0003u;
-  if (pack_size_m4_remains > 0)
-  {
-    pack_size_bytes += (4 - pack_size_m4_remains);
-  }
-  // -----------------------------------------------------------------
+  pack_size_bytes = xpack_size_calc(comps_count);
 
   if (pack_size_bytes > sizeof(tx_data))
   {
@@ -403,89 +1010,147 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_learn(struct nta_dev_handle_t*
     goto ret_result;
   }
 
-  nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
   if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
     goto ret_result;
   }
 
-  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
 
-  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, pack_size_bytes);
-  if (io_result == NTPCIE_IO_ERROR_SUCCESS)
+  // outcome of learn is known from change of committed neurons count
+  const size_t neurons_committed = dev_handle->nn_state.neurons_committed;
+
+  dev_cache_clear(dev_handle);
+  nn_result = xpack_learn_exec(dev_handle, &tx_data, pack_size_bytes, &rx_data);
+  if ((nn_result == NTPCIE_ERROR_SUCCESS) && (result != NULL))
   {
-    for (size_t cnt = 0; cnt < NTPCIE_MAX_CYCLES_STD; ++cnt)
-    {
-      // read status register
-      io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
-      if (io_result != NTPCIE_IO_ERROR_SUCCESS)
-      {
-        nn_result = NTPCIE_ERROR_SERV_READ;
-        goto ret_result;
-      }
-      // check data ready and net ready
-      if (dev_status.part.results_ready == 1)
-      {
-        bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
-        // we have needly amount bytes to read
-        if (bytes == sizeof(rx_data))
-        {
-          // read data from PCIe card
-          io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_data.data, bytes);
-          if (io_result != NTPCIE_IO_ERROR_SUCCESS)
-          {
-            nn_result = NTPCIE_ERROR_DATA_READ;
-            goto ret_result;
-          }
+    learn_result_make(result, &rx_data, category, neurons_committed);
+  }
 
-          uint64_t cpu_cycles_stop = _cpu_get_tick_count();
+ret_result:
+  return nn_result;
+}
 
-          if (rx_data.part.ncount == 0xFFFFu)
-          {
-            if (dev_handle->nn_state.neurons_committed != dev_handle->nn_state.neurons_overall)
-            {
-              dev_handle->nn_state.neurons_committed = dev_handle->nn_state.neurons_overall;
-            }
-          }
-          else
-          {
-            dev_handle->nn_state.neurons_committed = rx_data.part.ncount;
-          }
+enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vectors_learn_batch(struct nta_dev_handle_t* const dev_handle,
+                                                              const enum nn_dist_eval_t dist_eval,
+                                                              const uint16_t maxif,
+                                                              const uint16_t minif,
+                                                              const size_t comps_count,
+                                                              const size_t records_count,
+                                                              const struct nn_learn_record_t records[],
+                                                              struct nn_learn_result_t results[],
+                                                              size_t* const records_done)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
+  uint32_t pack_size_bytes         = 0;
+  size_t ix_record                 = 0;
 
-          // update performance counters
-          ++(dev_handle->nn_state.vecs_count_total_learn);
-          dev_handle->nn_state.cpu_ticks_last_oper = cpu_cycles_stop - cpu_cycles_start;
-          dev_handle->nn_state.cpu_ticks_total_learn += dev_handle->nn_state.cpu_ticks_last_oper;
-          dev_handle->nn_state.count_loop_wait_ready = cnt;
+  // ATT: all arguments (and all records) are checked before first vector is sent to card
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_vectors_learn_batch_t req = { dist_eval, maxif, minif, comps_count, records_count, records, results, records_done };
+    return dev_call(dev_handle, req_exec_vectors_learn_batch, &req);
+  }
+  else if (records == NULL)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((comps_count < 1) || (comps_count > NN_NEURON_COMPONENTS))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
+    goto ret_result;
+  }
+  else if ((dist_eval != NN_DIST_EVAL_L1) && (dist_eval != NN_DIST_EVAL_LSUP))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_DIST_EVAL;
+    goto ret_result;
+  }
 
-          nn_result = NTPCIE_ERROR_SUCCESS;
-          goto ret_result;
-        }
-        // we havn't needly amount bytes to read
-        else if (bytes > 0)
-        {
-          nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
-          goto ret_result;
-        }
-        // we havn't bytes to read
-        else
-        {
-          nn_result = NTPCIE_ERROR_NO_DATA_FOR_READ;
-          goto ret_result;
-        }
-      }
+  for (size_t ix = 0; ix < records_count; ++ix)
+  {
+    if (records[ix].comps == NULL)
+    {
+      nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+      goto ret_result;
+    }
+    else if ((records[ix].context < 1) || (records[ix].context > 127))
+    {
+      nn_result = NTPCIE_ERROR_ARGS_CONTEXT;
+      goto ret_result;
+    }
+    else if (records[ix].category > 32766)
+    {
+      nn_result = NTPCIE_ERROR_ARGS_CATEGORY;
+      goto ret_result;
     }
-    // wait time is out
-    nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
-    goto ret_result;
   }
-  else
+
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_LEARN, time_call_ns);
+
+  struct pcie_data_xpack_t tx_data;
+  union rx_data_learn_t rx_data;
+
+  // common part of header is built once, tail (padding) of components area is zeroed once
+  xpack_learn_header_build(&tx_data, dist_eval, maxif, minif, comps_count);
+  memset(&tx_data.comp[0], 0, sizeof(tx_data.comp));
+
+  pack_size_bytes = xpack_size_calc(comps_count);
+
+  if (pack_size_bytes > sizeof(tx_data))
   {
-    nn_result = NTPCIE_ERROR_DATA_WRITE;
+    nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
     goto ret_result;
   }
 
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  // "ready" of card is checked before every record (see ntpcie_kbase_store_all)
+  dev_cache_clear(dev_handle);
+  for (ix_record = 0; ix_record < records_count; ++ix_record)
+  {
+    tx_data.upack.ncr_bits.context = (records[ix_record].context & 0x7Fu);
+    tx_data.upack.category         = records[ix_record].category;
+    memcpy(&tx_data.comp[0], records[ix_record].comps, sizeof(tx_data.comp[0]) * comps_count);
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+    nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
+
+    const size_t neurons_committed = dev_handle->nn_state.neurons_committed;
+
+    nn_result = xpack_learn_exec(dev_handle, &tx_data, pack_size_bytes, &rx_data);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+
+    if (results != NULL)
+    {
+      learn_result_make(&results[ix_record], &rx_data, records[ix_record].category, neurons_committed);
+    }
+  }
+
 ret_result:
+  if (records_done != NULL)
+  {
+    *records_done = ix_record;
+  }
   return nn_result;
 }
 
@@ -497,20 +1162,43 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_classify(struct nta_dev_handle_
                                                           const nn_vector_comp_t data_vector[],
                                                           size_t* const number_of_responses,
                                                           struct response_neuron_state_t resp[])
+{
+  return ntpcie_nn_vector_classify_ex(dev_handle, dist_eval, context, classifier, comps_count,
+                                      data_vector, number_of_responses, resp, NULL);
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_classify_ex(struct nta_dev_handle_t* const dev_handle,
+                                                             const enum nn_dist_eval_t dist_eval,
+                                                             const uint16_t context,
+                                                             const enum nn_classifier_t classifier,
+                                                             const size_t comps_count,
+                                                             const nn_vector_comp_t data_vector[],
+                                                             size_t* const number_of_responses,
+                                                             struct response_neuron_state_t resp[],
+                                                             struct nn_classify_status_t* const status)
 {
   enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
-  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
-  uint16_t bytes                   = 0;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
   uint32_t pack_size_bytes         = 0;
-
-  union pcie_card_status_t dev_status;
+  struct nn_classify_status_t status_card;
 
   if (dev_handle_is_valid(dev_handle) != true)
   {
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
-  else if ((data_vector == NULL) || (number_of_responses == NULL) || (resp == NULL))
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_vector_classify_t req = { dist_eval, context, classifier, comps_count, data_vector, number_of_responses, resp, status };
+    return dev_call(dev_handle, req_exec_vector_classify, &req);
+  }
+  else if ((data_vector == NULL) || (number_of_responses == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((resp == NULL) && (*number_of_responses > 0))
   {
     nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
     goto ret_result;
@@ -535,45 +1223,46 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_classify(struct nta_dev_handle_
     nn_result = NTPCIE_ERROR_ARGS_CLASSIFIER;
     goto ret_result;
   }
-  else if ((*number_of_responses < 1) || (*number_of_responses > NN_MAX_RESP_COUNT))
+  else if ((*number_of_responses > NN_MAX_RESP_COUNT) || ((*number_of_responses < 1) && (status == NULL)))
   {
+    // request of status only (no responses) is valid
     nn_result = NTPCIE_ERROR_ARGS_RESP_COUNT;
     goto ret_result;
   }
 
-  struct pcie_data_xpack_t tx_data;
-  struct rx_data_class_t rx_data;
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_CLASSIFY, time_call_ns);
+
+  // the same request after last change of knowledge base: responses of card are known
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  struct ntpcie_cache_t* const cache     = dev_ctx->cache;
+  struct ntpcie_cache_key_t cache_key;
+  if (dev_ctx->async.count > 0)
+  {
+    // card belongs to asynchronous requests: answer doesn't depend on cache
+    nn_result = NTPCIE_ERROR_BUSY;
+    goto ret_result;
+  }
+  else if (cache != NULL)
+  {
+    ntpcie_cache_key_make(&cache_key, dist_eval, context, classifier, *number_of_responses, comps_count, data_vector);
+    if (ntpcie_cache_lookup(cache, &cache_key, number_of_responses, resp, &status_card))
+    {
+      ++dev_ctx->stats.oper[NN_STATS_OPER_CLASSIFY].cache_hits;
+      ntpcie_stats_add(dev_handle, NN_STATS_OPER_CLASSIFY);
+      goto ret_status;
+    }
+  }
 
-  uint32_t comps_size_bytes = (uint32_t)(sizeof(tx_data.comp[0]) * comps_count);
+  struct pcie_data_xpack_t tx_data;
 
   // build data pack (header) to send PCIe card
-  tx_data.upack.opcode                 = NTPCIE_OC_VECTOR_CLASSIFY;
-  tx_data.upack.config_bits.classifier = (classifier & 0x01u);
-  tx_data.upack.config_bits.dummy_c    = 0;
-  tx_data.upack.ncr_bits.context       = (context & 0x7Fu);
-  tx_data.upack.ncr_bits.dist_eval     = dist_eval;
-  // MAX resp's
-  tx_data.upack.answers = (uint8_t)(*number_of_responses);
-  // set components count
-  tx_data.upack.length = (uint8_t)(comps_count - 1);
-  // unused in this mode
-  tx_data.upack.category = 0;
-  tx_data.upack.maxif    = 0;
-  tx_data.upack.minif    = 0;
+  xpack_classify_header_build(&tx_data, dist_eval, context, classifier, *number_of_responses, comps_count);
 
   // copy components
-  memcpy(&tx_data.comp[0], &data_vector[0], comps_size_bytes);
+  memcpy(&tx_data.comp[0], &data_vector[0], sizeof(tx_data.comp[0]) * comps_count);
 
   // calculate size in bytes to send
-  pack_size_bytes = sizeof(tx_data.upack) + comps_size_bytes;
-
-  // HACK: workaround: componets count (sizeof *data_pack) MUST be multiple 4 (bytes)
-  uint16_t pack_size_m4_remains = pack_size_bytes & 0x0003u;
-  if (pack_size_m4_remains > 0)
-  {
-    pack_size_bytes += (4 - pack_size_m4_remains);
-  }
-  // -----------------------------------------------------------------
+  pack_size_bytes = xpack_size_calc(comps_count);
 
   if (pack_size_bytes > sizeof(tx_data))
   {
@@ -581,216 +1270,414 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_classify(struct nta_dev_handle_
     goto ret_result;
   }
 
-  nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
   if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
     goto ret_result;
   }
 
-  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
 
 #ifdef NTIAPCIE_DEBUG
   puts(" *** NTIAPCIE_DEBUG active");
   fprintf(stderr, "----- (1) nresp = %zu\n", *number_of_responses);
 #endif // NTIAPCIE_DEBUG
 
-  // write data to memory
-  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, pack_size_bytes);
-  if (io_result == NTPCIE_IO_ERROR_SUCCESS)
-  {
-    for (size_t cnt = 0; cnt < NTPCIE_MAX_CYCLES_STD; ++cnt)
-    {
-      // read status register
-      io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
-      if (io_result != NTPCIE_IO_ERROR_SUCCESS)
-      {
-        nn_result = NTPCIE_ERROR_SERV_READ;
-        goto ret_result;
-      }
-      // check data ready and net ready
-      if (dev_status.part.results_ready == 1)
-      {
-        bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
-        // we have needly amount bytes to read
-        if (bytes == 0 || bytes > sizeof(rx_data))
-        {
-          nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
-          goto ret_result;
-        }
-        else
-        {
-          // read data from memory
-          io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_data, bytes);
-          if (io_result != NTPCIE_IO_ERROR_SUCCESS)
-          {
-            nn_result = NTPCIE_ERROR_DATA_READ;
-            goto ret_result;
-          }
-
-          if (rx_data.opcode == NTPCIE_OC_FAULT)
-          {
-            nn_result = NTPCIE_ERROR_CARD_FAULT;
-            goto ret_result;
-          }
-
-          uint64_t cpu_cycles_stop = _cpu_get_tick_count();
-          // update performance counters
-          ++(dev_handle->nn_state.vecs_count_total_class);
-          dev_handle->nn_state.cpu_ticks_last_oper = cpu_cycles_stop - cpu_cycles_start;
-          dev_handle->nn_state.cpu_ticks_total_class += dev_handle->nn_state.cpu_ticks_last_oper;
-          dev_handle->nn_state.count_loop_wait_ready = cnt;
-
-          // make results to return
-          size_t real_number_of_responses = (*number_of_responses > rx_data.ncount) ? rx_data.ncount : *number_of_responses;
-          for (size_t ix = 0; ix < real_number_of_responses; ++ix)
-          {
-            uint16_t distance;
-            distance = rx_data.data[ix].distance;
-            if (distance == 0xFFFFu)
-            {
-              real_number_of_responses = ix;
-              break;
-            }
-            resp[ix].id          = rx_data.data[ix].id;
-            resp[ix].category    = rx_data.data[ix].category;
-            resp[ix].degenerated = rx_data.data[ix].degenerated;
-            resp[ix].distance    = distance;
-          }
-          // set final responses count
-          *number_of_responses = real_number_of_responses;
+  nn_result = xpack_classify_exec(dev_handle, &tx_data, pack_size_bytes, number_of_responses, resp, &status_card);
 
 #ifdef NTIAPCIE_DEBUG
-          puts(" *** NTIAPCIE_DEBUG active");
-          fprintf(stderr, "----- (2) nresp = %zu\n", *number_of_responses);
+  puts(" *** NTIAPCIE_DEBUG active");
+  fprintf(stderr, "----- (2) nresp = %zu\n", *number_of_responses);
 #endif // NTIAPCIE_DEBUG
 
-          nn_result = NTPCIE_ERROR_SUCCESS;
-          goto ret_result;
-        }
-      }
-    }
-    // wait time is out
-    nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
     goto ret_result;
   }
-  else
+  else if (cache != NULL)
   {
-    nn_result = NTPCIE_ERROR_DATA_WRITE;
-    goto ret_result;
+    ntpcie_cache_insert(cache, &cache_key, *number_of_responses, resp, &status_card);
+  }
+
+ret_status:
+  if (status != NULL)
+  {
+    *status = status_card;
   }
 
 ret_result:
   return nn_result;
 }
 
-enum ntpcie_nn_error_t NTIA_API ntpcie_nn_neuron_read(struct nta_dev_handle_t* const dev_handle,
-                                                      const uint16_t ix_neuron,
-                                                      struct nn_neuron_t* const _neuron)
+enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vector_classify_adaptive(struct nta_dev_handle_t* const dev_handle,
+                                                                   const enum nn_dist_eval_t dist_eval,
+                                                                   const uint16_t context,
+                                                                   const enum nn_classifier_t classifier,
+                                                                   const size_t comps_count,
+                                                                   const nn_vector_comp_t data_vector[],
+                                                                   const size_t answers_first,
+                                                                   size_t* const number_of_responses,
+                                                                   struct response_neuron_state_t resp[],
+                                                                   struct nn_classify_status_t* const status)
 {
   enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
-  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
-  uint16_t bytes                   = 0;
-
-  union pcie_card_status_t dev_status;
+  struct nn_classify_status_t status_card;
 
   if (dev_handle_is_valid(dev_handle) != true)
   {
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
-  else if (_neuron == NULL)
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // both queries are executed by IO thread as one request: knowledge base is the same for them
+    struct req_vector_classify_adaptive_t req = { dist_eval,   context,       classifier,          comps_count, data_vector,
+                                                  answers_first, number_of_responses, resp,  status };
+    return dev_call(dev_handle, req_exec_vector_classify_adaptive, &req);
+  }
+  else if ((number_of_responses == NULL) || (resp == NULL))
   {
     nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
     goto ret_result;
   }
-#ifdef NTIAPCIE_DEBUG
-  puts(" *** NTIAPCIE_DEBUG active");
-#else
-  else if (ix_neuron > dev_handle->nn_state.neurons_overall)
+  else if ((answers_first < 1) || (*number_of_responses < 1) || (*number_of_responses > NN_MAX_RESP_COUNT))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_RESP_COUNT;
+    goto ret_result;
+  }
+
+  const size_t answers_max = *number_of_responses;
+  const size_t answers     = (answers_first < answers_max) ? answers_first : answers_max;
+
+  // first query: readback of few responses is enough for most vectors
+  *number_of_responses = answers;
+  nn_result = ntpcie_nn_vector_classify_ex(dev_handle, dist_eval, context, classifier, comps_count,
+                                           data_vector, number_of_responses, resp, &status_card);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  if ((answers < answers_max) && (classify_is_decided(&status_card, *number_of_responses, resp, answers) != true))
+  {
+    // second query: the same vector with all responses requested by application
+    *number_of_responses = answers_max;
+    nn_result = ntpcie_nn_vector_classify_ex(dev_handle, dist_eval, context, classifier, comps_count,
+                                             data_vector, number_of_responses, resp, &status_card);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+  }
+
+  if (status != NULL)
+  {
+    *status = status_card;
+  }
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vectors_classify_batch(struct nta_dev_handle_t* const dev_handle,
+                                                                 const enum nn_dist_eval_t dist_eval,
+                                                                 const uint16_t context,
+                                                                 const enum nn_classifier_t classifier,
+                                                                 const size_t comps_count,
+                                                                 const size_t vectors_count,
+                                                                 const nn_vector_comp_t data_vectors[],
+                                                                 const size_t vectors_stride,
+                                                                 const size_t number_of_responses,
+                                                                 size_t responses_count[],
+                                                                 struct response_neuron_state_t resp[],
+                                                                 size_t* const vectors_done)
+{
+  return vectors_classify_batch_exec(dev_handle, dist_eval, context, classifier, comps_count, vectors_count,
+                                     data_vectors, vectors_stride, NULL,
+                                     number_of_responses, responses_count, resp, vectors_done);
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_nn_vectors_classify_batch_ptr(struct nta_dev_handle_t* const dev_handle,
+                                                                     const enum nn_dist_eval_t dist_eval,
+                                                                     const uint16_t context,
+                                                                     const enum nn_classifier_t classifier,
+                                                                     const size_t comps_count,
+                                                                     const size_t vectors_count,
+                                                                     const nn_vector_comp_t* const vectors[],
+                                                                     const size_t number_of_responses,
+                                                                     size_t responses_count[],
+                                                                     struct response_neuron_state_t resp[],
+                                                                     size_t* const vectors_done)
+{
+  return vectors_classify_batch_exec(dev_handle, dist_eval, context, classifier, comps_count, vectors_count,
+                                     NULL, 0, vectors, number_of_responses, responses_count, resp, vectors_done);
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_submit_classify(struct nta_dev_handle_t* const dev_handle,
+                                                       const enum nn_dist_eval_t dist_eval,
+                                                       const uint16_t context,
+                                                       const enum nn_classifier_t classifier,
+                                                       const size_t comps_count,
+                                                       const nn_vector_comp_t data_vector[],
+                                                       const size_t number_of_responses,
+                                                       struct response_neuron_state_t resp[],
+                                                       uint32_t* const token)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_submit_classify_t req = { dist_eval, context, classifier, comps_count, data_vector, number_of_responses, resp, token };
+    return dev_call(dev_handle, req_exec_submit_classify, &req);
+  }
+  else if ((data_vector == NULL) || (resp == NULL) || (token == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((comps_count < 1) || (comps_count > NN_NEURON_COMPONENTS))
   {
     nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
     goto ret_result;
   }
-#endif // NTIAPCIE_DEBUG
+  else if ((dist_eval != NN_DIST_EVAL_L1) && (dist_eval != NN_DIST_EVAL_LSUP))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_DIST_EVAL;
+    goto ret_result;
+  }
+  else if ((context < 1) || (context > 127))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CONTEXT;
+    goto ret_result;
+  }
+  else if ((classifier != NN_CLASSIFIER_KNN) && (classifier != NN_CLASSIFIER_RBF))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CLASSIFIER;
+    goto ret_result;
+  }
+  else if ((number_of_responses < 1) || (number_of_responses > NN_MAX_RESP_COUNT))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_RESP_COUNT;
+    goto ret_result;
+  }
 
-  struct pcie_data_upack_t tx_data;
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  struct ntpcie_async_ring_t* const ring = &dev_ctx->async;
 
-  memset(&tx_data, 0, sizeof(tx_data));
+  if (ring->count >= NTPCIE_ASYNC_DEPTH)
+  {
+    nn_result = NTPCIE_ERROR_BUSY;
+    goto ret_result;
+  }
+  else if (ring->count == 0)
+  {
+    // card must be ready for first request, next ones are uploaded as soon as results of previous are read
+    nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+  }
 
-  tx_data.opcode   = NTPCIE_OC_NEURON_READ;
-  tx_data.reg_data = ix_neuron;
+  struct ntpcie_async_req_t* const req = &ring->reqs[(ring->head + ring->count) % NTPCIE_ASYNC_DEPTH];
 
-  nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
-  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  // build data pack: it is kept in ring until upload
+  xpack_classify_header_build(&req->tx_data, dist_eval, context, classifier, number_of_responses, comps_count);
+  memcpy(&req->tx_data.comp[0], &data_vector[0], sizeof(req->tx_data.comp[0]) * comps_count);
+  memset(&req->tx_data.comp[comps_count], 0, sizeof(req->tx_data.comp) - sizeof(req->tx_data.comp[0]) * comps_count);
+
+  req->pack_size_bytes = xpack_size_calc(comps_count);
+  if (req->pack_size_bytes > sizeof(req->tx_data))
   {
+    nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
     goto ret_result;
   }
 
-  // write data to memory
-  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, sizeof(tx_data));
-  if (io_result == NTPCIE_IO_ERROR_SUCCESS)
+  // 0 is never used as token
+  if (++(ring->token_last) == 0)
+  {
+    ring->token_last = 1;
+  }
+
+  req->token               = ring->token_last;
+  req->result              = NTPCIE_ERROR_SUCCESS;
+  req->number_of_responses = number_of_responses;
+  req->resp                = resp;
+  req->cpu_ticks_start     = 0;
+  req->time_start_ns       = ntpcie_call_time_ns(dev_handle, time_call_ns);
+
+  ++(ring->count);
+  if (ring->count == 1)
+  {
+    // card is idle
+    async_req_upload(dev_handle, req);
+  }
+
+  *token    = req->token;
+  nn_result = NTPCIE_ERROR_SUCCESS;
+
+ret_result:
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_poll_completions(struct nta_dev_handle_t* const dev_handle,
+                                                        struct nta_completion_t completions[],
+                                                        const size_t completions_max,
+                                                        size_t* const completions_count)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  size_t done                      = 0;
+
+  if (dev_handle_is_valid(dev_handle) != true)
   {
-    for (size_t cnt = 0; cnt < NTPCIE_MAX_CYCLES_STD; ++cnt)
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_poll_completions_t req = { completions, completions_max, completions_count };
+    return dev_call(dev_handle, req_exec_poll_completions, &req);
+  }
+  else if ((completions == NULL) || (completions_count == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  struct ntpcie_dev_ctx_t* const dev_ctx = dev_handle->_iox_handle;
+  struct ntpcie_async_ring_t* const ring = &dev_ctx->async;
+
+  while (done < completions_max && ring->count > 0)
+  {
+    struct ntpcie_async_req_t* const req = &ring->reqs[ring->head];
+
+    // request with failed upload is completed at once
+    if (req->result == NTPCIE_ERROR_SUCCESS)
     {
-      // read status register
+      union pcie_card_status_t dev_status;
+
       io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
       if (io_result != NTPCIE_IO_ERROR_SUCCESS)
       {
-        nn_result = NTPCIE_ERROR_SERV_READ;
-        goto ret_result;
+        req->result = NTPCIE_ERROR_SERV_READ;
       }
-      // check data ready and net ready
-      if (dev_status.part.results_ready == 1)
+      else if (dev_status.part.results_ready == 1)
       {
-        bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
-        // we have bytes to read
-        if (bytes > 0)
-        {
-          if (bytes > sizeof(*_neuron))
-          {
-            nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
-            goto ret_result;
-          }
-          // read data from memory
-          io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, _neuron, sizeof(*_neuron));
-          if (io_result == NTPCIE_IO_ERROR_SUCCESS)
-          {
-            nn_result = NTPCIE_ERROR_SUCCESS;
-            goto ret_result;
-          }
-          else
-          {
-            nn_result = NTPCIE_ERROR_DATA_READ;
-            goto ret_result;
-          }
-        }
-        // we have not bytes to read
-        else
+        const uint16_t bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
+
+        req->result = xpack_classify_results_read(dev_handle, bytes, &req->number_of_responses, req->resp, NULL);
+        if (req->result == NTPCIE_ERROR_SUCCESS)
         {
-          nn_result = NTPCIE_ERROR_NO_DATA_FOR_READ;
-          goto ret_result;
+          uint64_t cpu_cycles_stop = _cpu_get_tick_count();
+          // update performance counters
+          ++(dev_handle->nn_state.vecs_count_total_class);
+          dev_handle->nn_state.cpu_ticks_last_oper = cpu_cycles_stop - req->cpu_ticks_start;
+          dev_handle->nn_state.cpu_ticks_total_class += dev_handle->nn_state.cpu_ticks_last_oper;
+          ntpcie_stats_latency_add(dev_handle, NN_STATS_OPER_CLASSIFY, req->time_start_ns);
         }
       }
+      else if (dev_status.part.fault == 1)
+      {
+        req->result = NTPCIE_ERROR_CARD_FAULT;
+      }
+      else if (ntpcie_clock_ns() >= req->deadline_ns)
+      {
+        req->result = NTPCIE_ERROR_WAIT_TIMEOUT;
+      }
+      else
+      {
+        // card is still busy with request
+        break;
+      }
+
+      if ((req->result == NTPCIE_ERROR_SERV_READ) || (req->result == NTPCIE_ERROR_WAIT_TIMEOUT))
+      {
+        // state of card is unknown: requests waiting for upload aren't uploaded
+        async_ring_fail(ring, req->result);
+      }
+    }
+
+    completions[done].token               = req->token;
+    completions[done].result              = req->result;
+    completions[done].number_of_responses = (req->result == NTPCIE_ERROR_SUCCESS) ? req->number_of_responses : 0;
+    ++done;
+
+    ring->head = (ring->head + 1) % NTPCIE_ASYNC_DEPTH;
+    --(ring->count);
+
+    // card is released by readback of results: upload next request at once
+    if (ring->count > 0 && ring->reqs[ring->head].result == NTPCIE_ERROR_SUCCESS)
+    {
+      async_req_upload(dev_handle, &ring->reqs[ring->head]);
     }
-    // wait time is out
-    nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
-    goto ret_result;
-  }
-  else
-  {
-    nn_result = NTPCIE_ERROR_DATA_WRITE;
-    goto ret_result;
   }
 
 ret_result:
+  if (completions_count != NULL && nn_result == NTPCIE_ERROR_SUCCESS)
+  {
+    *completions_count = done;
+  }
   return nn_result;
 }
 
-// transfer KB from NN to struct _neuron in main memory (RAM)
-enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_store(struct nta_dev_handle_t* const dev_handle, struct nn_neuron_t* const _neuron)
+// amount of asynchronous requests submitted to card and not polled yet
+enum ntpcie_nn_error_t ntpcie_async_pending(struct nta_dev_handle_t* const dev_handle, size_t* const count)
+{
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_async_pending_t req = { count };
+    return dev_call(dev_handle, req_exec_async_pending, &req);
+  }
+
+  *count = ((const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->async.count;
+  return NTPCIE_ERROR_SUCCESS;
+}
+
+// wait for event of card (if transport supports it) while request on card isn't done, not longer than its deadline
+enum ntpcie_nn_error_t ntpcie_async_wait_event(struct nta_dev_handle_t* const dev_handle)
+{
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    return dev_call(dev_handle, req_exec_async_wait_event, NULL);
+  }
+
+  const struct ntpcie_async_ring_t* const ring = &((const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->async;
+  if ((ring->count == 0) || (ring->reqs[ring->head].result != NTPCIE_ERROR_SUCCESS))
+  {
+    return NTPCIE_ERROR_SUCCESS;
+  }
+
+  return ntpcie_card_wait_event(dev_handle, ring->reqs[ring->head].deadline_ns);
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_nn_neuron_read(struct nta_dev_handle_t* const dev_handle,
+                                                      const uint16_t ix_neuron,
+                                                      struct nn_neuron_t* const _neuron)
 {
   enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
   uint16_t bytes                   = 0;
 
   union pcie_card_status_t dev_status;
@@ -800,31 +1687,54 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_store(struct nta_dev_handle_t* cons
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_neuron_read_t req = { ix_neuron, _neuron };
+    return dev_call(dev_handle, req_exec_neuron_read, &req);
+  }
   else if (_neuron == NULL)
   {
     nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
     goto ret_result;
   }
+#ifdef NTIAPCIE_DEBUG
+  puts(" *** NTIAPCIE_DEBUG active");
+#else
+  else if (ix_neuron > dev_handle->nn_state.neurons_overall)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
+    goto ret_result;
+  }
+#endif // NTIAPCIE_DEBUG
+
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_NEURON_READ, time_call_ns);
 
   struct pcie_data_upack_t tx_data;
 
   memset(&tx_data, 0, sizeof(tx_data));
 
-  tx_data.opcode = NTPCIE_OC_KBASE_STORE;
+  tx_data.opcode   = NTPCIE_OC_NEURON_READ;
+  tx_data.reg_data = ix_neuron;
 
-  nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
   if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
     goto ret_result;
   }
 
-  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
 
-  // write data to PCIe card
+  // write data to memory
   io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, sizeof(tx_data));
   if (io_result == NTPCIE_IO_ERROR_SUCCESS)
   {
-    for (size_t cnt = 0; cnt < NTPCIE_MAX_CYCLES_STD; ++cnt)
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_UPLOAD);
+
+    const uint64_t deadline_ns = ntpcie_card_deadline_ns(dev_handle);
+    for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
     {
       // read status register
       io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
@@ -836,35 +1746,23 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_store(struct nta_dev_handle_t* cons
       // check data ready and net ready
       if (dev_status.part.results_ready == 1)
       {
+        ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_COMPUTE);
         bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
         // we have bytes to read
         if (bytes > 0)
         {
-          if (bytes != sizeof(*_neuron))
+          if (bytes > sizeof(*_neuron))
           {
             nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
             goto ret_result;
           }
-          // invalidate neuron storage
-          memset(_neuron->comp, 0xFFu, sizeof(_neuron->comp));
           // read data from memory
           io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, _neuron, sizeof(*_neuron));
           if (io_result == NTPCIE_IO_ERROR_SUCCESS)
           {
-            uint64_t cpu_cycles_stop = _cpu_get_tick_count();
-
-            // update performance counters
-            dev_handle->nn_state.cpu_ticks_last_oper   = cpu_cycles_stop - cpu_cycles_start;
-            dev_handle->nn_state.count_loop_wait_ready = cnt;
-
-#ifdef NTIAPCIE_DEBUG
-  puts(" *** NTIAPCIE_DEBUG active");
-  fprintf(stderr, " DEBUG:str: ncr %u; cat %u; aif %u; minif %u\n",
-          _neuron->ncr, _neuron->category,
-          _neuron->aif, _neuron->minif);
-#endif // NTIAPCIE_DEBUG
-
             nn_result = NTPCIE_ERROR_SUCCESS;
+            ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_READBACK);
+            ntpcie_stats_add(dev_handle, NN_STATS_OPER_NEURON_READ);
             goto ret_result;
           }
           else
@@ -880,6 +1778,13 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_store(struct nta_dev_handle_t* cons
           goto ret_result;
         }
       }
+
+      // results are not ready yet: block until card event (if transport supports it)
+      nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+      if (nn_result != NTPCIE_ERROR_SUCCESS)
+      {
+        goto ret_result;
+      }
     }
     // wait time is out
     nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
@@ -895,23 +1800,64 @@ ret_result:
   return nn_result;
 }
 
-// transfer KB from struct _neuron in main memory (RAM) to NN
-enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_load(struct nta_dev_handle_t* const dev_handle,
-                                                  const size_t comps_count,
-                                                  const struct nn_neuron_t* const _neuron)
+// transfer KB from NN to struct _neuron in main memory (RAM)
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_store(struct nta_dev_handle_t* const dev_handle, struct nn_neuron_t* const _neuron)
 {
   enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
-  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
-  uint16_t bytes                   = 0;
-  uint32_t pack_size_bytes         = 0;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
 
-  union pcie_card_status_t dev_status;
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_kbase_store_t req = { _neuron };
+    return dev_call(dev_handle, req_exec_kbase_store, &req);
+  }
+  else if (_neuron == NULL)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_KBASE_STORE, time_call_ns);
+
+  nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
+
+  nn_result = kbase_neuron_store_exec(dev_handle, _neuron);
+
+ret_result:
+  return nn_result;
+}
+
+// transfer KB from struct _neuron in main memory (RAM) to NN
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_load(struct nta_dev_handle_t* const dev_handle,
+                                                  const size_t comps_count,
+                                                  const struct nn_neuron_t* const _neuron)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
 
   if (dev_handle_is_valid(dev_handle) != true)
   {
     nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_kbase_load_t req = { comps_count, _neuron };
+    return dev_call(dev_handle, req_exec_kbase_load, &req);
+  }
   else if (_neuron == NULL)
   {
     nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
@@ -923,133 +1869,224 @@ enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_load(struct nta_dev_handle_t* const
     goto ret_result;
   }
 
-  struct pcie_data_xpack_t tx_data;
-  struct rx_data_load_t    rx_data;
-
-  memset(&tx_data, 0, sizeof(tx_data));
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_KBASE_LOAD, time_call_ns);
 
-  const uint32_t comps_size_bytes = (uint32_t)(sizeof(tx_data.comp[0]) * comps_count);
+  nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
 
-  // build data pack (header) to send PCIe card
-  tx_data.upack.opcode    = NTPCIE_OC_KBASE_LOAD;
-  tx_data.upack.ncr       = _neuron->ncr;
-  tx_data.upack.category  = _neuron->category;
-  tx_data.upack.maxif     = _neuron->aif;
-  tx_data.upack.minif     = _neuron->minif;
-  tx_data.upack.length    = (uint8_t)(comps_count - 1);
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
 
-  // copy components
-  memcpy(&tx_data.comp[0], &_neuron->comp[0], comps_size_bytes);
+  nn_result = kbase_neuron_load_exec(dev_handle, comps_count, _neuron);
 
-#ifdef NTIAPCIE_DEBUG
-  puts(" *** NTIAPCIE_DEBUG active");
-  fprintf(stderr, " DEBUG:ldr: ncr %u; cat %u; aif %u; minif %u\n",
-          tx_data.upack.ncr, tx_data.upack.category,
-          tx_data.upack.maxif, tx_data.upack.minif);
-#endif // NTIAPCIE_DEBUG
+ret_result:
+  return nn_result;
+}
 
-  // calculate size in bytes to send
-  pack_size_bytes = sizeof(tx_data.upack) + comps_size_bytes;
+// transfer whole committed KB from NN to array of neurons in main memory (RAM)
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_store_all(struct nta_dev_handle_t* const dev_handle,
+                                                      struct nn_neuron_t neurons[],
+                                                      const size_t neurons_max,
+                                                      size_t* const neurons_count)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  uint16_t ncount                  = 0;
+  size_t neurons_done              = 0;
 
-  // HACK: workaround: componets count (sizeof *data_pack) MUST be multiple 4 (bytes)
-  uint16_t pack_size_m4_remains = pack_size_bytes & 0x0003u;
-  if (pack_size_m4_remains > 0)
+  if (dev_handle_is_valid(dev_handle) != true)
   {
-    pack_size_bytes += (4 - pack_size_m4_remains);
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
   }
-  // -----------------------------------------------------------------
-
-  if (pack_size_bytes > sizeof(tx_data))
+  else if (dev_call_is_queued(dev_handle))
   {
-    nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
+    // card is served by IO thread: request is executed by it
+    struct req_kbase_store_all_t req = { neurons, neurons_max, neurons_count };
+    return dev_call(dev_handle, req_exec_kbase_store_all, &req);
+  }
+  else if ((neurons_count == NULL) || (neurons == NULL && neurons_max > 0))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
     goto ret_result;
   }
 
-  nn_result = ntpcie_card_wait_ready(dev_handle, NTPCIE_MAX_CYCLES_STD, NULL);
+  *neurons_count = 0;
+
+  // read of NCOUNT sets NR mode of NN: store starts from the first neuron
+  nn_result = ntpcie_nn_register_read(dev_handle, CM_NCOUNT, &ncount);
   if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
     goto ret_result;
   }
 
-  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+  const size_t neurons_committed = (ncount == 0xFFFFu) ? dev_handle->nn_state.neurons_overall : ncount;
+  dev_handle->nn_state.neurons_committed = neurons_committed;
 
-  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, pack_size_bytes);
-  if (io_result == NTPCIE_IO_ERROR_SUCCESS)
+  if (neurons_committed > neurons_max)
   {
-    for (size_t cnt = 0; cnt < NTPCIE_MAX_CYCLES_STD; ++cnt)
-    {
-      // read status register
-      io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
-      if (io_result != NTPCIE_IO_ERROR_SUCCESS)
-      {
-        nn_result = NTPCIE_ERROR_SERV_READ;
-        goto ret_result;
-      }
-      // check data ready and net ready
-      if (dev_status.part.results_ready == 1)
-      {
-        bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
-        // we have needly amount bytes to read
-        if (bytes == sizeof(rx_data))
-        {
-          // read data from PCIe card
-          io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_data, bytes);
-          if (io_result != NTPCIE_IO_ERROR_SUCCESS)
-          {
-            nn_result = NTPCIE_ERROR_DATA_READ;
-            goto ret_result;
-          }
+    // ATT: required size of array is returned
+    *neurons_count = neurons_committed;
+    nn_result      = NTPCIE_ERROR_ARGS_NEURONS_COUNT;
+    goto ret_result;
+  }
 
-          uint64_t cpu_cycles_stop = _cpu_get_tick_count();
+  // read of NCOUNT is timed as register read: phases of store start after it
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_KBASE_STORE, ntpcie_clock_ns());
 
-          // ATT: neurons_restored==neurons_commited (*current* value of NN internal register NCOUNT)
-          if (rx_data.neurons_restored == 0xFFFFu)
-          {
-            if (dev_handle->nn_state.neurons_committed != dev_handle->nn_state.neurons_overall)
-            {
-              dev_handle->nn_state.neurons_committed = dev_handle->nn_state.neurons_overall;
-            }
-          }
-          else
-          {
-            dev_handle->nn_state.neurons_committed = rx_data.neurons_restored;
-          }
+  const uint64_t cpu_cycles_start = _cpu_get_tick_count();
 
-          // update performance counters
-          dev_handle->nn_state.cpu_ticks_last_oper   = cpu_cycles_stop - cpu_cycles_start;
-          dev_handle->nn_state.count_loop_wait_ready = cnt;
+  // datasheet doesn't guarantee "ready" of card right after results of previous neuron are read:
+  // it is checked before every pack (single read of status register when card is ready)
+  for (; neurons_done < neurons_committed; ++neurons_done)
+  {
+    nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      break;
+    }
 
-          nn_result = NTPCIE_ERROR_SUCCESS;
-          goto ret_result;
-        }
-        // we havn't needly amount bytes to read
-        else if (bytes > 0)
-        {
-          nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
-          goto ret_result;
-        }
-        // we havn't bytes to read
-        else
-        {
-          nn_result = NTPCIE_ERROR_NO_DATA_FOR_READ;
-          goto ret_result;
-        }
-      }
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
+
+    nn_result = kbase_neuron_store_exec(dev_handle, &neurons[neurons_done]);
+    if (nn_result == NTPCIE_ERROR_NO_DATA_FOR_READ)
+    {
+      nn_result = NTPCIE_ERROR_KBASE_EOF;
     }
-    // wait time is out
-    nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      break;
+    }
+  }
+
+  dev_handle->nn_state.cpu_ticks_last_oper = _cpu_get_tick_count() - cpu_cycles_start;
+  *neurons_count                           = neurons_done;
+
+ret_result:
+  return nn_result;
+}
+
+// transfer array of neurons from main memory (RAM) to NN, KB of NN is replaced
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_load_all(struct nta_dev_handle_t* const dev_handle,
+                                                     const size_t comps_count,
+                                                     const struct nn_neuron_t neurons[],
+                                                     const size_t neurons_count,
+                                                     size_t* const neurons_done)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  uint16_t ncount                  = 0;
+  size_t ix_neuron                 = 0;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
     goto ret_result;
   }
-  else
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_kbase_load_all_t req = { comps_count, neurons, neurons_count, neurons_done };
+    return dev_call(dev_handle, req_exec_kbase_load_all, &req);
+  }
+  else if (neurons == NULL && neurons_count > 0)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((comps_count < 1) || (comps_count > NN_NEURON_COMPONENTS))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
+    goto ret_result;
+  }
+  else if (neurons_count > dev_handle->nn_state.neurons_overall)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NEURONS_COUNT;
+    goto ret_result;
+  }
+
+  // neurons committed before aren't kept (loaded KB may be smaller than current one)
+  nn_result = ntpcie_nn_reset(dev_handle);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    goto ret_result;
+  }
+
+  // read of NCOUNT sets NR mode of NN: load starts from the first neuron
+  nn_result = ntpcie_nn_register_read(dev_handle, CM_NCOUNT, &ncount);
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
   {
-    nn_result = NTPCIE_ERROR_DATA_WRITE;
     goto ret_result;
   }
 
+  // reset and read of NCOUNT are timed as register operations: phases of load start after them
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_KBASE_LOAD, ntpcie_clock_ns());
+
+  const uint64_t cpu_cycles_start = _cpu_get_tick_count();
+
+  // "ready" of card is checked before every pack (see ntpcie_kbase_store_all)
+  for (; ix_neuron < neurons_count; ++ix_neuron)
+  {
+    nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      break;
+    }
+
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
+
+    nn_result = kbase_neuron_load_exec(dev_handle, comps_count, &neurons[ix_neuron]);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      break;
+    }
+  }
+
+  dev_handle->nn_state.cpu_ticks_last_oper = _cpu_get_tick_count() - cpu_cycles_start;
+
 ret_result:
+  if (neurons_done != NULL)
+  {
+    *neurons_done = ix_neuron;
+  }
   return nn_result;
 }
 
+// ID of knowledge base loaded to card (nn_state is owned by IO thread when card is served by it)
+enum ntpcie_nn_error_t ntpcie_kbase_id_get(struct nta_dev_handle_t* const dev_handle, uint64_t* const kbase_id)
+{
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_kbase_id_get_t req = { kbase_id };
+    return dev_call(dev_handle, req_exec_kbase_id_get, &req);
+  }
+
+  *kbase_id = dev_handle->nn_state.kbase_id;
+  return NTPCIE_ERROR_SUCCESS;
+}
+
+enum ntpcie_nn_error_t ntpcie_kbase_id_set(struct nta_dev_handle_t* const dev_handle, const uint64_t kbase_id)
+{
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_kbase_id_set_t req = { kbase_id };
+    return dev_call(dev_handle, req_exec_kbase_id_set, &req);
+  }
+
+  dev_handle->nn_state.kbase_id = kbase_id;
+  return NTPCIE_ERROR_SUCCESS;
+}
+
 const char* ntpcie_error_text(enum ntpcie_nn_error_t const _ec)
 {
   const char* _e_text;
@@ -1130,9 +2167,1100 @@ const char* ntpcie_error_text(enum ntpcie_nn_error_t const _ec)
     case NTPCIE_ERROR_KBASE_EOF:
       _e_text = "knowledge base: end-of-file";
       break;
+    case NTPCIE_ERROR_ARGS_TRANSPORT:
+      _e_text = "bad argument(s): IO transport unknown or not available";
+      break;
+    case NTPCIE_ERROR_QUEUE:
+      _e_text = "IO thread (submission queue) of card can't be started";
+      break;
+    case NTPCIE_ERROR_BUSY:
+      _e_text = "card is busy: too many requests in flight or asynchronous requests not polled";
+      break;
+    case NTPCIE_ERROR_ARGS_CARDS_COUNT:
+      _e_text = "bad argument(s): cards count not in valid range";
+      break;
+    case NTPCIE_ERROR_ARGS_NEURONS_COUNT:
+      _e_text = "bad argument(s): neurons count not in valid range";
+      break;
+    case NTPCIE_ERROR_KBASE_FILE_IO:
+      _e_text = "knowledge base: file can't be opened, created or mapped";
+      break;
+    case NTPCIE_ERROR_KBASE_FILE_FORMAT:
+      _e_text = "knowledge base: file format, version or CRC mismatch";
+      break;
+    case NTPCIE_ERROR_ARGS_ENTRIES_COUNT:
+      _e_text = "bad argument(s): cache entries count not in valid range";
+      break;
+    case NTPCIE_ERROR_POOL_INCONSISTENT:
+      _e_text = "pool: no card holds consistent replica of knowledge base (reset pool)";
+      break;
+    case NTPCIE_ERROR_ARGS_VECTORS_COUNT:
+      _e_text = "bad argument(s): vectors count not in valid range";
+      break;
+    case NTPCIE_ERROR_ARGS_CPU_KERNEL:
+      _e_text = "bad argument(s): CPU kernel not supported by build or CPU";
+      break;
     case NTPCIE_ERROR_ITEMS_COUNT:
       _e_text = "placeholder";
       break;
   }
   return _e_text;
 }
+
+/// internal functions
+
+// calculate size in bytes to send (header + components)
+static uint32_t xpack_size_calc(const size_t comps_count)
+{
+  uint32_t pack_size_bytes = (uint32_t)(sizeof(struct pcie_data_upack_t) + sizeof(nn_vector_comp_t) * comps_count);
+
+  // HACK: workaround: componets count (sizeof *data_pack) MUST be multiple 4 (bytes)
+  uint16_t pack_size_m4_remains = pack_size_bytes & 0x0003u;
+  if (pack_size_m4_remains > 0)
+  {
+    pack_size_bytes += (4 - pack_size_m4_remains);
+  }
+  // -----------------------------------------------------------------
+
+  return pack_size_bytes;
+}
+
+static uint16_t xpack_classify_resp_size_calc(const size_t number_of_responses)
+{
+  // header (opcode, flags) + responses, rounded up to whole data blocks
+  const size_t resp_size = offsetof(struct rx_data_class_t, data) + number_of_responses * sizeof(struct response_neuron_state_t);
+  return (uint16_t)((resp_size + NTPCIE_DATA_BLOCK_SIZE - 1) & ~(size_t)(NTPCIE_DATA_BLOCK_SIZE - 1));
+}
+
+// context and category are set per vector by caller
+static void xpack_learn_header_build(struct pcie_data_xpack_t* const tx_data,
+                                     const enum nn_dist_eval_t dist_eval,
+                                     const uint16_t maxif,
+                                     const uint16_t minif,
+                                     const size_t comps_count)
+{
+  memset(&tx_data->upack, 0, sizeof(tx_data->upack));
+
+  tx_data->upack.opcode                 = NTPCIE_OC_VECTOR_LEARN;
+  tx_data->upack.config_bits.classifier = NN_CLASSIFIER_RBF;
+  tx_data->upack.config_bits.dummy_c    = 0;
+  tx_data->upack.ncr_bits.dist_eval     = dist_eval;
+  tx_data->upack.maxif                  = maxif;
+  tx_data->upack.minif                  = minif;
+  tx_data->upack.length                 = (uint8_t)(comps_count - 1);
+}
+
+// send (already built and checked) learn pack to PCIe card and read results back
+static enum ntpcie_nn_error_t xpack_learn_exec(struct nta_dev_handle_t* const dev_handle,
+                                               const struct pcie_data_xpack_t* const tx_data,
+                                               const uint32_t pack_size_bytes,
+                                               union rx_data_learn_t* const rx_data)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  uint16_t bytes                   = 0;
+
+  union pcie_card_status_t dev_status;
+
+  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+
+  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, tx_data, pack_size_bytes);
+  if (io_result == NTPCIE_IO_ERROR_SUCCESS)
+  {
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_UPLOAD);
+
+    const uint64_t deadline_ns = ntpcie_card_deadline_ns(dev_handle);
+    for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
+    {
+      // read status register
+      io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
+      if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+      {
+        nn_result = NTPCIE_ERROR_SERV_READ;
+        goto ret_result;
+      }
+      // check data ready and net ready
+      if (dev_status.part.results_ready == 1)
+      {
+        ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_COMPUTE);
+
+        bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
+        // we have needly amount bytes to read
+        if (bytes == sizeof(*rx_data))
+        {
+          // read data from PCIe card
+          io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_data->data, bytes);
+          if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+          {
+            nn_result = NTPCIE_ERROR_DATA_READ;
+            goto ret_result;
+          }
+
+          ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_READBACK);
+
+          uint64_t cpu_cycles_stop = _cpu_get_tick_count();
+
+          if (rx_data->part.ncount == 0xFFFFu)
+          {
+            if (dev_handle->nn_state.neurons_committed != dev_handle->nn_state.neurons_overall)
+            {
+              dev_handle->nn_state.neurons_committed = dev_handle->nn_state.neurons_overall;
+            }
+          }
+          else
+          {
+            dev_handle->nn_state.neurons_committed = rx_data->part.ncount;
+          }
+
+          // update performance counters
+          ++(dev_handle->nn_state.vecs_count_total_learn);
+          dev_handle->nn_state.cpu_ticks_last_oper = cpu_cycles_stop - cpu_cycles_start;
+          dev_handle->nn_state.cpu_ticks_total_learn += dev_handle->nn_state.cpu_ticks_last_oper;
+          dev_handle->nn_state.count_loop_wait_ready = cnt;
+          ntpcie_stats_add(dev_handle, NN_STATS_OPER_LEARN);
+
+          nn_result = NTPCIE_ERROR_SUCCESS;
+          goto ret_result;
+        }
+        // we havn't needly amount bytes to read
+        else if (bytes > 0)
+        {
+          nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
+          goto ret_result;
+        }
+        // we havn't bytes to read
+        else
+        {
+          nn_result = NTPCIE_ERROR_NO_DATA_FOR_READ;
+          goto ret_result;
+        }
+      }
+
+      // results are not ready yet: block until card event (if transport supports it)
+      nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+      if (nn_result != NTPCIE_ERROR_SUCCESS)
+      {
+        goto ret_result;
+      }
+    }
+    // wait time is out
+    nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
+    goto ret_result;
+  }
+  else
+  {
+    nn_result = NTPCIE_ERROR_DATA_WRITE;
+    goto ret_result;
+  }
+
+ret_result:
+  return nn_result;
+}
+
+// outcome of learn from answer of card: committed neurons count is compared with count before learn,
+// category of closest fired neuron (0 - no neuron fired, category 0 is never committed) is compared
+// with category of vector (see nn_learn_outcome_t for what can't be inferred)
+static void learn_result_make(struct nn_learn_result_t* const result,
+                              const union rx_data_learn_t* const rx_data,
+                              const uint16_t category,
+                              const size_t neurons_committed)
+{
+  const uint16_t category_fired = rx_data->part.category & 0x7FFFu;
+
+  result->category = rx_data->part.category;
+  result->ncount   = rx_data->part.ncount;
+  result->outcome  = NN_LEARN_NONE;
+
+  if (category_fired != 0)
+  {
+    result->outcome |= (category_fired == category) ? NN_LEARN_RECOGNIZED : NN_LEARN_SHRUNK;
+  }
+
+  if (rx_data->part.ncount == 0xFFFFu)
+  {
+    result->outcome |= NN_LEARN_FULL;
+  }
+  else if (rx_data->part.ncount > neurons_committed)
+  {
+    result->outcome |= NN_LEARN_COMMITTED;
+  }
+}
+
+static void xpack_classify_header_build(struct pcie_data_xpack_t* const tx_data,
+                                        const enum nn_dist_eval_t dist_eval,
+                                        const uint16_t context,
+                                        const enum nn_classifier_t classifier,
+                                        const size_t number_of_responses,
+                                        const size_t comps_count)
+{
+  memset(&tx_data->upack, 0, sizeof(tx_data->upack));
+
+  tx_data->upack.opcode                 = NTPCIE_OC_VECTOR_CLASSIFY;
+  tx_data->upack.config_bits.classifier = (classifier & 0x01u);
+  tx_data->upack.config_bits.dummy_c    = 0;
+  tx_data->upack.ncr_bits.context       = (context & 0x7Fu);
+  tx_data->upack.ncr_bits.dist_eval     = dist_eval;
+  // MAX resp's
+  tx_data->upack.answers = (uint8_t)(number_of_responses);
+  // set components count
+  tx_data->upack.length = (uint8_t)(comps_count - 1);
+  // unused in this mode
+  tx_data->upack.category = 0;
+  tx_data->upack.maxif    = 0;
+  tx_data->upack.minif    = 0;
+}
+
+// send (already built and checked) classify pack to PCIe card and read results back
+static enum ntpcie_nn_error_t xpack_classify_exec(struct nta_dev_handle_t* const dev_handle,
+                                                  const struct pcie_data_xpack_t* const tx_data,
+                                                  const uint32_t pack_size_bytes,
+                                                  size_t* const number_of_responses,
+                                                  struct response_neuron_state_t resp[],
+                                                  struct nn_classify_status_t* const status)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  uint16_t bytes                   = 0;
+
+  union pcie_card_status_t dev_status;
+
+  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+
+  // write data to memory
+  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, tx_data, pack_size_bytes);
+  if (io_result == NTPCIE_IO_ERROR_SUCCESS)
+  {
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_UPLOAD);
+
+    const uint64_t deadline_ns = ntpcie_card_deadline_ns(dev_handle);
+    for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
+    {
+      // read status register
+      io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
+      if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+      {
+        nn_result = NTPCIE_ERROR_SERV_READ;
+        goto ret_result;
+      }
+      // check data ready and net ready
+      if (dev_status.part.results_ready == 1)
+      {
+        ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_COMPUTE);
+
+        bytes     = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
+        nn_result = xpack_classify_results_read(dev_handle, bytes, number_of_responses, resp, status);
+        if (nn_result == NTPCIE_ERROR_SUCCESS)
+        {
+          ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_READBACK);
+
+          uint64_t cpu_cycles_stop = _cpu_get_tick_count();
+          // update performance counters
+          ++(dev_handle->nn_state.vecs_count_total_class);
+          dev_handle->nn_state.cpu_ticks_last_oper = cpu_cycles_stop - cpu_cycles_start;
+          dev_handle->nn_state.cpu_ticks_total_class += dev_handle->nn_state.cpu_ticks_last_oper;
+          dev_handle->nn_state.count_loop_wait_ready = cnt;
+          ntpcie_stats_add(dev_handle, NN_STATS_OPER_CLASSIFY);
+        }
+        goto ret_result;
+      }
+
+      // results are not ready yet: block until card event (if transport supports it)
+      nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+      if (nn_result != NTPCIE_ERROR_SUCCESS)
+      {
+        goto ret_result;
+      }
+    }
+    // wait time is out
+    nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
+    goto ret_result;
+  }
+  else
+  {
+    nn_result = NTPCIE_ERROR_DATA_WRITE;
+    goto ret_result;
+  }
+
+ret_result:
+  return nn_result;
+}
+
+// read back results of classify pack: card reports results ready, bytes - size of results on card
+static enum ntpcie_nn_error_t xpack_classify_results_read(struct nta_dev_handle_t* const dev_handle,
+                                                          const uint16_t bytes,
+                                                          size_t* const number_of_responses,
+                                                          struct response_neuron_state_t resp[],
+                                                          struct nn_classify_status_t* const status)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  struct rx_data_class_t rx_data;
+
+  // we have needly amount bytes to read
+  if (bytes == 0 || bytes > sizeof(rx_data))
+  {
+    nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
+    goto ret_result;
+  }
+
+  // read first word (opcode, flags, ncount): only responses really returned by card are read after it
+  uint32_t rx_head = 0;
+  io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_head);
+  if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+  {
+    nn_result = NTPCIE_ERROR_DATA_READ;
+    goto ret_result;
+  }
+  memcpy(&rx_data, &rx_head, sizeof(rx_head));
+
+  if (rx_data.opcode == NTPCIE_OC_FAULT)
+  {
+    nn_result = NTPCIE_ERROR_CARD_FAULT;
+    goto ret_result;
+  }
+
+  if (status != NULL)
+  {
+    status->ncount     = rx_data.ncount;
+    status->identified = (rx_data.ID != 0);
+    status->uncertain  = (rx_data.UNC != 0);
+  }
+
+  const size_t answers     = (*number_of_responses > rx_data.ncount) ? rx_data.ncount : *number_of_responses;
+  const uint16_t bytes_req = xpack_classify_resp_size_calc(answers);
+  if (bytes_req > NTPCIE_DATA_BLOCK_SIZE)
+  {
+    io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle,
+                                             NTPCIE_DEVICE_ADDRESS_DATA + NTPCIE_DATA_BLOCK_SIZE,
+                                             (uint8_t*)&rx_data + NTPCIE_DATA_BLOCK_SIZE,
+                                             ((bytes_req < bytes) ? bytes_req : bytes) - NTPCIE_DATA_BLOCK_SIZE);
+    if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+    {
+      nn_result = NTPCIE_ERROR_DATA_READ;
+      goto ret_result;
+    }
+  }
+
+  // make results to return
+  size_t real_number_of_responses = answers;
+  for (size_t ix = 0; ix < real_number_of_responses; ++ix)
+  {
+    uint16_t distance;
+    distance = rx_data.data[ix].distance;
+    if (distance == 0xFFFFu)
+    {
+      real_number_of_responses = ix;
+      break;
+    }
+    resp[ix].id          = rx_data.data[ix].id;
+    resp[ix].category    = rx_data.data[ix].category;
+    resp[ix].degenerated = rx_data.data[ix].degenerated;
+    resp[ix].distance    = distance;
+  }
+  // set final responses count
+  *number_of_responses = real_number_of_responses;
+
+ret_result:
+  return nn_result;
+}
+
+// vectors of batch are taken from strided buffer (data_vectors) or from array of pointers (vectors)
+static enum ntpcie_nn_error_t vectors_classify_batch_exec(struct nta_dev_handle_t* const dev_handle,
+                                                          const enum nn_dist_eval_t dist_eval,
+                                                          const uint16_t context,
+                                                          const enum nn_classifier_t classifier,
+                                                          const size_t comps_count,
+                                                          const size_t vectors_count,
+                                                          const nn_vector_comp_t data_vectors[],
+                                                          const size_t vectors_stride,
+                                                          const nn_vector_comp_t* const vectors[],
+                                                          const size_t number_of_responses,
+                                                          size_t responses_count[],
+                                                          struct response_neuron_state_t resp[],
+                                                          size_t* const vectors_done)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  const uint64_t time_call_ns      = ntpcie_clock_ns();
+  uint32_t pack_size_bytes         = 0;
+  size_t ix_vector                 = 0;
+
+  // ATT: all arguments are checked once for whole batch
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if (dev_call_is_queued(dev_handle))
+  {
+    // card is served by IO thread: request is executed by it
+    struct req_vectors_classify_batch_t req = { dist_eval, context, classifier, comps_count, vectors_count, data_vectors, vectors_stride, vectors, number_of_responses, responses_count, resp, vectors_done };
+    return dev_call(dev_handle, req_exec_vectors_classify_batch, &req);
+  }
+  else if (((data_vectors == NULL) && (vectors == NULL)) || (responses_count == NULL) || (resp == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((comps_count < 1) || (comps_count > NN_NEURON_COMPONENTS))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
+    goto ret_result;
+  }
+  else if ((vectors_stride != 0) && (vectors_stride < comps_count))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_COMPS_COUNT;
+    goto ret_result;
+  }
+  else if ((dist_eval != NN_DIST_EVAL_L1) && (dist_eval != NN_DIST_EVAL_LSUP))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_DIST_EVAL;
+    goto ret_result;
+  }
+  else if ((context < 1) || (context > 127))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CONTEXT;
+    goto ret_result;
+  }
+  else if ((classifier != NN_CLASSIFIER_KNN) && (classifier != NN_CLASSIFIER_RBF))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CLASSIFIER;
+    goto ret_result;
+  }
+  else if ((number_of_responses < 1) || (number_of_responses > NN_MAX_RESP_COUNT))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_RESP_COUNT;
+    goto ret_result;
+  }
+  else if ((vectors_count < 1) || (vectors_count > SIZE_MAX / (number_of_responses * sizeof(*resp))))
+  {
+    // responses of batch (vectors_count * number_of_responses) must fit into address space
+    nn_result = NTPCIE_ERROR_ARGS_VECTORS_COUNT;
+    goto ret_result;
+  }
+
+  if (vectors != NULL)
+  {
+    for (size_t ix = 0; ix < vectors_count; ++ix)
+    {
+      if (vectors[ix] == NULL)
+      {
+        nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+        goto ret_result;
+      }
+    }
+  }
+
+  const size_t stride = (vectors_stride == 0) ? comps_count : vectors_stride;
+
+  ntpcie_phase_start(dev_handle, NN_STATS_OPER_CLASSIFY, time_call_ns);
+
+  struct pcie_data_xpack_t tx_data;
+
+  // header is the same for all vectors in batch, tail (padding) of components area is zeroed once
+  xpack_classify_header_build(&tx_data, dist_eval, context, classifier, number_of_responses, comps_count);
+  memset(&tx_data.comp[0], 0, sizeof(tx_data.comp));
+
+  pack_size_bytes = xpack_size_calc(comps_count);
+
+  if (pack_size_bytes > sizeof(tx_data))
+  {
+    nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
+    goto ret_result;
+  }
+
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  // "ready" of card is checked before every pack (see ntpcie_kbase_store_all)
+  for (ix_vector = 0; ix_vector < vectors_count; ++ix_vector)
+  {
+    const nn_vector_comp_t* const data_vector = (vectors != NULL) ? vectors[ix_vector] : &data_vectors[ix_vector * stride];
+
+    memcpy(&tx_data.comp[0], data_vector, sizeof(tx_data.comp[0]) * comps_count);
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+    nn_result = ntpcie_card_wait_ready(dev_handle, ntpcie_card_deadline_ns(dev_handle), NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      responses_count[ix_vector] = 0;
+      goto ret_result;
+    }
+
+    ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_WAIT_READY);
+
+    responses_count[ix_vector] = number_of_responses;
+    nn_result = xpack_classify_exec(dev_handle, &tx_data, pack_size_bytes,
+                                    &responses_count[ix_vector], &resp[ix_vector * number_of_responses], NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      responses_count[ix_vector] = 0;
+      goto ret_result;
+    }
+  }
+
+ret_result:
+  if (vectors_done != NULL)
+  {
+    *vectors_done = ix_vector;
+  }
+  return nn_result;
+}
+
+// responses of small query are final: more responses are not available from card, or vector is
+// classified without uncertainty and category of no returned neuron is degenerated
+static bool classify_is_decided(const struct nn_classify_status_t* const status,
+                                const size_t number_of_responses,
+                                const struct response_neuron_state_t resp[],
+                                const size_t answers_requested)
+{
+  if ((number_of_responses < answers_requested) || (status->ncount <= number_of_responses))
+  {
+    return true;
+  }
+  else if (status->uncertain)
+  {
+    return false;
+  }
+
+  for (size_t ix = 0; ix < number_of_responses; ++ix)
+  {
+    if (resp[ix].degenerated)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// single neuron of KB from NN: NN must be in NR mode and card must be ready
+static enum ntpcie_nn_error_t kbase_neuron_store_exec(struct nta_dev_handle_t* const dev_handle,
+                                                      struct nn_neuron_t* const _neuron)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  uint16_t bytes                   = 0;
+
+  union pcie_card_status_t dev_status;
+  struct pcie_data_upack_t tx_data;
+
+  memset(&tx_data, 0, sizeof(tx_data));
+
+  tx_data.opcode = NTPCIE_OC_KBASE_STORE;
+
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+
+  // write data to PCIe card
+  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, sizeof(tx_data));
+  if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+  {
+    nn_result = NTPCIE_ERROR_DATA_WRITE;
+    goto ret_result;
+  }
+
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_UPLOAD);
+
+  const uint64_t deadline_ns = ntpcie_card_deadline_ns(dev_handle);
+  for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
+  {
+    // read status register
+    io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
+    if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+    {
+      nn_result = NTPCIE_ERROR_SERV_READ;
+      goto ret_result;
+    }
+    // check data ready and net ready
+    if (dev_status.part.results_ready == 1)
+    {
+      ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_COMPUTE);
+      bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
+      // we have not bytes to read
+      if (bytes == 0)
+      {
+        nn_result = NTPCIE_ERROR_NO_DATA_FOR_READ;
+        goto ret_result;
+      }
+      else if (bytes != sizeof(*_neuron))
+      {
+        nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
+        goto ret_result;
+      }
+
+      // ATT: whole neuron is read, storage isn't invalidated before
+      io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, _neuron, sizeof(*_neuron));
+      if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+      {
+        nn_result = NTPCIE_ERROR_DATA_READ;
+        goto ret_result;
+      }
+
+      uint64_t cpu_cycles_stop = _cpu_get_tick_count();
+      ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_READBACK);
+
+      // update performance counters
+      dev_handle->nn_state.cpu_ticks_last_oper   = cpu_cycles_stop - cpu_cycles_start;
+      dev_handle->nn_state.count_loop_wait_ready = cnt;
+      ntpcie_stats_add(dev_handle, NN_STATS_OPER_KBASE_STORE);
+
+#ifdef NTIAPCIE_DEBUG
+  puts(" *** NTIAPCIE_DEBUG active");
+  fprintf(stderr, " DEBUG:str: ncr %u; cat %u; aif %u; minif %u\n",
+          _neuron->ncr, _neuron->category,
+          _neuron->aif, _neuron->minif);
+#endif // NTIAPCIE_DEBUG
+
+      nn_result = NTPCIE_ERROR_SUCCESS;
+      goto ret_result;
+    }
+
+    // results are not ready yet: block until card event (if transport supports it)
+    nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+  }
+  // wait time is out
+  nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
+  goto ret_result;
+
+ret_result:
+  return nn_result;
+}
+
+// single neuron of KB to NN: NN must be in NR mode and card must be ready
+static enum ntpcie_nn_error_t kbase_neuron_load_exec(struct nta_dev_handle_t* const dev_handle,
+                                                     const size_t comps_count,
+                                                     const struct nn_neuron_t* const _neuron)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  uint16_t bytes                   = 0;
+  uint32_t pack_size_bytes         = 0;
+
+  union pcie_card_status_t dev_status;
+  struct pcie_data_xpack_t tx_data;
+  struct rx_data_load_t    rx_data;
+
+  memset(&tx_data.upack, 0, sizeof(tx_data.upack));
+
+  const uint32_t comps_size_bytes = (uint32_t)(sizeof(tx_data.comp[0]) * comps_count);
+
+  // build data pack (header) to send PCIe card
+  tx_data.upack.opcode    = NTPCIE_OC_KBASE_LOAD;
+  tx_data.upack.ncr       = _neuron->ncr;
+  tx_data.upack.category  = _neuron->category;
+  tx_data.upack.maxif     = _neuron->aif;
+  tx_data.upack.minif     = _neuron->minif;
+  tx_data.upack.length    = (uint8_t)(comps_count - 1);
+
+  // copy components
+  memcpy(&tx_data.comp[0], &_neuron->comp[0], comps_size_bytes);
+
+#ifdef NTIAPCIE_DEBUG
+  puts(" *** NTIAPCIE_DEBUG active");
+  fprintf(stderr, " DEBUG:ldr: ncr %u; cat %u; aif %u; minif %u\n",
+          tx_data.upack.ncr, tx_data.upack.category,
+          tx_data.upack.maxif, tx_data.upack.minif);
+#endif // NTIAPCIE_DEBUG
+
+  // calculate size in bytes to send
+  pack_size_bytes = sizeof(tx_data.upack) + comps_size_bytes;
+
+  // HACK: workaround: componets count (sizeof *data_pack) MUST be multiple 4 (bytes)
+  uint16_t pack_size_m4_remains = pack_size_bytes & 0x0003u;
+  if (pack_size_m4_remains > 0)
+  {
+    // padding bytes are sent too: they must be defined
+    memset((uint8_t*)&tx_data + pack_size_bytes, 0, 4 - pack_size_m4_remains);
+    pack_size_bytes += (4 - pack_size_m4_remains);
+  }
+  // -----------------------------------------------------------------
+
+  if (pack_size_bytes > sizeof(tx_data))
+  {
+    nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
+    goto ret_result;
+  }
+
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_PACK_BUILD);
+
+  dev_cache_clear(dev_handle);
+  uint64_t cpu_cycles_start = _cpu_get_tick_count();
+
+  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &tx_data, pack_size_bytes);
+  if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+  {
+    nn_result = NTPCIE_ERROR_DATA_WRITE;
+    goto ret_result;
+  }
+
+  ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_UPLOAD);
+
+  const uint64_t deadline_ns = ntpcie_card_deadline_ns(dev_handle);
+  for (size_t cnt = 0; ntpcie_card_wait_goes_on(cnt, deadline_ns); ++cnt)
+  {
+    // read status register
+    io_result = ntia_pcie_io_device_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_STATUS, &dev_status.data);
+    if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+    {
+      nn_result = NTPCIE_ERROR_SERV_READ;
+      goto ret_result;
+    }
+    // check data ready and net ready
+    if (dev_status.part.results_ready == 1)
+    {
+      ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_COMPUTE);
+      bytes = dev_status.part.result_size * NTPCIE_DATA_BLOCK_SIZE;
+      // we have needly amount bytes to read
+      if (bytes == sizeof(rx_data))
+      {
+        // read data from PCIe card
+        io_result = ntia_pcie_io_device_mem_rd32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &rx_data, bytes);
+        if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+        {
+          nn_result = NTPCIE_ERROR_DATA_READ;
+          goto ret_result;
+        }
+
+        uint64_t cpu_cycles_stop = _cpu_get_tick_count();
+        ntpcie_phase_mark(dev_handle, NN_STATS_PHASE_READBACK);
+
+        // ATT: neurons_restored==neurons_commited (*current* value of NN internal register NCOUNT)
+        if (rx_data.neurons_restored == 0xFFFFu)
+        {
+          if (dev_handle->nn_state.neurons_committed != dev_handle->nn_state.neurons_overall)
+          {
+            dev_handle->nn_state.neurons_committed = dev_handle->nn_state.neurons_overall;
+          }
+        }
+        else
+        {
+          dev_handle->nn_state.neurons_committed = rx_data.neurons_restored;
+        }
+
+        // update performance counters
+        dev_handle->nn_state.cpu_ticks_last_oper   = cpu_cycles_stop - cpu_cycles_start;
+        dev_handle->nn_state.count_loop_wait_ready = cnt;
+        ntpcie_stats_add(dev_handle, NN_STATS_OPER_KBASE_LOAD);
+
+        nn_result = NTPCIE_ERROR_SUCCESS;
+        goto ret_result;
+      }
+      // we havn't needly amount bytes to read
+      else if (bytes > 0)
+      {
+        nn_result = NTPCIE_ERROR_IO_MEMORY_SIZE_MISMATCH;
+        goto ret_result;
+      }
+      // we havn't bytes to read
+      else
+      {
+        nn_result = NTPCIE_ERROR_NO_DATA_FOR_READ;
+        goto ret_result;
+      }
+    }
+
+    // results are not ready yet: block until card event (if transport supports it)
+    nn_result = ntpcie_card_wait_event(dev_handle, deadline_ns);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+  }
+  // wait time is out
+  nn_result = NTPCIE_ERROR_WAIT_TIMEOUT;
+  goto ret_result;
+
+ret_result:
+  return nn_result;
+}
+
+// drop asynchronous requests (card is reset or closed)
+static void async_ring_clear(struct ntpcie_async_ring_t* const ring)
+{
+  ring->head  = 0;
+  ring->count = 0;
+}
+
+// complete requests after head (not uploaded yet) with error at next poll
+static void async_ring_fail(struct ntpcie_async_ring_t* const ring, const enum ntpcie_nn_error_t nn_result)
+{
+  for (size_t ix = 1; ix < ring->count; ++ix)
+  {
+    ring->reqs[(ring->head + ix) % NTPCIE_ASYNC_DEPTH].result = nn_result;
+  }
+}
+
+// upload pack of asynchronous request to (idle) card, error is reported by completion of request
+static void async_req_upload(struct nta_dev_handle_t* const dev_handle, struct ntpcie_async_req_t* const req)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  req->cpu_ticks_start = _cpu_get_tick_count();
+  req->deadline_ns     = ntpcie_card_deadline_ns(dev_handle);
+
+  io_result = ntia_pcie_io_device_mem_wr32(dev_handle->_iox_handle, NTPCIE_DEVICE_ADDRESS_DATA, &req->tx_data, req->pack_size_bytes);
+  if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+  {
+    req->result = NTPCIE_ERROR_DATA_WRITE;
+  }
+}
+
+// API call from application thread while card is served by IO thread
+static bool dev_call_is_queued(const struct nta_dev_handle_t* const dev_handle)
+{
+  const struct ntpcie_dev_ctx_t* const dev_ctx = (const struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+  return (dev_ctx->queue != NULL && ntpcie_queue_is_io_thread(dev_ctx->queue) != true);
+}
+
+// execute API call by IO thread of card, wait for result
+static enum ntpcie_nn_error_t dev_call(struct nta_dev_handle_t* const dev_handle,
+                                       const ntpcie_req_exec_t exec,
+                                       void* const args)
+{
+  struct ntpcie_dev_ctx_t* const dev_ctx = (struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle;
+  return ntpcie_queue_call(dev_ctx->queue, exec, args);
+}
+
+// knowledge base of card is changed: cached results of classify are dropped
+static void dev_cache_clear(struct nta_dev_handle_t* const dev_handle)
+{
+  ntpcie_cache_clear(((struct ntpcie_dev_ctx_t*)dev_handle->_iox_handle)->cache);
+}
+
+// trampolines: same API call, but executed by IO thread of card
+static enum ntpcie_nn_error_t req_exec_device_cache_start(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_device_cache_start_t* const req = (const struct req_device_cache_start_t*)args;
+  return ntpcie_device_cache_start(dev_handle,
+                                   req->entries_count);
+}
+
+static enum ntpcie_nn_error_t req_exec_device_cache_stop(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  (void)args;
+  return ntpcie_device_cache_stop(dev_handle);
+}
+
+static enum ntpcie_nn_error_t req_exec_device_timeout_set(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_device_time_set_t* const req = (const struct req_device_time_set_t*)args;
+  return ntpcie_device_timeout_set(dev_handle,
+                                   req->time_ns);
+}
+
+static enum ntpcie_nn_error_t req_exec_device_deadline_set(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_device_time_set_t* const req = (const struct req_device_time_set_t*)args;
+  return ntpcie_device_deadline_set(dev_handle,
+                                    req->time_ns);
+}
+
+static enum ntpcie_nn_error_t req_exec_stats_get(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_stats_get_t* const req = (const struct req_stats_get_t*)args;
+  return ntpcie_stats_get(dev_handle,
+                          req->stats);
+}
+
+static enum ntpcie_nn_error_t req_exec_stats_reset(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  (void)args;
+  return ntpcie_stats_reset(dev_handle);
+}
+
+static enum ntpcie_nn_error_t req_exec_device_reset(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  (void)args;
+  return ntpcie_device_reset(dev_handle);
+}
+
+static enum ntpcie_nn_error_t req_exec_nn_reset(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  (void)args;
+  return ntpcie_nn_reset(dev_handle);
+}
+
+static enum ntpcie_nn_error_t req_exec_register_read(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_register_read_t* const req = (const struct req_register_read_t*)args;
+  return ntpcie_nn_register_read(dev_handle,
+                                 req->reg_address,
+                                 req->reg_value);
+}
+
+static enum ntpcie_nn_error_t req_exec_register_write(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_register_write_t* const req = (const struct req_register_write_t*)args;
+  return ntpcie_nn_register_write(dev_handle,
+                                  req->reg_address,
+                                  req->reg_value);
+}
+
+static enum ntpcie_nn_error_t req_exec_vector_learn(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_vector_learn_t* const req = (const struct req_vector_learn_t*)args;
+  return ntpcie_nn_vector_learn_ex(dev_handle,
+                                   req->dist_eval,
+                                   req->context,
+                                   req->category,
+                                   req->maxif,
+                                   req->minif,
+                                   req->comps_count,
+                                   req->data_vector,
+                                   req->result);
+}
+
+static enum ntpcie_nn_error_t req_exec_vectors_learn_batch(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_vectors_learn_batch_t* const req = (const struct req_vectors_learn_batch_t*)args;
+  return ntpcie_nn_vectors_learn_batch(dev_handle,
+                                       req->dist_eval,
+                                       req->maxif,
+                                       req->minif,
+                                       req->comps_count,
+                                       req->records_count,
+                                       req->records,
+                                       req->results,
+                                       req->records_done);
+}
+
+static enum ntpcie_nn_error_t req_exec_vector_classify(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_vector_classify_t* const req = (const struct req_vector_classify_t*)args;
+  return ntpcie_nn_vector_classify_ex(dev_handle,
+                                      req->dist_eval,
+                                      req->context,
+                                      req->classifier,
+                                      req->comps_count,
+                                      req->data_vector,
+                                      req->number_of_responses,
+                                      req->resp,
+                                      req->status);
+}
+
+static enum ntpcie_nn_error_t req_exec_vector_classify_adaptive(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_vector_classify_adaptive_t* const req = (const struct req_vector_classify_adaptive_t*)args;
+  return ntpcie_nn_vector_classify_adaptive(dev_handle,
+                                            req->dist_eval,
+                                            req->context,
+                                            req->classifier,
+                                            req->comps_count,
+                                            req->data_vector,
+                                            req->answers_first,
+                                            req->number_of_responses,
+                                            req->resp,
+                                            req->status);
+}
+
+static enum ntpcie_nn_error_t req_exec_vectors_classify_batch(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_vectors_classify_batch_t* const req = (const struct req_vectors_classify_batch_t*)args;
+  return vectors_classify_batch_exec(dev_handle,
+                                     req->dist_eval,
+                                     req->context,
+                                     req->classifier,
+                                     req->comps_count,
+                                     req->vectors_count,
+                                     req->data_vectors,
+                                     req->vectors_stride,
+                                     req->vectors,
+                                     req->number_of_responses,
+                                     req->responses_count,
+                                     req->resp,
+                                     req->vectors_done);
+}
+
+static enum ntpcie_nn_error_t req_exec_submit_classify(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_submit_classify_t* const req = (const struct req_submit_classify_t*)args;
+  return ntpcie_submit_classify(dev_handle,
+                                req->dist_eval,
+                                req->context,
+                                req->classifier,
+                                req->comps_count,
+                                req->data_vector,
+                                req->number_of_responses,
+                                req->resp,
+                                req->token);
+}
+
+static enum ntpcie_nn_error_t req_exec_poll_completions(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_poll_completions_t* const req = (const struct req_poll_completions_t*)args;
+  return ntpcie_poll_completions(dev_handle,
+                                 req->completions,
+                                 req->completions_max,
+                                 req->completions_count);
+}
+
+static enum ntpcie_nn_error_t req_exec_async_pending(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_async_pending_t* const req = (const struct req_async_pending_t*)args;
+  return ntpcie_async_pending(dev_handle, req->count);
+}
+
+static enum ntpcie_nn_error_t req_exec_async_wait_event(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  (void)args;
+  return ntpcie_async_wait_event(dev_handle);
+}
+
+static enum ntpcie_nn_error_t req_exec_neuron_read(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_neuron_read_t* const req = (const struct req_neuron_read_t*)args;
+  return ntpcie_nn_neuron_read(dev_handle,
+                               req->ix_neuron,
+                               req->_neuron);
+}
+
+static enum ntpcie_nn_error_t req_exec_kbase_store(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_kbase_store_t* const req = (const struct req_kbase_store_t*)args;
+  return ntpcie_kbase_store(dev_handle,
+                            req->_neuron);
+}
+
+static enum ntpcie_nn_error_t req_exec_kbase_load(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_kbase_load_t* const req = (const struct req_kbase_load_t*)args;
+  return ntpcie_kbase_load(dev_handle,
+                           req->comps_count,
+                           req->_neuron);
+}
+
+static enum ntpcie_nn_error_t req_exec_kbase_store_all(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_kbase_store_all_t* const req = (const struct req_kbase_store_all_t*)args;
+  return ntpcie_kbase_store_all(dev_handle,
+                                req->neurons,
+                                req->neurons_max,
+                                req->neurons_count);
+}
+
+static enum ntpcie_nn_error_t req_exec_kbase_load_all(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_kbase_load_all_t* const req = (const struct req_kbase_load_all_t*)args;
+  return ntpcie_kbase_load_all(dev_handle,
+                               req->comps_count,
+                               req->neurons,
+                               req->neurons_count,
+                               req->neurons_done);
+}
+
+static enum ntpcie_nn_error_t req_exec_kbase_id_get(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_kbase_id_get_t* const req = (const struct req_kbase_id_get_t*)args;
+  return ntpcie_kbase_id_get(dev_handle, req->kbase_id);
+}
+
+static enum ntpcie_nn_error_t req_exec_kbase_id_set(struct nta_dev_handle_t* const dev_handle, void* const args)
+{
+  const struct req_kbase_id_set_t* const req = (const struct req_kbase_id_set_t*)args;
+  return ntpcie_kbase_id_set(dev_handle, req->kbase_id);
+}
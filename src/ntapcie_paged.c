@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntia_api_data_types.h"
+#include "ntia_api.h"
+#include "ntia_api_data_types_ll.h"
+#include "ntia_api_ll.h"
+
+#include "ntapcie_int.h"
+
+// paged knowledge base: KB in main PC RAM is larger than card, it is split to card sized partitions;
+// every partition is loaded once per batch (bulk load), whole batch is classified against it and
+// responses of partition are merged to responses of previous partitions; result is the same as
+// result of one card holding whole KB (neuron id is position in whole KB, 1-based)
+
+// max neurons of paged KB: neuron id is 16 bit, 0xFFFF is "no response" marker
+#define PAGED_NEURONS_MAX (0xFFFEu)
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_kbase_paged_classify_batch(struct nta_dev_handle_t* const dev_handle,
+                                                                  const struct nn_neuron_t neurons[],
+                                                                  const size_t neurons_count,
+                                                                  const enum nn_dist_eval_t dist_eval,
+                                                                  const uint16_t context,
+                                                                  const enum nn_classifier_t classifier,
+                                                                  const size_t comps_count,
+                                                                  const size_t vectors_count,
+                                                                  const nn_vector_comp_t data_vectors[],
+                                                                  const size_t vectors_stride,
+                                                                  const size_t number_of_responses,
+                                                                  size_t responses_count[],
+                                                                  struct response_neuron_state_t resp[])
+{
+  enum ntpcie_nn_error_t nn_result          = NTPCIE_ERROR_SUCCESS;
+  struct response_neuron_state_t* part_resp = NULL;
+  size_t* part_count                        = NULL;
+
+  if (dev_handle_is_valid(dev_handle) != true)
+  {
+    nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+    goto ret_result;
+  }
+  else if ((neurons == NULL) || (data_vectors == NULL) || (responses_count == NULL) || (resp == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+  else if ((neurons_count < 1) || (neurons_count > PAGED_NEURONS_MAX))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NEURONS_COUNT;
+    goto ret_result;
+  }
+  else if ((number_of_responses < 1) || (number_of_responses > NN_MAX_RESP_COUNT))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_RESP_COUNT;
+    goto ret_result;
+  }
+  else if ((vectors_count < 1) || (vectors_count > SIZE_MAX / (number_of_responses * sizeof(*part_resp))))
+  {
+    // responses of batch (vectors_count * number_of_responses) must fit into address space
+    nn_result = NTPCIE_ERROR_ARGS_VECTORS_COUNT;
+    goto ret_result;
+  }
+
+  const size_t part_size = dev_handle->nn_state.neurons_overall;
+  if (part_size < 1)
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NEURONS_COUNT;
+    goto ret_result;
+  }
+
+  // merged responses of partitions are limited as responses of one card
+  const size_t resp_max = (number_of_responses < NN_FIRED_NCOUNT_MAX) ? number_of_responses : NN_FIRED_NCOUNT_MAX;
+
+  for (size_t part_first = 0; part_first < neurons_count; part_first += part_size)
+  {
+    const size_t part_neurons = ((neurons_count - part_first) < part_size) ? (neurons_count - part_first) : part_size;
+    const bool part_is_first  = (part_first == 0);
+
+    nn_result = ntpcie_kbase_load_all(dev_handle, comps_count, &neurons[part_first], part_neurons, NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+
+    if (part_is_first)
+    {
+      // responses of first partition are placed to buffer of application directly
+      nn_result = ntpcie_nn_vectors_classify_batch(dev_handle, dist_eval, context, classifier, comps_count,
+                                                   vectors_count, data_vectors, vectors_stride,
+                                                   number_of_responses, responses_count, resp, NULL);
+      if (nn_result != NTPCIE_ERROR_SUCCESS)
+      {
+        goto ret_result;
+      }
+      continue;
+    }
+
+    if (part_resp == NULL)
+    {
+      part_resp  = (struct response_neuron_state_t*)malloc(vectors_count * number_of_responses * sizeof(*part_resp));
+      part_count = (size_t*)malloc(vectors_count * sizeof(*part_count));
+      if ((part_resp == NULL) || (part_count == NULL))
+      {
+        nn_result = NTPCIE_ERROR_UNKNOWN;
+        goto ret_result;
+      }
+    }
+
+    nn_result = ntpcie_nn_vectors_classify_batch(dev_handle, dist_eval, context, classifier, comps_count,
+                                                 vectors_count, data_vectors, vectors_stride,
+                                                 number_of_responses, part_count, part_resp, NULL);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+
+    for (size_t ix_vector = 0; ix_vector < vectors_count; ++ix_vector)
+    {
+      struct response_neuron_state_t* const vector_resp = &resp[ix_vector * number_of_responses];
+      struct response_neuron_state_t* const vector_part = &part_resp[ix_vector * number_of_responses];
+
+      // id of neuron in partition -> id of neuron in whole KB
+      for (size_t ix = 0; ix < part_count[ix_vector]; ++ix)
+      {
+        vector_part[ix].id = (uint16_t)(vector_part[ix].id + part_first);
+      }
+
+      // equal distances: neurons of previous partitions are first (as in chain of one card)
+      const struct response_neuron_state_t* const lists[2] = { vector_resp, vector_part };
+      const size_t counts[2]                               = { responses_count[ix_vector], part_count[ix_vector] };
+      struct response_neuron_state_t merged[NN_MAX_RESP_COUNT];
+
+      responses_count[ix_vector] = nn_resp_merge(lists, counts, 2, merged, NULL, resp_max);
+      memcpy(vector_resp, merged, responses_count[ix_vector] * sizeof(merged[0]));
+    }
+  }
+
+ret_result:
+  free(part_count);
+  free(part_resp);
+  return nn_result;
+}
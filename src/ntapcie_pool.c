@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntia_api_data_types.h"
+#include "ntia_api.h"
+#include "ntia_api_data_types_ll.h"
+#include "ntia_api_ll.h"
+
+#include "ntapcie_int.h"
+#include "ntapcie_thread.h"
+
+// card pool: every card holds replica of the same knowledge base, classify request of any
+// application thread is routed to card with lowest expected wait:
+//     (requests in flight + 1) * recent service time / weight,
+// weight of card is amount of its chips (cards with more chips get proportionally more traffic);
+// card which failed learn holds diverged replica: it is excluded from routing till pool reset
+
+struct pool_card_t
+{
+  struct nta_dev_handle_t* dev_handle;
+  uint64_t                 weight;        ///< chips of card
+  ntpcie_atomic_u32_t      inflight;      ///< requests routed to card and not finished yet
+  ntpcie_atomic_u64_t      service_ns;    ///< smoothed service time of classify (0 - not measured yet)
+  ntpcie_atomic_u32_t      excluded;      ///< replica diverged (learn failed), card is not routed to
+  uint8_t                  _pad[64];      ///< counters of cards are in different cache lines
+};
+
+struct pool_t
+{
+  size_t             cards_count;
+  ntpcie_mutex_t     learn_lock;          ///< learned vectors are applied to all replicas in the same order
+  struct pool_card_t cards[NTIA_PCIE_MAX_CARDS];
+};
+
+/// internal functions
+static struct pool_t* pool_get(const struct nta_card_pool_t* const pool);
+static bool pool_card_select(struct pool_t* const _pool, size_t* const card_ix);
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_pool_init(struct nta_card_pool_t* const pool,
+                                                 struct nta_dev_handle_t* const cards[],
+                                                 const size_t cards_count)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct pool_t* _pool             = NULL;
+  bool queue_started[NTIA_PCIE_MAX_CARDS];
+
+  memset(queue_started, 0, sizeof(queue_started));
+
+  if ((pool == NULL) || (cards == NULL))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_NULL_POINTER;
+    goto ret_result;
+  }
+
+  pool->_pool_handle = NULL;
+
+  if ((cards_count < 1) || (cards_count > NTIA_PCIE_MAX_CARDS))
+  {
+    nn_result = NTPCIE_ERROR_ARGS_CARDS_COUNT;
+    goto ret_result;
+  }
+
+  _pool = (struct pool_t*)calloc(1, sizeof(*_pool));
+  if (_pool == NULL)
+  {
+    nn_result = NTPCIE_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  for (size_t ix = 0; ix < cards_count; ++ix)
+  {
+    struct pool_card_t* const card = &_pool->cards[ix];
+
+    if (dev_handle_is_valid(cards[ix]) != true)
+    {
+      nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+      goto ret_result;
+    }
+
+    // the same card twice (or copy of its handle) would learn every vector twice
+    for (size_t ix_prev = 0; ix_prev < ix; ++ix_prev)
+    {
+      if (cards[ix_prev]->_iox_handle == cards[ix]->_iox_handle)
+      {
+        nn_result = NTPCIE_ERROR_INVALID_HANDLE;
+        goto ret_result;
+      }
+    }
+
+    // requests of many application threads may be routed to the same card
+    // (IO thread started by application is left running if init fails)
+    queue_started[ix] = (((struct ntpcie_dev_ctx_t*)cards[ix]->_iox_handle)->queue == NULL);
+    nn_result         = ntpcie_device_queue_start(cards[ix]);
+    if (nn_result != NTPCIE_ERROR_SUCCESS)
+    {
+      goto ret_result;
+    }
+
+    card->dev_handle = cards[ix];
+    card->weight     = cards[ix]->nn_state.neurons_overall / NN_CHIP_NEURONS;
+    if (card->weight == 0)
+    {
+      card->weight = 1;
+    }
+    ntpcie_atomic_u32_init(&card->inflight, 0);
+    ntpcie_atomic_u64_init(&card->service_ns, 0);
+    ntpcie_atomic_u32_init(&card->excluded, 0);
+  }
+
+  _pool->cards_count = cards_count;
+  ntpcie_mutex_init(&_pool->learn_lock);
+
+  pool->_pool_handle = _pool;
+  _pool              = NULL;
+
+ret_result:
+  if (nn_result != NTPCIE_ERROR_SUCCESS)
+  {
+    for (size_t ix = 0; ix < NTIA_PCIE_MAX_CARDS; ++ix)
+    {
+      if (queue_started[ix])
+      {
+        ntpcie_device_queue_stop(cards[ix]);
+      }
+    }
+  }
+  free(_pool);
+  return nn_result;
+}
+
+// ATT: cards are not closed (and their IO threads are not stopped), they belong to application
+enum ntpcie_nn_error_t NTIA_API ntpcie_pool_deinit(struct nta_card_pool_t* const pool)
+{
+  struct pool_t* const _pool = pool_get(pool);
+  if (_pool == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  ntpcie_mutex_destroy(&_pool->learn_lock);
+  free(_pool);
+  pool->_pool_handle = NULL;
+
+  return NTPCIE_ERROR_SUCCESS;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_pool_nn_reset(struct nta_card_pool_t* const pool)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct pool_t* const _pool       = pool_get(pool);
+
+  if (_pool == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  // replicas are consistent again (empty): cards excluded after failed learn are routed to again
+  ntpcie_mutex_lock(&_pool->learn_lock);
+  for (size_t ix = 0; ix < _pool->cards_count; ++ix)
+  {
+    struct pool_card_t* const card = &_pool->cards[ix];
+
+    const enum ntpcie_nn_error_t card_result = ntpcie_nn_reset(card->dev_handle);
+    ntpcie_atomic_u32_store(&card->excluded, (card_result != NTPCIE_ERROR_SUCCESS) ? 1 : 0,
+                            NTPCIE_MEMORY_ORDER_RELEASE);
+    if ((card_result != NTPCIE_ERROR_SUCCESS) && (nn_result == NTPCIE_ERROR_SUCCESS))
+    {
+      nn_result = card_result;
+    }
+  }
+  ntpcie_mutex_unlock(&_pool->learn_lock);
+
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_pool_vector_learn(struct nta_card_pool_t* const pool,
+                                                         const enum nn_dist_eval_t dist_eval,
+                                                         const uint16_t context,
+                                                         const uint16_t category,
+                                                         const uint16_t maxif,
+                                                         const uint16_t minif,
+                                                         const size_t comps_count,
+                                                         const nn_vector_comp_t data_vector[],
+                                                         size_t* const card_ix)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct pool_t* const _pool       = pool_get(pool);
+  size_t served                    = 0;
+
+  if (_pool == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  // every replica learns the same vectors in the same order: knowledge bases stay identical;
+  // failed card is excluded (its replica diverged), the rest learn the vector anyway
+  ntpcie_mutex_lock(&_pool->learn_lock);
+  for (size_t ix = 0; ix < _pool->cards_count; ++ix)
+  {
+    struct pool_card_t* const card = &_pool->cards[ix];
+
+    if (ntpcie_atomic_u32_load(&card->excluded, NTPCIE_MEMORY_ORDER_ACQUIRE) != 0)
+    {
+      continue;
+    }
+
+    const enum ntpcie_nn_error_t card_result = ntpcie_nn_vector_learn(card->dev_handle, dist_eval, context,
+                                                                      category, maxif, minif,
+                                                                      comps_count, data_vector);
+    if (card_result != NTPCIE_ERROR_SUCCESS)
+    {
+      ntpcie_atomic_u32_store(&card->excluded, 1, NTPCIE_MEMORY_ORDER_RELEASE);
+      if (nn_result == NTPCIE_ERROR_SUCCESS)
+      {
+        nn_result = card_result;
+        if (card_ix != NULL)
+        {
+          *card_ix = ix;
+        }
+      }
+      continue;
+    }
+    ++served;
+  }
+  ntpcie_mutex_unlock(&_pool->learn_lock);
+
+  if ((nn_result == NTPCIE_ERROR_SUCCESS) && (served == 0))
+  {
+    nn_result = NTPCIE_ERROR_POOL_INCONSISTENT;
+  }
+
+  return nn_result;
+}
+
+enum ntpcie_nn_error_t NTIA_API ntpcie_pool_vector_classify(struct nta_card_pool_t* const pool,
+                                                            const enum nn_dist_eval_t dist_eval,
+                                                            const uint16_t context,
+                                                            const enum nn_classifier_t classifier,
+                                                            const size_t comps_count,
+                                                            const nn_vector_comp_t data_vector[],
+                                                            size_t* const number_of_responses,
+                                                            struct response_neuron_state_t resp[],
+                                                            size_t* const card_ix)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+  struct pool_t* const _pool       = pool_get(pool);
+
+  if (_pool == NULL)
+  {
+    return NTPCIE_ERROR_INVALID_HANDLE;
+  }
+
+  size_t ix = 0;
+  if (pool_card_select(_pool, &ix) != true)
+  {
+    return NTPCIE_ERROR_POOL_INCONSISTENT;
+  }
+  struct pool_card_t* const card = &_pool->cards[ix];
+
+  const unsigned queued  = ntpcie_atomic_u32_fetch_add(&card->inflight, 1, NTPCIE_MEMORY_ORDER_RELAXED);
+  const uint64_t t_start = ntpcie_clock_ns();
+
+  nn_result = ntpcie_nn_vector_classify(card->dev_handle, dist_eval, context, classifier,
+                                        comps_count, data_vector, number_of_responses, resp);
+
+  const uint64_t t_stop = ntpcie_clock_ns();
+  ntpcie_atomic_u32_fetch_sub(&card->inflight, 1, NTPCIE_MEMORY_ORDER_RELAXED);
+
+  if (nn_result == NTPCIE_ERROR_SUCCESS)
+  {
+    ntpcie_service_update(&card->service_ns, t_stop - t_start, queued);
+  }
+
+  if (card_ix != NULL)
+  {
+    *card_ix = ix;
+  }
+
+  return nn_result;
+}
+
+/// internal functions
+static struct pool_t* pool_get(const struct nta_card_pool_t* const pool)
+{
+  if (pool == NULL)
+  {
+    return NULL;
+  }
+  return (struct pool_t*)pool->_pool_handle;
+}
+
+// card with min (inflight + 1) * service / weight, compared as cross products (no division);
+// false - every card is excluded
+static bool pool_card_select(struct pool_t* const _pool, size_t* const card_ix)
+{
+  bool found           = false;
+  size_t ix_best       = 0;
+  uint64_t cost_best   = 0;
+  uint64_t weight_best = 1;
+
+  for (size_t ix = 0; ix < _pool->cards_count; ++ix)
+  {
+    struct pool_card_t* const card = &_pool->cards[ix];
+
+    if (ntpcie_atomic_u32_load(&card->excluded, NTPCIE_MEMORY_ORDER_ACQUIRE) != 0)
+    {
+      continue;
+    }
+
+    const uint64_t inflight = ntpcie_atomic_u32_load(&card->inflight, NTPCIE_MEMORY_ORDER_RELAXED);
+    uint64_t service        = ntpcie_atomic_u64_load(&card->service_ns, NTPCIE_MEMORY_ORDER_RELAXED);
+    if (service == 0)
+    {
+      // not measured yet: routing by queue length only
+      service = 1;
+    }
+
+    const uint64_t cost = (inflight + 1) * service;
+    if ((found != true) || (cost * weight_best < cost_best * card->weight))
+    {
+      found       = true;
+      ix_best     = ix;
+      cost_best   = cost;
+      weight_best = card->weight;
+    }
+  }
+
+  *card_ix = ix_best;
+  return found;
+}
+
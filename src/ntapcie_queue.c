@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntia_api_data_types.h"
+
+#include "ntapcie_queue.h"
+#include "ntapcie_thread.h"
+
+// request of synchronous call: submitter is blocked until IO thread executes it
+struct req_sync_t
+{
+  struct ntpcie_req_t req;              ///< must be first
+  ntpcie_mutex_t      lock;
+  ntpcie_cond_t       cond;
+  bool                done;             ///< protected by lock
+  ntpcie_atomic_u32_t released;         ///< IO thread doesn't touch request anymore
+};
+
+// queue served by current thread (NULL - thread isn't IO thread of any card)
+static NTPCIE_THREAD_LOCAL const struct ntpcie_dev_queue_t* queue_current = NULL;
+
+/// internal functions
+static void queue_push(struct ntpcie_dev_queue_t* const queue, struct ntpcie_req_t* const req);
+static struct ntpcie_req_t* queue_pop(struct ntpcie_dev_queue_t* const queue);
+static bool queue_is_empty(const struct ntpcie_dev_queue_t* const queue);
+static void queue_thread(void* arg);
+static void req_sync_complete(struct ntpcie_req_t* const req);
+
+struct ntpcie_dev_queue_t* ntpcie_queue_create(struct nta_dev_handle_t* const dev_handle)
+{
+  struct ntpcie_dev_queue_t* const queue = (struct ntpcie_dev_queue_t*)calloc(1, sizeof(*queue));
+  if (queue == NULL)
+  {
+    goto ret_result;
+  }
+
+  ntpcie_atomic_ptr_init(&queue->_stub._next, NULL);
+  ntpcie_atomic_ptr_init(&queue->_tail, &queue->_stub);
+  queue->_head = &queue->_stub;
+  ntpcie_atomic_u32_init(&queue->_sleeping, false);
+  ntpcie_atomic_u32_init(&queue->_stop, false);
+  ntpcie_mutex_init(&queue->_lock);
+  ntpcie_cond_init(&queue->_wakeup);
+  queue->dev_handle     = dev_handle;
+  queue->exec_submit_ns = 0;
+
+  if (ntpcie_thread_create(&queue->_thread, queue_thread, queue) != true)
+  {
+    ntpcie_cond_destroy(&queue->_wakeup);
+    ntpcie_mutex_destroy(&queue->_lock);
+    free(queue);
+    return NULL;
+  }
+
+ret_result:
+  return queue;
+}
+
+// ATT: requests submitted before destroy are executed, there must be no submitters during destroy
+void ntpcie_queue_destroy(struct ntpcie_dev_queue_t* const queue)
+{
+  if (queue == NULL)
+  {
+    return;
+  }
+
+  ntpcie_atomic_u32_store(&queue->_stop, true, NTPCIE_MEMORY_ORDER_SEQ_CST);
+  ntpcie_mutex_lock(&queue->_lock);
+  ntpcie_cond_signal(&queue->_wakeup);
+  ntpcie_mutex_unlock(&queue->_lock);
+
+  ntpcie_thread_join(&queue->_thread);
+
+  ntpcie_cond_destroy(&queue->_wakeup);
+  ntpcie_mutex_destroy(&queue->_lock);
+  free(queue);
+}
+
+void ntpcie_queue_submit(struct ntpcie_dev_queue_t* const queue, struct ntpcie_req_t* const req)
+{
+  req->time_submit_ns = ntpcie_clock_ns();
+  queue_push(queue, req);
+
+  // IO thread is (going to) sleep: wake it up (lock is taken only in this case)
+  if (ntpcie_atomic_u32_load(&queue->_sleeping, NTPCIE_MEMORY_ORDER_SEQ_CST) != false)
+  {
+    ntpcie_mutex_lock(&queue->_lock);
+    ntpcie_cond_signal(&queue->_wakeup);
+    ntpcie_mutex_unlock(&queue->_lock);
+  }
+}
+
+enum ntpcie_nn_error_t ntpcie_queue_call(struct ntpcie_dev_queue_t* const queue,
+                                         const ntpcie_req_exec_t exec,
+                                         void* const args)
+{
+  struct req_sync_t sync;
+
+  sync.req.exec     = exec;
+  sync.req.args     = args;
+  sync.req.complete = req_sync_complete;
+  sync.req.result   = NTPCIE_ERROR_UNKNOWN;
+  sync.done         = false;
+  ntpcie_atomic_u32_init(&sync.released, false);
+  ntpcie_mutex_init(&sync.lock);
+  ntpcie_cond_init(&sync.cond);
+
+  ntpcie_queue_submit(queue, &sync.req);
+
+  // short operations of card are finished while spinning: no sleep/wakeup cost
+  for (size_t cnt = 0; cnt < NTPCIE_QUEUE_SPIN_COUNT; ++cnt)
+  {
+    if (ntpcie_atomic_u32_load(&sync.released, NTPCIE_MEMORY_ORDER_ACQUIRE) != false)
+    {
+      goto ret_result;
+    }
+    ntpcie_cpu_relax();
+  }
+
+  ntpcie_mutex_lock(&sync.lock);
+  while (sync.done != true)
+  {
+    ntpcie_cond_wait(&sync.cond, &sync.lock);
+  }
+  ntpcie_mutex_unlock(&sync.lock);
+
+  // request is on stack of submitter: wait until IO thread leaves it
+  while (ntpcie_atomic_u32_load(&sync.released, NTPCIE_MEMORY_ORDER_ACQUIRE) == false)
+  {
+    ntpcie_thread_yield();
+  }
+
+ret_result:
+  ntpcie_cond_destroy(&sync.cond);
+  ntpcie_mutex_destroy(&sync.lock);
+  return sync.req.result;
+}
+
+bool ntpcie_queue_is_io_thread(const struct ntpcie_dev_queue_t* const queue)
+{
+  return (queue != NULL && queue_current == queue);
+}
+
+// submit time of request executed by IO thread is given once: API calls nested in request
+// are timed from their own call (0 - taken already or caller is not IO thread of queue)
+uint64_t ntpcie_queue_submit_time_take(struct ntpcie_dev_queue_t* const queue)
+{
+  if (ntpcie_queue_is_io_thread(queue) != true)
+  {
+    return 0;
+  }
+
+  const uint64_t time_submit_ns = queue->exec_submit_ns;
+  queue->exec_submit_ns         = 0;
+  return time_submit_ns;
+}
+
+/// internal functions
+
+static void queue_push(struct ntpcie_dev_queue_t* const queue, struct ntpcie_req_t* const req)
+{
+  ntpcie_atomic_ptr_store(&req->_next, NULL, NTPCIE_MEMORY_ORDER_RELAXED);
+  struct ntpcie_req_t* const prev = ntpcie_atomic_ptr_exchange(&queue->_tail, req, NTPCIE_MEMORY_ORDER_ACQ_REL);
+  // ATT: seq_cst pairs with store of _sleeping by IO thread (no lost wakeup)
+  ntpcie_atomic_ptr_store(&prev->_next, req, NTPCIE_MEMORY_ORDER_SEQ_CST);
+}
+
+// single consumer: called only by IO thread
+static struct ntpcie_req_t* queue_pop(struct ntpcie_dev_queue_t* const queue)
+{
+  struct ntpcie_req_t* head = queue->_head;
+  struct ntpcie_req_t* next = ntpcie_atomic_ptr_load(&head->_next, NTPCIE_MEMORY_ORDER_ACQUIRE);
+
+  if (head == &queue->_stub)
+  {
+    if (next == NULL)
+    {
+      return NULL;
+    }
+    queue->_head = next;
+    head         = next;
+    next         = ntpcie_atomic_ptr_load(&next->_next, NTPCIE_MEMORY_ORDER_ACQUIRE);
+  }
+
+  if (next != NULL)
+  {
+    queue->_head = next;
+    return head;
+  }
+
+  // last request is linked, but producer hasn't finished push of next one yet
+  if (head != ntpcie_atomic_ptr_load(&queue->_tail, NTPCIE_MEMORY_ORDER_ACQUIRE))
+  {
+    return NULL;
+  }
+
+  queue_push(queue, &queue->_stub);
+
+  next = ntpcie_atomic_ptr_load(&head->_next, NTPCIE_MEMORY_ORDER_ACQUIRE);
+  if (next != NULL)
+  {
+    queue->_head = next;
+    return head;
+  }
+  return NULL;
+}
+
+static bool queue_is_empty(const struct ntpcie_dev_queue_t* const queue)
+{
+  const struct ntpcie_req_t* const head = queue->_head;
+  return (head == &queue->_stub && ntpcie_atomic_ptr_load(&head->_next, NTPCIE_MEMORY_ORDER_SEQ_CST) == NULL);
+}
+
+static void queue_thread(void* arg)
+{
+  struct ntpcie_dev_queue_t* const queue = (struct ntpcie_dev_queue_t*)arg;
+
+  queue_current = queue;
+
+  for (;;)
+  {
+    struct ntpcie_req_t* const req = queue_pop(queue);
+    if (req != NULL)
+    {
+      queue->exec_submit_ns = req->time_submit_ns;
+      req->result           = req->exec(queue->dev_handle, req->args);
+      if (req->complete != NULL)
+      {
+        // ATT: request may be released by completion: don't touch it after
+        req->complete(req);
+      }
+      continue;
+    }
+
+    if (ntpcie_atomic_u32_load(&queue->_stop, NTPCIE_MEMORY_ORDER_SEQ_CST) != false && queue_is_empty(queue))
+    {
+      break;
+    }
+
+    ntpcie_mutex_lock(&queue->_lock);
+    ntpcie_atomic_u32_store(&queue->_sleeping, true, NTPCIE_MEMORY_ORDER_SEQ_CST);
+    while (queue_is_empty(queue) && ntpcie_atomic_u32_load(&queue->_stop, NTPCIE_MEMORY_ORDER_SEQ_CST) == false)
+    {
+      ntpcie_cond_wait(&queue->_wakeup, &queue->_lock);
+    }
+    ntpcie_atomic_u32_store(&queue->_sleeping, false, NTPCIE_MEMORY_ORDER_RELAXED);
+    ntpcie_mutex_unlock(&queue->_lock);
+  }
+
+  queue_current = NULL;
+}
+
+static void req_sync_complete(struct ntpcie_req_t* const req)
+{
+  struct req_sync_t* const sync = (struct req_sync_t*)req;
+
+  ntpcie_mutex_lock(&sync->lock);
+  sync->done = true;
+  ntpcie_cond_signal(&sync->cond);
+  ntpcie_mutex_unlock(&sync->lock);
+
+  ntpcie_atomic_u32_store(&sync->released, true, NTPCIE_MEMORY_ORDER_RELEASE);
+}
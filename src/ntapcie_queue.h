@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#pragma once
+#ifndef ONCE_INC_NTAPCIE_QUEUE_H_
+#define ONCE_INC_NTAPCIE_QUEUE_H_
+
+// submission queue of card: lock-free MPSC queue (intrusive, D. Vyukov's algorithm)
+// of requests, executed one by one by dedicated IO thread of card
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ntia_api_data_types.h"
+
+#include "ntapcie_thread.h"
+
+// spin-wait iterations of submitter before it blocks waiting for completion
+#ifndef NTPCIE_QUEUE_SPIN_COUNT
+#define NTPCIE_QUEUE_SPIN_COUNT (1000u)
+#endif // NTPCIE_QUEUE_SPIN_COUNT
+
+#define NTPCIE_QUEUE_CACHE_LINE (64u)
+
+struct ntpcie_req_t;
+
+// operation of request (executed by IO thread of card)
+typedef enum ntpcie_nn_error_t (*ntpcie_req_exec_t)(struct nta_dev_handle_t* const dev_handle, void* const args);
+// notification about finished request (called by IO thread of card, request may be released inside)
+typedef void (*ntpcie_req_complete_t)(struct ntpcie_req_t* const req);
+
+struct ntpcie_req_t
+{
+  ntpcie_atomic_ptr_t          _next;   ///< link of queue (owned by queue)
+  ntpcie_req_exec_t            exec;
+  void*                        args;
+  ntpcie_req_complete_t        complete; ///< may be NULL
+  enum ntpcie_nn_error_t       result;   ///< result of exec (valid on complete)
+  uint64_t                     time_submit_ns; ///< time of submit (set by queue)
+};
+
+struct ntpcie_dev_queue_t
+{
+  ntpcie_atomic_ptr_t          _tail;   ///< producers side
+  uint8_t                      _pad_tail[NTPCIE_QUEUE_CACHE_LINE];
+  struct ntpcie_req_t*         _head;   ///< consumer (IO thread) side
+  struct ntpcie_req_t          _stub;
+  uint8_t                      _pad_head[NTPCIE_QUEUE_CACHE_LINE];
+  ntpcie_atomic_u32_t          _sleeping;
+  ntpcie_atomic_u32_t          _stop;
+  ntpcie_mutex_t               _lock;   ///< protects only sleep/wakeup of IO thread
+  ntpcie_cond_t                _wakeup;
+  struct ntpcie_thread_t       _thread;
+  struct nta_dev_handle_t*     dev_handle;
+  uint64_t                     exec_submit_ns; ///< submit time of request executed now (IO thread only, 0 - taken)
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+struct ntpcie_dev_queue_t* ntpcie_queue_create(struct nta_dev_handle_t* const dev_handle);
+void ntpcie_queue_destroy(struct ntpcie_dev_queue_t* const queue);
+void ntpcie_queue_submit(struct ntpcie_dev_queue_t* const queue, struct ntpcie_req_t* const req);
+enum ntpcie_nn_error_t ntpcie_queue_call(struct ntpcie_dev_queue_t* const queue,
+                                         const ntpcie_req_exec_t exec,
+                                         void* const args);
+bool ntpcie_queue_is_io_thread(const struct ntpcie_dev_queue_t* const queue);
+uint64_t ntpcie_queue_submit_time_take(struct ntpcie_dev_queue_t* const queue);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ONCE_INC_NTAPCIE_QUEUE_H_
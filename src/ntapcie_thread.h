@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#pragma once
+#ifndef ONCE_INC_NTAPCIE_THREAD_H_
+#define ONCE_INC_NTAPCIE_THREAD_H_
+
+// minimal threads/synchronization layer of library: POSIX threads or Win32
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif // _WIN32
+
+// C11 atomics, _Thread_local and _Alignas aren't supported by MSVC: wrappers below are used instead
+#if defined(_MSC_VER) && !defined(__clang__)
+#define NTPCIE_ATOMICS_WIN32 (1)
+#else
+#define NTPCIE_ATOMICS_WIN32 (0)
+#include <stdatomic.h>
+#endif // _MSC_VER
+
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif // __amd64__
+
+#if defined(__GNUC__) || defined(__CLANG__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+typedef void (*ntpcie_thread_fn_t)(void* arg);
+
+#if defined(_WIN32)
+
+typedef SRWLOCK            ntpcie_mutex_t;
+typedef CONDITION_VARIABLE ntpcie_cond_t;
+
+struct ntpcie_thread_t
+{
+  HANDLE             _handle;
+  ntpcie_thread_fn_t _fn;
+  void*              _arg;
+};
+
+static DWORD WINAPI ntpcie_thread_entry(LPVOID param)
+{
+  struct ntpcie_thread_t* const thread = (struct ntpcie_thread_t*)param;
+  thread->_fn(thread->_arg);
+  return 0;
+}
+
+static inline bool ntpcie_thread_create(struct ntpcie_thread_t* const thread, ntpcie_thread_fn_t fn, void* const arg)
+{
+  thread->_fn     = fn;
+  thread->_arg    = arg;
+  thread->_handle = CreateThread(NULL, 0, ntpcie_thread_entry, thread, 0, NULL);
+  return (thread->_handle != NULL);
+}
+
+static inline void ntpcie_thread_join(struct ntpcie_thread_t* const thread)
+{
+  WaitForSingleObject(thread->_handle, INFINITE);
+  CloseHandle(thread->_handle);
+  thread->_handle = NULL;
+}
+
+static inline void ntpcie_thread_yield(void)
+{
+  SwitchToThread();
+}
+
+static inline void ntpcie_mutex_init(ntpcie_mutex_t* const mutex)
+{
+  InitializeSRWLock(mutex);
+}
+
+static inline void ntpcie_mutex_destroy(ntpcie_mutex_t* const mutex)
+{
+  (void)mutex;
+}
+
+static inline void ntpcie_mutex_lock(ntpcie_mutex_t* const mutex)
+{
+  AcquireSRWLockExclusive(mutex);
+}
+
+static inline void ntpcie_mutex_unlock(ntpcie_mutex_t* const mutex)
+{
+  ReleaseSRWLockExclusive(mutex);
+}
+
+static inline void ntpcie_cond_init(ntpcie_cond_t* const cond)
+{
+  InitializeConditionVariable(cond);
+}
+
+static inline void ntpcie_cond_destroy(ntpcie_cond_t* const cond)
+{
+  (void)cond;
+}
+
+static inline void ntpcie_cond_wait(ntpcie_cond_t* const cond, ntpcie_mutex_t* const mutex)
+{
+  SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+static inline void ntpcie_cond_signal(ntpcie_cond_t* const cond)
+{
+  WakeConditionVariable(cond);
+}
+
+static inline void ntpcie_cond_broadcast(ntpcie_cond_t* const cond)
+{
+  WakeAllConditionVariable(cond);
+}
+
+// monotonic time in nanoseconds (origin is undefined, only differences are meaningful)
+static inline uint64_t ntpcie_clock_ns(void)
+{
+  // frequency of counter is fixed at system boot: it is queried once
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER counter;
+  if (freq.QuadPart == 0)
+  {
+    QueryPerformanceFrequency(&freq);
+  }
+  QueryPerformanceCounter(&counter);
+  return (uint64_t)(counter.QuadPart / freq.QuadPart) * 1000000000ull
+       + (uint64_t)(counter.QuadPart % freq.QuadPart) * 1000000000ull / (uint64_t)freq.QuadPart;
+}
+
+#else
+
+typedef pthread_mutex_t ntpcie_mutex_t;
+typedef pthread_cond_t  ntpcie_cond_t;
+
+struct ntpcie_thread_t
+{
+  pthread_t          _handle;
+  ntpcie_thread_fn_t _fn;
+  void*              _arg;
+};
+
+static void* ntpcie_thread_entry(void* param)
+{
+  struct ntpcie_thread_t* const thread = (struct ntpcie_thread_t*)param;
+  thread->_fn(thread->_arg);
+  return NULL;
+}
+
+static inline bool ntpcie_thread_create(struct ntpcie_thread_t* const thread, ntpcie_thread_fn_t fn, void* const arg)
+{
+  thread->_fn  = fn;
+  thread->_arg = arg;
+  return (pthread_create(&thread->_handle, NULL, ntpcie_thread_entry, thread) == 0);
+}
+
+static inline void ntpcie_thread_join(struct ntpcie_thread_t* const thread)
+{
+  pthread_join(thread->_handle, NULL);
+}
+
+static inline void ntpcie_thread_yield(void)
+{
+  sched_yield();
+}
+
+static inline void ntpcie_mutex_init(ntpcie_mutex_t* const mutex)
+{
+  pthread_mutex_init(mutex, NULL);
+}
+
+static inline void ntpcie_mutex_destroy(ntpcie_mutex_t* const mutex)
+{
+  pthread_mutex_destroy(mutex);
+}
+
+static inline void ntpcie_mutex_lock(ntpcie_mutex_t* const mutex)
+{
+  pthread_mutex_lock(mutex);
+}
+
+static inline void ntpcie_mutex_unlock(ntpcie_mutex_t* const mutex)
+{
+  pthread_mutex_unlock(mutex);
+}
+
+static inline void ntpcie_cond_init(ntpcie_cond_t* const cond)
+{
+  pthread_cond_init(cond, NULL);
+}
+
+static inline void ntpcie_cond_destroy(ntpcie_cond_t* const cond)
+{
+  pthread_cond_destroy(cond);
+}
+
+static inline void ntpcie_cond_wait(ntpcie_cond_t* const cond, ntpcie_mutex_t* const mutex)
+{
+  pthread_cond_wait(cond, mutex);
+}
+
+static inline void ntpcie_cond_signal(ntpcie_cond_t* const cond)
+{
+  pthread_cond_signal(cond);
+}
+
+static inline void ntpcie_cond_broadcast(ntpcie_cond_t* const cond)
+{
+  pthread_cond_broadcast(cond);
+}
+
+// monotonic time in nanoseconds (origin is undefined, only differences are meaningful)
+static inline uint64_t ntpcie_clock_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#endif // _WIN32
+
+// hint for CPU inside of spin-wait loops
+static inline void ntpcie_cpu_relax(void)
+{
+#if defined(__amd64__) || defined(__x86_64__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield" ::: "memory");
+#endif // __amd64__
+}
+
+/// atomics: C11 atomics or Interlocked* functions of Win32 (full barrier, order is ignored)
+
+#if NTPCIE_ATOMICS_WIN32
+
+#define NTPCIE_THREAD_LOCAL __declspec(thread)
+#define NTPCIE_ALIGNAS(_n)  __declspec(align(_n))
+
+#define NTPCIE_MEMORY_ORDER_RELAXED (0)
+#define NTPCIE_MEMORY_ORDER_ACQUIRE (1)
+#define NTPCIE_MEMORY_ORDER_RELEASE (2)
+#define NTPCIE_MEMORY_ORDER_ACQ_REL (3)
+#define NTPCIE_MEMORY_ORDER_SEQ_CST (4)
+
+typedef int ntpcie_memory_order_t;
+
+typedef struct
+{
+  volatile LONG _value;
+} ntpcie_atomic_u32_t;
+
+typedef struct
+{
+  volatile LONG64 _value;
+} ntpcie_atomic_u64_t;
+
+typedef struct
+{
+  void* volatile _value;
+} ntpcie_atomic_ptr_t;
+
+static inline void ntpcie_atomic_u32_init(ntpcie_atomic_u32_t* const atom, const uint32_t value)
+{
+  atom->_value = (LONG)value;
+}
+
+static inline uint32_t ntpcie_atomic_u32_load(const ntpcie_atomic_u32_t* const atom, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  MemoryBarrier();
+  const uint32_t value = (uint32_t)atom->_value;
+  MemoryBarrier();
+  return value;
+}
+
+static inline void ntpcie_atomic_u32_store(ntpcie_atomic_u32_t* const atom, const uint32_t value, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  InterlockedExchange(&atom->_value, (LONG)value);
+}
+
+static inline uint32_t ntpcie_atomic_u32_fetch_add(ntpcie_atomic_u32_t* const atom, const uint32_t value, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  return (uint32_t)InterlockedExchangeAdd(&atom->_value, (LONG)value);
+}
+
+static inline uint32_t ntpcie_atomic_u32_fetch_sub(ntpcie_atomic_u32_t* const atom, const uint32_t value, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  return (uint32_t)InterlockedExchangeAdd(&atom->_value, -(LONG)value);
+}
+
+static inline void ntpcie_atomic_u64_init(ntpcie_atomic_u64_t* const atom, const uint64_t value)
+{
+  atom->_value = (LONG64)value;
+}
+
+static inline uint64_t ntpcie_atomic_u64_load(ntpcie_atomic_u64_t* const atom, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  // ATT: plain 64 bit read isn't atomic on 32 bit x86
+  return (uint64_t)InterlockedCompareExchange64(&atom->_value, 0, 0);
+}
+
+static inline void ntpcie_atomic_u64_store(ntpcie_atomic_u64_t* const atom, const uint64_t value, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  InterlockedExchange64(&atom->_value, (LONG64)value);
+}
+
+static inline void ntpcie_atomic_ptr_init(ntpcie_atomic_ptr_t* const atom, void* const value)
+{
+  atom->_value = value;
+}
+
+static inline void* ntpcie_atomic_ptr_load(const ntpcie_atomic_ptr_t* const atom, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  MemoryBarrier();
+  void* const value = atom->_value;
+  MemoryBarrier();
+  return value;
+}
+
+static inline void ntpcie_atomic_ptr_store(ntpcie_atomic_ptr_t* const atom, void* const value, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  InterlockedExchangePointer((PVOID volatile*)&atom->_value, value);
+}
+
+static inline void* ntpcie_atomic_ptr_exchange(ntpcie_atomic_ptr_t* const atom, void* const value, const ntpcie_memory_order_t order)
+{
+  (void)order;
+  return InterlockedExchangePointer((PVOID volatile*)&atom->_value, value);
+}
+
+#else
+
+#define NTPCIE_THREAD_LOCAL _Thread_local
+#define NTPCIE_ALIGNAS(_n)  _Alignas(_n)
+
+#define NTPCIE_MEMORY_ORDER_RELAXED memory_order_relaxed
+#define NTPCIE_MEMORY_ORDER_ACQUIRE memory_order_acquire
+#define NTPCIE_MEMORY_ORDER_RELEASE memory_order_release
+#define NTPCIE_MEMORY_ORDER_ACQ_REL memory_order_acq_rel
+#define NTPCIE_MEMORY_ORDER_SEQ_CST memory_order_seq_cst
+
+typedef memory_order ntpcie_memory_order_t;
+
+typedef struct
+{
+  _Atomic uint32_t _value;
+} ntpcie_atomic_u32_t;
+
+typedef struct
+{
+  _Atomic uint64_t _value;
+} ntpcie_atomic_u64_t;
+
+typedef struct
+{
+  void* _Atomic _value;
+} ntpcie_atomic_ptr_t;
+
+static inline void ntpcie_atomic_u32_init(ntpcie_atomic_u32_t* const atom, const uint32_t value)
+{
+  atomic_init(&atom->_value, value);
+}
+
+static inline uint32_t ntpcie_atomic_u32_load(const ntpcie_atomic_u32_t* const atom, const ntpcie_memory_order_t order)
+{
+  return atomic_load_explicit((_Atomic uint32_t*)&atom->_value, order);
+}
+
+static inline void ntpcie_atomic_u32_store(ntpcie_atomic_u32_t* const atom, const uint32_t value, const ntpcie_memory_order_t order)
+{
+  atomic_store_explicit(&atom->_value, value, order);
+}
+
+static inline uint32_t ntpcie_atomic_u32_fetch_add(ntpcie_atomic_u32_t* const atom, const uint32_t value, const ntpcie_memory_order_t order)
+{
+  return atomic_fetch_add_explicit(&atom->_value, value, order);
+}
+
+static inline uint32_t ntpcie_atomic_u32_fetch_sub(ntpcie_atomic_u32_t* const atom, const uint32_t value, const ntpcie_memory_order_t order)
+{
+  return atomic_fetch_sub_explicit(&atom->_value, value, order);
+}
+
+static inline void ntpcie_atomic_u64_init(ntpcie_atomic_u64_t* const atom, const uint64_t value)
+{
+  atomic_init(&atom->_value, value);
+}
+
+static inline uint64_t ntpcie_atomic_u64_load(ntpcie_atomic_u64_t* const atom, const ntpcie_memory_order_t order)
+{
+  return atomic_load_explicit(&atom->_value, order);
+}
+
+static inline void ntpcie_atomic_u64_store(ntpcie_atomic_u64_t* const atom, const uint64_t value, const ntpcie_memory_order_t order)
+{
+  atomic_store_explicit(&atom->_value, value, order);
+}
+
+static inline void ntpcie_atomic_ptr_init(ntpcie_atomic_ptr_t* const atom, void* const value)
+{
+  atomic_init(&atom->_value, value);
+}
+
+static inline void* ntpcie_atomic_ptr_load(const ntpcie_atomic_ptr_t* const atom, const ntpcie_memory_order_t order)
+{
+  return atomic_load_explicit((void* _Atomic*)&atom->_value, order);
+}
+
+static inline void ntpcie_atomic_ptr_store(ntpcie_atomic_ptr_t* const atom, void* const value, const ntpcie_memory_order_t order)
+{
+  atomic_store_explicit(&atom->_value, value, order);
+}
+
+static inline void* ntpcie_atomic_ptr_exchange(ntpcie_atomic_ptr_t* const atom, void* const value, const ntpcie_memory_order_t order)
+{
+  return atomic_exchange_explicit(&atom->_value, value, order);
+}
+
+#endif // NTPCIE_ATOMICS_WIN32
+
+#if defined(__GNUC__) || defined(__CLANG__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // ONCE_INC_NTAPCIE_THREAD_H_
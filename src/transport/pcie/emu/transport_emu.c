@@ -0,0 +1,887 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "ntia_api_data_types.h"
+#include "ntia_api_data_types_ll.h"
+
+#include "pcie/transport_pcie.h"
+#include "transport_emu.h"
+
+// software model of "NT Adaptive PCIe X NM500" card
+// the model is placed behind the same IO interface as real PCIe transports (see transport_pcie.h),
+// i.e. library talks to emulator using the same opcodes, data packs and status register
+//
+// model of card:
+// - host writes pack (upack header + components) to data area, pack is executed
+//   (synchronously) as soon as all words required by header are written;
+// - results are available for reading from data area (from offset 0), status register
+//   reports results_ready and result_size (in words) until next pack is started;
+// - card is "ready" for next pack as soon as pack is done (unread results are discarded by next
+//   pack); execution may be stretched in time (NTIA_EMU_EXEC_NS) to model slow card.
+//
+// model of NN (RBF/KNN over committed neurons of active context):
+// - distance L1 (sum of |a-b|) or Lsup (max of |a-b|) over the first (length + 1) components;
+// - neuron fires in RBF mode if distance < AIF, in KNN mode all neurons of context fire;
+// - learn: firing neurons with other category shrink AIF to distance (down to MINIF, then
+//   neuron becomes "degenerated"); new neuron is committed if no firing neuron has the same
+//   category, its AIF is distance to the closest neuron of other category (limited by MAXIF);
+//   category 0 is "counter example" (shrink only); ncount 0xFFFF is reported if NN is full;
+// - responses are sorted by distance (and by position in chain for equal distances),
+//   neuron id is position in chain (1-based).
+
+/// emulated system ("hardware")
+static struct uxio_emu_dev_list_t emu_dev_list;
+
+/// transport operations
+static enum ntpcie_io_error_t emu_io_init(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t emu_io_deinit(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t emu_io_device_scan(struct pcie_io_handle_t* const io_handle,
+                                                 struct nta_pcidev_list_t* const devs_list);
+static enum ntpcie_io_error_t emu_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                 const uint16_t pci_bus,
+                                                 const uint16_t pci_slot,
+                                                 const uint16_t pci_func);
+static enum ntpcie_io_error_t emu_io_device_close(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t emu_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data);
+static enum ntpcie_io_error_t emu_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data);
+static enum ntpcie_io_error_t emu_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                     const uint32_t offset,
+                                                     void* const data,
+                                                     const uint32_t data_length);
+static enum ntpcie_io_error_t emu_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                     const uint32_t offset,
+                                                     const void* const data,
+                                                     const uint32_t data_length);
+
+/// internal functions
+static size_t emu_env_value(const char* const _name, const size_t _default, const size_t _max);
+static uint64_t emu_clock_ns(void);
+static struct uxio_emu_card_t* emu_card_get(const struct pcie_io_handle_t* const io_handle);
+static void emu_card_reset(struct uxio_emu_card_t* const card);
+static void emu_card_forget(struct uxio_emu_card_t* const card);
+static void emu_card_result_set(struct uxio_emu_card_t* const card, const size_t result_bytes);
+static uint32_t emu_pack_required_bytes(const struct pcie_data_upack_t* const upack);
+static void emu_pack_exec(struct uxio_emu_card_t* const card);
+
+static void emu_op_reg_read(struct uxio_emu_card_t* const card, const struct pcie_data_upack_t* const upack);
+static void emu_op_reg_write(struct uxio_emu_card_t* const card, const struct pcie_data_upack_t* const upack);
+static void emu_op_vector_learn(struct uxio_emu_card_t* const card, const struct pcie_data_xpack_t* const xpack);
+static void emu_op_vector_classify(struct uxio_emu_card_t* const card, const struct pcie_data_xpack_t* const xpack);
+static void emu_op_kbase_store(struct uxio_emu_card_t* const card);
+static void emu_op_kbase_load(struct uxio_emu_card_t* const card, const struct pcie_data_xpack_t* const xpack);
+static void emu_op_neuron_read(struct uxio_emu_card_t* const card, const struct pcie_data_upack_t* const upack);
+static void emu_op_net_reset(struct uxio_emu_card_t* const card);
+static void emu_op_fault(struct uxio_emu_card_t* const card);
+
+static uint16_t emu_distance(const struct nn_neuron_t* const neuron,
+                             const nn_vector_comp_t* const comps,
+                             const size_t comps_count,
+                             const uint8_t dist_eval);
+
+/// services public functions
+static enum ntpcie_io_error_t emu_io_init(struct pcie_io_handle_t* const io_handle)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  if (io_handle == NULL || io_handle->_iox_handle != NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  const size_t cards_count = emu_env_value("NTIA_EMU_CARDS", NTIA_EMU_CARDS_COUNT, NTIA_PCIE_MAX_CARDS);
+  const size_t chips_count = emu_env_value("NTIA_EMU_CHIPS", NTIA_EMU_CHIPS_COUNT, 0xFFFFu / NTIA_EMU_CHIP_NEURONS);
+
+  // cards which are already opened (by other handle) keep their state
+  for (size_t ix = 0; ix < NTIA_PCIE_MAX_CARDS; ++ix)
+  {
+    struct uxio_emu_card_t* const card = &emu_dev_list.cards[ix];
+    if (card->opened)
+    {
+      continue;
+    }
+    free(card->neurons);
+    memset(card, 0, sizeof(*card));
+    card->neurons_overall = chips_count * NTIA_EMU_CHIP_NEURONS;
+  }
+  emu_dev_list.cards_count = cards_count;
+  emu_dev_list.exec_ns     = emu_env_value("NTIA_EMU_EXEC_NS", NTIA_EMU_EXEC_NS, 1000000000u);
+
+  io_handle->_iox_handle = &emu_dev_list;
+  io_handle->_u32x_space = NTIA_PCIE_INVALID_SP;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t emu_io_deinit(struct pcie_io_handle_t* const io_handle)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  if (io_handle == NULL || io_handle->_iox_handle == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  if (io_handle->_u32x_space != NTIA_PCIE_INVALID_SP)
+  {
+    emu_io_device_close(io_handle);
+  }
+
+  io_handle->_iox_handle = NULL;
+  io_handle->_u32x_space = NTIA_PCIE_INVALID_SP;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t emu_io_device_scan(struct pcie_io_handle_t* const io_handle,
+                                                 struct nta_pcidev_list_t* const devs_list)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  const struct uxio_emu_dev_list_t* const dev_list = io_handle->_iox_handle;
+
+  devs_list->pci_id_vendor = NTIA_PCIE_VENDORID;
+  devs_list->pci_id_device = NTIA_PCIE_DEVICEID;
+  devs_list->devs_count    = 0;
+
+  for (size_t ix = 0; ix < dev_list->cards_count; ++ix)
+  {
+    devs_list->devices[ix].bus  = NTIA_EMU_PCI_BUS;
+    devs_list->devices[ix].slot = (uint16_t)ix;
+    devs_list->devices[ix].func = 0;
+  }
+  devs_list->devs_count = dev_list->cards_count;
+  io_result             = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t emu_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                 const uint16_t pci_bus,
+                                                 const uint16_t pci_slot,
+                                                 const uint16_t pci_func)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  struct uxio_emu_dev_list_t* const dev_list = io_handle->_iox_handle;
+
+  if (pci_bus != NTIA_EMU_PCI_BUS || pci_func != 0 || pci_slot >= dev_list->cards_count)
+  {
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  struct uxio_emu_card_t* const card = &dev_list->cards[pci_slot];
+
+  if (card->neurons == NULL)
+  {
+    card->neurons = (struct nn_neuron_t*)calloc(card->neurons_overall, sizeof(card->neurons[0]));
+    if (card->neurons == NULL)
+    {
+      io_result = NTPCIE_IO_ERROR_UNKNOWN;
+      goto ret_result;
+    }
+    emu_card_reset(card);
+  }
+
+  card->opened           = true;
+  io_handle->_u32x_space = pci_slot;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t emu_io_device_close(struct pcie_io_handle_t* const io_handle)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  struct uxio_emu_card_t* const card = emu_card_get(io_handle);
+  if (card == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  // ATT: state of NN is kept (as on real card) until next init of transport
+  card->opened           = false;
+  io_handle->_u32x_space = NTIA_PCIE_INVALID_SP;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+/// IO functions
+
+static enum ntpcie_io_error_t emu_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data)
+{
+  return emu_io_device_mem_rd32(io_handle, offset, data, sizeof(*data));
+}
+
+static enum ntpcie_io_error_t emu_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data)
+{
+  return emu_io_device_mem_wr32(io_handle, offset, &data, sizeof(data));
+}
+
+static enum ntpcie_io_error_t emu_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                     const uint32_t offset,
+                                                     void* const data,
+                                                     const uint32_t data_length)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  struct uxio_emu_card_t* const card = emu_card_get(io_handle);
+  if (card == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+  else if ((data_length & 0x3) != 0 || (offset & 0x3) != 0)
+  {
+    io_result = NTPCIE_IO_ERROR_DATASIZE_MISMATCH;
+    goto ret_result;
+  }
+
+  uint32_t* data_u32_poiner      = (uint32_t*)data;
+  const uint32_t data_u32_length = (data_length >> 2);
+
+  for (uint32_t ix = 0; ix < data_u32_length; ++ix)
+  {
+    const uint32_t address = offset + ix * NTPCIE_DATA_BLOCK_SIZE;
+    uint32_t value         = 0;
+
+    if (address == NTPCIE_DEVICE_ADDRESS_STATUS)
+    {
+      union pcie_card_status_t status = card->status;
+      if ((card->busy_until_ns != 0) && (emu_clock_ns() < card->busy_until_ns))
+      {
+        // pack is still executed
+        status.part.ready         = 0;
+        status.part.results_ready = 0;
+      }
+      value = status.data;
+    }
+    else if (address == NTPCIE_DEVICE_ADDRESS_NET_INFO)
+    {
+      value = (uint32_t)(card->neurons_overall & 0x0000FFFFu);
+    }
+    else if (address == NTPCIE_DEVICE_ADDRESS_RESET)
+    {
+      value = 0;
+    }
+    else if ((address >> 2) < NTIA_EMU_RX_AREA_WORDS)
+    {
+      value = card->rx_area[address >> 2];
+      if (card->status.part.readed_count < NTIA_EMU_RESULT_SIZE_MAX)
+      {
+        ++card->status.part.readed_count;
+      }
+    }
+    *(data_u32_poiner++) = value;
+  }
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t emu_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                     const uint32_t offset,
+                                                     const void* const data,
+                                                     const uint32_t data_length)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  struct uxio_emu_card_t* const card = emu_card_get(io_handle);
+  if (card == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+  else if ((data_length & 0x3) != 0 || (offset & 0x3) != 0)
+  {
+    io_result = NTPCIE_IO_ERROR_DATASIZE_MISMATCH;
+    goto ret_result;
+  }
+
+  if (offset == NTPCIE_DEVICE_ADDRESS_RESET && data_length == sizeof(uint32_t))
+  {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    if (value == 0xDEADBEEFul)
+    {
+      emu_card_reset(card);
+    }
+    io_result = NTPCIE_IO_ERROR_SUCCESS;
+    goto ret_result;
+  }
+  else if (offset + data_length > sizeof(struct pcie_data_xpack_t))
+  {
+    // only data area is writable
+    io_result = NTPCIE_IO_ERROR_DATA_WRITE;
+    goto ret_result;
+  }
+
+  // new pack is started: previous results are discarded
+  if (card->tx_received == 0)
+  {
+    card->status.part.results_ready = 0;
+    card->status.part.result_size   = 0;
+    card->status.part.readed_count  = 0;
+  }
+
+  memcpy((uint8_t*)card->tx_area + offset, data, data_length);
+  if (offset + data_length > card->tx_received)
+  {
+    card->tx_received = offset + data_length;
+  }
+
+  if (card->tx_received >= sizeof(struct pcie_data_upack_t))
+  {
+    const uint32_t required_bytes = emu_pack_required_bytes((const struct pcie_data_upack_t*)card->tx_area);
+    if (card->tx_received >= required_bytes)
+    {
+      card->status.part.waiting_comps  = 0;
+      card->status.part.required_count = 0;
+      emu_pack_exec(card);
+      card->tx_received   = 0;
+      card->busy_until_ns = (emu_dev_list.exec_ns != 0) ? emu_clock_ns() + emu_dev_list.exec_ns : 0;
+    }
+    else
+    {
+      card->status.part.waiting_comps  = 1;
+      card->status.part.required_count = ((required_bytes - card->tx_received) >> 2) & NTIA_EMU_RESULT_SIZE_MAX;
+    }
+  }
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+const struct pcie_io_ops_t ntia_pcie_io_ops_emu = {
+  .name            = "emu",
+  .init            = emu_io_init,
+  .deinit          = emu_io_deinit,
+  .device_scan     = emu_io_device_scan,
+  .device_open     = emu_io_device_open,
+  .device_close    = emu_io_device_close,
+  .device_rd32     = emu_io_device_rd32,
+  .device_wr32     = emu_io_device_wr32,
+  .device_mem_rd32 = emu_io_device_mem_rd32,
+  .device_mem_wr32 = emu_io_device_mem_wr32,
+};
+
+/// internal functions
+static size_t emu_env_value(const char* const _name, const size_t _default, const size_t _max)
+{
+  const char* const env_value = getenv(_name);
+  if (env_value == NULL)
+  {
+    return _default;
+  }
+
+  const unsigned long value = strtoul(env_value, NULL, 0);
+  if (value < 1 || value > _max)
+  {
+    return _default;
+  }
+  return (size_t)value;
+}
+
+// wall-clock time in nanoseconds (emulator is portable C11, only differences are used)
+static uint64_t emu_clock_ns(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static struct uxio_emu_card_t* emu_card_get(const struct pcie_io_handle_t* const io_handle)
+{
+  if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
+  {
+    return NULL;
+  }
+
+  struct uxio_emu_dev_list_t* const dev_list = io_handle->_iox_handle;
+  if (io_handle->_u32x_space >= dev_list->cards_count || dev_list->cards[io_handle->_u32x_space].neurons == NULL)
+  {
+    return NULL;
+  }
+  return &dev_list->cards[io_handle->_u32x_space];
+}
+
+static void emu_card_forget(struct uxio_emu_card_t* const card)
+{
+  card->neurons_committed = 0;
+  card->kb_cursor         = 0;
+  card->regs[CM_MINIF]    = NN_DEF_MINIF;
+  card->regs[CM_MAXIF]    = NN_DEF_MAXIF;
+  memset(card->neurons, 0, card->neurons_overall * sizeof(card->neurons[0]));
+}
+
+static void emu_card_reset(struct uxio_emu_card_t* const card)
+{
+  memset(card->regs, 0, sizeof(card->regs));
+  card->regs[CM_GCR] = 0x0001u;
+  emu_card_forget(card);
+
+  card->tx_received        = 0;
+  card->busy_until_ns      = 0;
+  card->status.data        = 0;
+  card->status.part.ready  = 1;
+  memset(card->rx_area, 0, sizeof(card->rx_area));
+}
+
+static void emu_card_result_set(struct uxio_emu_card_t* const card, const size_t result_bytes)
+{
+  size_t result_words = (result_bytes + NTPCIE_DATA_BLOCK_SIZE - 1) / NTPCIE_DATA_BLOCK_SIZE;
+  // ATT: result_size field is 7 bits wide
+  if (result_words > NTIA_EMU_RESULT_SIZE_MAX)
+  {
+    result_words = NTIA_EMU_RESULT_SIZE_MAX;
+  }
+
+  card->status.part.ready         = 1;
+  card->status.part.results_ready = 1;
+  card->status.part.result_size   = (uint32_t)result_words;
+  card->status.part.readed_count  = 0;
+}
+
+static uint32_t emu_pack_required_bytes(const struct pcie_data_upack_t* const upack)
+{
+  uint32_t required_bytes = sizeof(*upack);
+
+  switch (upack->opcode)
+  {
+    case NTPCIE_OC_VECTOR_LEARN:
+    case NTPCIE_OC_VECTOR_CLASSIFY:
+    case NTPCIE_OC_KBASE_LOAD:
+      required_bytes += (uint32_t)upack->length + 1;
+      break;
+    default:
+      break;
+  }
+  // packs are always multiple of 4 bytes
+  return (required_bytes + 3u) & ~3u;
+}
+
+static void emu_pack_exec(struct uxio_emu_card_t* const card)
+{
+  const struct pcie_data_xpack_t* const xpack = (const struct pcie_data_xpack_t*)card->tx_area;
+
+  memset(card->rx_area, 0, sizeof(card->rx_area));
+
+  switch (xpack->upack.opcode)
+  {
+    case NTPCIE_OC_REG_READ:
+      emu_op_reg_read(card, &xpack->upack);
+      break;
+    case NTPCIE_OC_REG_WRITE:
+      emu_op_reg_write(card, &xpack->upack);
+      break;
+    case NTPCIE_OC_VECTOR_LEARN:
+      emu_op_vector_learn(card, xpack);
+      break;
+    case NTPCIE_OC_VECTOR_CLASSIFY:
+      emu_op_vector_classify(card, xpack);
+      break;
+    case NTPCIE_OC_KBASE_STORE:
+      emu_op_kbase_store(card);
+      break;
+    case NTPCIE_OC_KBASE_LOAD:
+      emu_op_kbase_load(card, xpack);
+      break;
+    case NTPCIE_OC_NET_RESET:
+      emu_op_net_reset(card);
+      break;
+    case NTPCIE_OC_NEURON_READ:
+      emu_op_neuron_read(card, &xpack->upack);
+      break;
+    default:
+      emu_op_fault(card);
+      break;
+  }
+}
+
+static void emu_op_reg_read(struct uxio_emu_card_t* const card, const struct pcie_data_upack_t* const upack)
+{
+  union nn_int_reg_io_t rx_data;
+  const uint8_t reg_address = upack->reg_address & 0x0Fu;
+
+  rx_data.part.opcode  = upack->opcode;
+  rx_data.part.address = upack->reg_address;
+  if (reg_address == CM_NCOUNT)
+  {
+    // read of NCOUNT switches NN to NR mode: KB store/load starts from the first neuron
+    card->kb_cursor    = 0;
+    rx_data.part.value = (uint16_t)card->neurons_committed;
+  }
+  else
+  {
+    rx_data.part.value = card->regs[reg_address];
+  }
+
+  memcpy(card->rx_area, &rx_data, sizeof(rx_data));
+  emu_card_result_set(card, sizeof(rx_data));
+}
+
+static void emu_op_reg_write(struct uxio_emu_card_t* const card, const struct pcie_data_upack_t* const upack)
+{
+  union nn_int_reg_io_t rx_data;
+  const uint8_t reg_address = upack->reg_address & 0x0Fu;
+
+  switch (reg_address)
+  {
+    case CM_FORGET:
+      emu_card_forget(card);
+      break;
+    case CM_RESETCHAIN:
+      card->kb_cursor = 0;
+      break;
+    default:
+      card->regs[reg_address] = upack->reg_data;
+      break;
+  }
+
+  rx_data.part.opcode  = upack->opcode;
+  rx_data.part.address = upack->reg_address;
+  rx_data.part.value   = upack->reg_data;
+
+  memcpy(card->rx_area, &rx_data, sizeof(rx_data));
+  emu_card_result_set(card, sizeof(rx_data));
+}
+
+static void emu_op_vector_learn(struct uxio_emu_card_t* const card, const struct pcie_data_xpack_t* const xpack)
+{
+  union rx_data_learn_t rx_data;
+
+  const size_t comps_count  = (size_t)xpack->upack.length + 1;
+  const uint8_t context     = xpack->upack.ncr_bits.context;
+  const uint8_t dist_eval   = xpack->upack.ncr_bits.dist_eval;
+  const uint16_t category   = xpack->upack.category & 0x7FFFu;
+  const uint16_t maxif      = xpack->upack.maxif;
+  const uint16_t minif      = xpack->upack.minif;
+
+  bool recognized           = false;
+  uint16_t best_distance    = 0xFFFFu;
+  uint16_t best_category    = 0;
+  uint32_t min_dist_other   = 0xFFFFFFFFul;
+
+  for (size_t ix = 0; ix < card->neurons_committed; ++ix)
+  {
+    struct nn_neuron_t* const neuron = &card->neurons[ix];
+    if ((neuron->ncr & 0x7Fu) != context)
+    {
+      continue;
+    }
+
+    const uint16_t distance        = emu_distance(neuron, xpack->comp, comps_count, dist_eval);
+    const uint16_t neuron_category = neuron->category & 0x7FFFu;
+
+    if (neuron_category != category && distance < min_dist_other)
+    {
+      min_dist_other = distance;
+    }
+
+    if (distance >= neuron->aif)
+    {
+      continue;
+    }
+
+    // neuron fires
+    if (distance < best_distance)
+    {
+      best_distance = distance;
+      best_category = neuron_category;
+    }
+
+    if (neuron_category == category)
+    {
+      recognized = true;
+    }
+    else if (distance <= neuron->minif)
+    {
+      neuron->aif = neuron->minif;
+      neuron->category |= 0x8000u;
+    }
+    else
+    {
+      neuron->aif = distance;
+    }
+  }
+
+  bool nn_is_full = false;
+  if (category != 0 && recognized == false)
+  {
+    if (card->neurons_committed < card->neurons_overall)
+    {
+      struct nn_neuron_t* const neuron = &card->neurons[card->neurons_committed];
+
+      memset(neuron, 0, sizeof(*neuron));
+      neuron->ncr      = (uint8_t)((context & 0x7Fu) | (dist_eval << 7));
+      neuron->category = category;
+      neuron->minif    = minif;
+      memcpy(neuron->comp, xpack->comp, comps_count * sizeof(neuron->comp[0]));
+
+      if (min_dist_other >= maxif)
+      {
+        neuron->aif = maxif;
+      }
+      else if (min_dist_other <= minif)
+      {
+        neuron->aif = minif;
+        neuron->category |= 0x8000u;
+      }
+      else
+      {
+        neuron->aif = (uint16_t)min_dist_other;
+      }
+
+      ++card->neurons_committed;
+    }
+    else
+    {
+      nn_is_full = true;
+    }
+  }
+
+  rx_data.data          = 0;
+  rx_data.part.opcode   = xpack->upack.opcode;
+  rx_data.part.category = best_category;
+  rx_data.part.ncount   = (nn_is_full) ? 0xFFFFu : (uint16_t)card->neurons_committed;
+
+  memcpy(card->rx_area, &rx_data, sizeof(rx_data));
+  emu_card_result_set(card, sizeof(rx_data));
+}
+
+static void emu_op_vector_classify(struct uxio_emu_card_t* const card, const struct pcie_data_xpack_t* const xpack)
+{
+  struct rx_data_class_t* const rx_data = (struct rx_data_class_t*)card->rx_area;
+
+  const size_t comps_count  = (size_t)xpack->upack.length + 1;
+  const uint8_t context     = xpack->upack.ncr_bits.context;
+  const uint8_t dist_eval   = xpack->upack.ncr_bits.dist_eval;
+  const bool knn            = (xpack->upack.config_bits.classifier == NN_CLASSIFIER_KNN);
+  size_t answers            = xpack->upack.answers;
+
+  if (answers > NN_MAX_RESP_COUNT)
+  {
+    answers = NN_MAX_RESP_COUNT;
+  }
+
+  size_t fired_count        = 0;
+  size_t resp_count         = 0;
+  bool uncertain            = false;
+  uint16_t rbf_category     = 0xFFFFu;
+
+  for (size_t ix = 0; ix < card->neurons_committed; ++ix)
+  {
+    const struct nn_neuron_t* const neuron = &card->neurons[ix];
+    if ((neuron->ncr & 0x7Fu) != context)
+    {
+      continue;
+    }
+
+    const uint16_t distance = emu_distance(neuron, xpack->comp, comps_count, dist_eval);
+    const bool rbf_fired    = (distance < neuron->aif);
+
+    if (rbf_fired)
+    {
+      if (rbf_category == 0xFFFFu)
+      {
+        rbf_category = neuron->category & 0x7FFFu;
+      }
+      else if (rbf_category != (neuron->category & 0x7FFFu))
+      {
+        uncertain = true;
+      }
+    }
+
+    if (rbf_fired == false && knn == false)
+    {
+      continue;
+    }
+
+    ++fired_count;
+
+    // insert response to list sorted by distance (neurons are visited in chain order)
+    size_t pos = resp_count;
+    while (pos > 0 && rx_data->data[pos - 1].distance > distance)
+    {
+      --pos;
+    }
+    if (pos >= answers)
+    {
+      continue;
+    }
+    if (resp_count < answers)
+    {
+      ++resp_count;
+    }
+    memmove(&rx_data->data[pos + 1], &rx_data->data[pos], (resp_count - 1 - pos) * sizeof(rx_data->data[0]));
+
+    rx_data->data[pos].distance    = distance;
+    rx_data->data[pos].category    = neuron->category & 0x7FFFu;
+    rx_data->data[pos].degenerated = (neuron->category >> 15) & 0x01u;
+    rx_data->data[pos].id          = (uint16_t)(ix + 1);
+  }
+
+  // terminate list of responses
+  for (size_t ix = resp_count; ix < answers; ++ix)
+  {
+    rx_data->data[ix].distance    = 0xFFFFu;
+    rx_data->data[ix].category    = 0x7FFFu;
+    rx_data->data[ix].degenerated = 1;
+    rx_data->data[ix].id          = 0xFFFFu;
+  }
+
+  rx_data->opcode = xpack->upack.opcode;
+  rx_data->ncount = (fired_count > NN_FIRED_NCOUNT_MAX) ? NN_FIRED_NCOUNT_MAX : (uint8_t)fired_count;
+  rx_data->UNC    = (uncertain) ? 1 : 0;
+  rx_data->ID     = (rbf_category != 0xFFFFu && uncertain == false) ? 1 : 0;
+
+  emu_card_result_set(card, offsetof(struct rx_data_class_t, data) + answers * sizeof(rx_data->data[0]));
+}
+
+static void emu_op_kbase_store(struct uxio_emu_card_t* const card)
+{
+  if (card->kb_cursor >= card->neurons_committed)
+  {
+    // end of KB: no data to read
+    emu_card_result_set(card, 0);
+    return;
+  }
+
+  struct nn_neuron_t* const rx_data = (struct nn_neuron_t*)card->rx_area;
+
+  *rx_data        = card->neurons[card->kb_cursor];
+  rx_data->opcode = NTPCIE_OC_KBASE_STORE;
+  ++card->kb_cursor;
+
+  emu_card_result_set(card, sizeof(*rx_data));
+}
+
+static void emu_op_kbase_load(struct uxio_emu_card_t* const card, const struct pcie_data_xpack_t* const xpack)
+{
+  struct rx_data_load_t rx_data;
+
+  if (card->kb_cursor < card->neurons_overall)
+  {
+    struct nn_neuron_t* const neuron = &card->neurons[card->kb_cursor];
+    const size_t comps_count         = (size_t)xpack->upack.length + 1;
+
+    memset(neuron, 0, sizeof(*neuron));
+    neuron->ncr      = xpack->upack.ncr;
+    neuron->category = xpack->upack.category;
+    neuron->aif      = xpack->upack.maxif;
+    neuron->minif    = xpack->upack.minif;
+    memcpy(neuron->comp, xpack->comp, comps_count * sizeof(neuron->comp[0]));
+
+    ++card->kb_cursor;
+    if (card->kb_cursor > card->neurons_committed)
+    {
+      card->neurons_committed = card->kb_cursor;
+    }
+    rx_data.neurons_restored = (uint16_t)card->neurons_committed;
+  }
+  else
+  {
+    rx_data.neurons_restored = 0xFFFFu;
+  }
+
+  rx_data.opcode = xpack->upack.opcode;
+  rx_data.dummy0 = 0;
+
+  memcpy(card->rx_area, &rx_data, sizeof(rx_data));
+  emu_card_result_set(card, sizeof(rx_data));
+}
+
+static void emu_op_neuron_read(struct uxio_emu_card_t* const card, const struct pcie_data_upack_t* const upack)
+{
+  struct nn_neuron_t* const rx_data = (struct nn_neuron_t*)card->rx_area;
+
+  if (upack->reg_data < card->neurons_committed)
+  {
+    *rx_data = card->neurons[upack->reg_data];
+  }
+  rx_data->opcode = upack->opcode;
+
+  emu_card_result_set(card, sizeof(*rx_data));
+}
+
+static void emu_op_net_reset(struct uxio_emu_card_t* const card)
+{
+  emu_card_forget(card);
+
+  card->rx_area[0] = NTPCIE_OC_NET_RESET;
+  emu_card_result_set(card, sizeof(card->rx_area[0]));
+}
+
+static void emu_op_fault(struct uxio_emu_card_t* const card)
+{
+  card->rx_area[0] = NTPCIE_OC_FAULT;
+  emu_card_result_set(card, sizeof(card->rx_area[0]));
+}
+
+static uint16_t emu_distance(const struct nn_neuron_t* const neuron,
+                             const nn_vector_comp_t* const comps,
+                             const size_t comps_count,
+                             const uint8_t dist_eval)
+{
+  uint32_t distance = 0;
+
+  if (dist_eval == NN_DIST_EVAL_LSUP)
+  {
+    for (size_t ix = 0; ix < comps_count; ++ix)
+    {
+      const uint32_t delta = (neuron->comp[ix] > comps[ix]) ? (uint32_t)(neuron->comp[ix] - comps[ix]) : (uint32_t)(comps[ix] - neuron->comp[ix]);
+      if (delta > distance)
+      {
+        distance = delta;
+      }
+    }
+  }
+  else
+  {
+    for (size_t ix = 0; ix < comps_count; ++ix)
+    {
+      distance += (neuron->comp[ix] > comps[ix]) ? (uint32_t)(neuron->comp[ix] - comps[ix]) : (uint32_t)(comps[ix] - neuron->comp[ix]);
+    }
+  }
+
+  // ATT: 0xFFFF is reserved as "no response" marker
+  return (distance >= 0xFFFFu) ? 0xFFFEu : (uint16_t)distance;
+}
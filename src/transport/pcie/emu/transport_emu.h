@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#pragma once
+#ifndef ONCE_INC_TRANSPORT_EMU_H_
+#define ONCE_INC_TRANSPORT_EMU_H_
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "sorry, tested only for LITTLE_ENDIAN"
+#endif // __BYTE_ORDER__
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ntia_api_data_types.h"
+#include "ntia_api_data_types_ll.h"
+
+#include "pcie/transport_pcie.h"
+
+// default configuration of emulated system (may be overridden by environment variables
+// NTIA_EMU_CARDS, NTIA_EMU_CHIPS and NTIA_EMU_EXEC_NS at ntia_pcie_io_init() time)
+#ifndef NTIA_EMU_CARDS_COUNT
+#define NTIA_EMU_CARDS_COUNT      (1)
+#endif // NTIA_EMU_CARDS_COUNT
+
+#ifndef NTIA_EMU_CHIPS_COUNT
+#define NTIA_EMU_CHIPS_COUNT      (4)
+#endif // NTIA_EMU_CHIPS_COUNT
+
+// time of pack execution (card isn't ready and has no results meanwhile), 0 - pack is done at once
+#ifndef NTIA_EMU_EXEC_NS
+#define NTIA_EMU_EXEC_NS          (0)
+#endif // NTIA_EMU_EXEC_NS
+
+// amount of neurons in single NM500 chip
+#define NTIA_EMU_CHIP_NEURONS     (576)
+
+// PCI bus number reported for emulated cards
+#define NTIA_EMU_PCI_BUS          (0x00EEu)
+
+// size of data area (words) available for reading results
+#define NTIA_EMU_RX_AREA_WORDS    (sizeof(struct rx_data_class_t) / NTPCIE_DATA_BLOCK_SIZE)
+// max value of result_size field in status register (7 bits)
+#define NTIA_EMU_RESULT_SIZE_MAX  (0x7Fu)
+
+// state of single emulated card
+struct uxio_emu_card_t
+{
+  bool                     opened;
+  size_t                   neurons_overall;
+  size_t                   neurons_committed;
+  size_t                   kb_cursor;                                    ///< index of neuron for next KBASE_STORE/LOAD
+  uint16_t                 regs[16];                                     ///< NN internal registers (enum nn_int_register_t)
+  struct nn_neuron_t*      neurons;                                      ///< chain of neurons (committed first)
+  union pcie_card_status_t status;
+  uint32_t                 tx_received;                                  ///< bytes of current pack written by host
+  uint64_t                 busy_until_ns;                                ///< pack is executed till this time (0 - idle)
+  uint32_t                 tx_area[NTIA_PCIE_MEM_SIZE / sizeof(uint32_t)];
+  uint32_t                 rx_area[NTIA_EMU_RX_AREA_WORDS];
+};
+
+struct uxio_emu_dev_list_t
+{
+  size_t                  cards_count;
+  uint64_t                exec_ns;                                       ///< time of pack execution
+  struct uxio_emu_card_t  cards[NTIA_PCIE_MAX_CARDS];
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ONCE_INC_TRANSPORT_EMU_H_
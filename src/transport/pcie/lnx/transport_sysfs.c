@@ -26,7 +26,11 @@
 #include <dirent.h>
 #include <fcntl.h>
 
+#include "ntia_api_data_types.h"
+#include "ntia_api_data_types_ll.h"
+
 #include "pcie/transport_pcie.h"
+#include "pcie/transport_mmio.h"
 #include "transport_sysfs.h"
 
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -45,7 +49,26 @@
 static const char dirbase_name_pci_devices[] = "/sys/bus/pci/devices/";
 static const char devmem_sys_fn_template[] = "/sys/bus/pci/devices/0000:%02hx:%02hx.%1hx/%s";
 
-static struct uxio_dev_handle_t uio_dev_handle;
+/// transport operations
+static enum ntpcie_io_error_t sysfs_io_init(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t sysfs_io_deinit(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t sysfs_io_device_scan(struct pcie_io_handle_t  * const io_handle,
+                                                   struct nta_pcidev_list_t * const devs_list);
+static enum ntpcie_io_error_t sysfs_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                   const uint16_t pci_bus,
+                                                   const uint16_t pci_slot,
+                                                   const uint16_t pci_func);
+static enum ntpcie_io_error_t sysfs_io_device_close(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t sysfs_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data);
+static enum ntpcie_io_error_t sysfs_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data);
+static enum ntpcie_io_error_t sysfs_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                       const uint32_t offset,
+                                                       void* const data,
+                                                       const uint32_t data_length);
+static enum ntpcie_io_error_t sysfs_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                       const uint32_t offset,
+                                                       const void* const data,
+                                                       const uint32_t data_length);
 
 /// internal functions
 static uint16_t read_pci_id(const char * const _file_name);
@@ -53,7 +76,7 @@ static void uio_dev_handle_reset(struct uxio_dev_handle_t* const uio);
 static void uio_dev_handle_close_all(struct uxio_dev_handle_t* const uio);
 
 /// services public functions
-enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handle)
+static enum ntpcie_io_error_t sysfs_io_init(struct pcie_io_handle_t* const io_handle)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
   if (io_handle == NULL || io_handle->_iox_handle != NULL)
@@ -62,8 +85,16 @@ enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handl
     goto ret_result;
   }
 
-  uio_dev_handle_reset(&uio_dev_handle);
-  io_handle->_iox_handle = &uio_dev_handle;
+  // every init has own state: several cards may be used by process at the same time
+  struct uxio_dev_handle_t* const uio = (struct uxio_dev_handle_t*)malloc(sizeof(*uio));
+  if (uio == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  uio_dev_handle_reset(uio);
+  io_handle->_iox_handle = uio;
   io_handle->_u32x_space = 0xFFFFFFFFu;
   io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -71,7 +102,7 @@ ret_result:
   return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_deinit(struct pcie_io_handle_t* const io_handle)
+static enum ntpcie_io_error_t sysfs_io_deinit(struct pcie_io_handle_t* const io_handle)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
   if (io_handle == NULL || io_handle->_iox_handle == NULL)
@@ -82,6 +113,7 @@ enum ntpcie_io_error_t ntia_pcie_io_deinit(struct pcie_io_handle_t* const io_han
 
   uio_dev_handle_close_all(io_handle->_iox_handle);
   uio_dev_handle_reset(io_handle->_iox_handle);
+  free(io_handle->_iox_handle);
   io_handle->_iox_handle = NULL;
   io_handle->_u32x_space = 0xFFFFFFFFu;
   io_result = NTPCIE_IO_ERROR_SUCCESS;
@@ -90,8 +122,8 @@ ret_result:
   return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_scan(struct pcie_io_handle_t  * const io_handle,
-                                                struct nta_pcidev_list_t * const devs_list)
+static enum ntpcie_io_error_t sysfs_io_device_scan(struct pcie_io_handle_t  * const io_handle,
+                                                   struct nta_pcidev_list_t * const devs_list)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -144,10 +176,10 @@ ret_result:
   return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_open(struct pcie_io_handle_t* const io_handle,
-                                                const uint16_t pci_bus,
-                                                const uint16_t pci_slot,
-                                                const uint16_t pci_func)
+static enum ntpcie_io_error_t sysfs_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                   const uint16_t pci_bus,
+                                                   const uint16_t pci_slot,
+                                                   const uint16_t pci_func)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
   int uio_dev_file_handle = (-1);
@@ -185,6 +217,29 @@ enum ntpcie_io_error_t ntia_pcie_io_device_open(struct pcie_io_handle_t* const i
     goto ret_close_file;
   }
 
+  uio->maps[map_ix].iomem_wc = MAP_FAILED;
+  if ((io_handle->io_flags & NTIA_PCIE_IO_FLAG_WRITE_COMBINING) != 0)
+  {
+    // ATT: resource0_wc exists only for prefetchable BAR, UC mapping is used if it is absent
+    snprintf(devmem_sys_fn, 256, devmem_sys_fn_template, pci_bus, pci_slot, pci_func, "resource0_wc");
+    const int wc_file_handle = open(devmem_sys_fn, O_RDWR);
+    if (wc_file_handle == (-1))
+    {
+      perror("open device memory file (resource0_wc) failed, write-combining is not used");
+    }
+    else
+    {
+      uio->maps[map_ix].iomem_wc = mmap(NULL, uio->maps[map_ix].size,
+                                        PROT_READ | PROT_WRITE, MAP_SHARED,
+                                        wc_file_handle, 0);
+      if (uio->maps[map_ix].iomem_wc == MAP_FAILED)
+      {
+        perror("mmap (write-combining) failed, write-combining is not used");
+      }
+      close(wc_file_handle);
+    }
+  }
+
   uio->maps_active++;
   io_handle->_u32x_space = map_ix;
   io_result              = NTPCIE_IO_ERROR_SUCCESS;
@@ -196,7 +251,7 @@ ret_result:
   return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_close(struct pcie_io_handle_t* const io_handle)
+static enum ntpcie_io_error_t sysfs_io_device_close(struct pcie_io_handle_t* const io_handle)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
   if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == 0xFFFFFFFFu)
@@ -214,6 +269,11 @@ enum ntpcie_io_error_t ntia_pcie_io_device_close(struct pcie_io_handle_t* const
     goto ret_result;
   }
 
+  if (uio->maps[map_ix].iomem_wc != MAP_FAILED)
+  {
+    munmap(uio->maps[map_ix].iomem_wc, uio->maps[map_ix].size);
+    uio->maps[map_ix].iomem_wc = MAP_FAILED;
+  }
   munmap(uio->maps[map_ix].iomem, uio->maps[map_ix].size);
   uio->maps[map_ix].iomem = MAP_FAILED;
   uio->maps[map_ix].size  = 0;
@@ -226,7 +286,7 @@ ret_result:
 
 /// IO functions
 
-enum ntpcie_io_error_t ntia_pcie_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data)
+static enum ntpcie_io_error_t sysfs_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -248,7 +308,7 @@ ret_result:
   return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data)
+static enum ntpcie_io_error_t sysfs_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -270,10 +330,10 @@ ret_result:
   return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
-                                                    const uint32_t offset,
-                                                    void* const data,
-                                                    const uint32_t data_length)
+static enum ntpcie_io_error_t sysfs_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                       const uint32_t offset,
+                                                       void* const data,
+                                                       const uint32_t data_length)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -289,6 +349,14 @@ enum ntpcie_io_error_t ntia_pcie_io_device_mem_rd32(const struct pcie_io_handle_
 
   const struct uxio_dev_handle_t* const uio   = io_handle->_iox_handle;
   const size_t map_ix                         = io_handle->_u32x_space;
+
+  if ((io_handle->io_flags & NTIA_PCIE_IO_FLAG_WIDE_READ) != 0)
+  {
+    mmio_read_block(data, (const uint8_t*)uio->maps[map_ix].iomem + offset, data_length);
+    io_result = NTPCIE_IO_ERROR_SUCCESS;
+    goto ret_result;
+  }
+
   volatile const uint32_t* pcie_iomem_address = (volatile const uint32_t*)uio->maps[map_ix].iomem + (offset >> 2);
   uint32_t* data_u32_poiner                   = (uint32_t*)data;
   const uint32_t data_u32_length              = (data_length >> 2);
@@ -304,10 +372,10 @@ ret_result:
   return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
-                                                    const uint32_t offset,
-                                                    const void* const data,
-                                                    const uint32_t data_length)
+static enum ntpcie_io_error_t sysfs_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                       const uint32_t offset,
+                                                       const void* const data,
+                                                       const uint32_t data_length)
 {
   enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -323,6 +391,19 @@ enum ntpcie_io_error_t ntia_pcie_io_device_mem_wr32(const struct pcie_io_handle_
 
   const struct uxio_dev_handle_t* const uio = io_handle->_iox_handle;
   const size_t map_ix                       = io_handle->_u32x_space;
+
+  if (uio->maps[map_ix].iomem_wc != MAP_FAILED)
+  {
+    // burst upload through write-combining mapping, header of pack through UC mapping
+    mmio_wc_write_block((uint8_t*)uio->maps[map_ix].iomem_wc + offset,
+                        (uint8_t*)uio->maps[map_ix].iomem + offset,
+                        data,
+                        data_length,
+                        sizeof(struct pcie_data_upack_t));
+    io_result = NTPCIE_IO_ERROR_SUCCESS;
+    goto ret_result;
+  }
+
   volatile uint32_t* pcie_iomem_address     = (uint32_t*)uio->maps[map_ix].iomem + (offset >> 2);
   const uint32_t* data_u32_poiner           = (const uint32_t*)data;
   const uint32_t data_u32_length            = (data_length >> 2);
@@ -338,6 +419,19 @@ ret_result:
   return io_result;
 }
 
+const struct pcie_io_ops_t ntia_pcie_io_ops_sysfs = {
+  .name            = "sysfs",
+  .init            = sysfs_io_init,
+  .deinit          = sysfs_io_deinit,
+  .device_scan     = sysfs_io_device_scan,
+  .device_open     = sysfs_io_device_open,
+  .device_close    = sysfs_io_device_close,
+  .device_rd32     = sysfs_io_device_rd32,
+  .device_wr32     = sysfs_io_device_wr32,
+  .device_mem_rd32 = sysfs_io_device_mem_rd32,
+  .device_mem_wr32 = sysfs_io_device_mem_wr32,
+};
+
 /// internal functions
 static uint16_t read_pci_id(const char * const _file_name)
 {
@@ -367,8 +461,9 @@ static void uio_dev_handle_reset(struct uxio_dev_handle_t* const uio)
   uio->maps_active         = 0;
   for (size_t ix = 0; ix < MAX_UIO_MAPS; ix++)
   {
-    uio->maps[ix].iomem = MAP_FAILED;
-    uio->maps[ix].size  = 0;
+    uio->maps[ix].iomem    = MAP_FAILED;
+    uio->maps[ix].iomem_wc = MAP_FAILED;
+    uio->maps[ix].size     = 0;
   }
 }
 
@@ -376,6 +471,11 @@ static void uio_dev_handle_close_all(struct uxio_dev_handle_t* const uio)
 {
   for (size_t ix = 0; ix < MAX_UIO_MAPS; ix++)
   {
+    if (uio->maps[ix].iomem_wc != MAP_FAILED)
+    {
+      munmap(uio->maps[ix].iomem_wc, uio->maps[ix].size);
+      uio->maps[ix].iomem_wc = MAP_FAILED;
+    }
     if (uio->maps[ix].iomem == MAP_FAILED)
     {
       continue;
@@ -28,6 +28,7 @@
 struct uxio_map_t
 {
   void*  iomem;
+  void*  iomem_wc;                     ///< write-combining mapping of the same BAR (MAP_FAILED - not used)
   size_t size;
 };
 
@@ -0,0 +1,692 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// ppoll()
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+
+#include <linux/vfio.h>
+
+#include "ntia_api_data_types_ll.h"
+
+#include "pcie/transport_pcie.h"
+#include "pcie/transport_mmio.h"
+#include "transport_vfio.h"
+
+// HOWTO use:
+// card must be bound to "vfio-pci" driver, for example:
+//   modprobe vfio-pci
+//   echo 1e51 000f > /sys/bus/pci/drivers/vfio-pci/new_id
+// user must have access to /dev/vfio/<iommu_group> (for process automation see /install/linux)
+//
+// BAR0 is mapped through VFIO region API, MSI of card is routed to eventfd,
+// so waiting for results blocks in ppoll() instead of spinning on status register
+// (after short spin: operations finished within NTIA_VFIO_WAIT_SPIN_NS don't pay wakeup latency)
+
+static const char dirbase_name_pci_devices[] = "/sys/bus/pci/devices/";
+static const char devmem_sys_fn_template[] = "/sys/bus/pci/devices/0000:%02hx:%02hx.%1hx/%s";
+static const char device_name_template[] = "0000:%02hx:%02hx.%1hx";
+static const char vfio_container_name[] = "/dev/vfio/vfio";
+static const char vfio_group_name_template[] = "/dev/vfio/%s";
+static const char vfio_driver_name[] = "vfio-pci";
+
+/// transport operations
+static enum ntpcie_io_error_t vfio_io_init(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t vfio_io_deinit(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t vfio_io_device_scan(struct pcie_io_handle_t* const io_handle,
+                                                  struct nta_pcidev_list_t* const devs_list);
+static enum ntpcie_io_error_t vfio_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                  const uint16_t pci_bus,
+                                                  const uint16_t pci_slot,
+                                                  const uint16_t pci_func);
+static enum ntpcie_io_error_t vfio_io_device_close(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t vfio_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data);
+static enum ntpcie_io_error_t vfio_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data);
+static enum ntpcie_io_error_t vfio_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                      const uint32_t offset,
+                                                      void* const data,
+                                                      const uint32_t data_length);
+static enum ntpcie_io_error_t vfio_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                      const uint32_t offset,
+                                                      const void* const data,
+                                                      const uint32_t data_length);
+static enum ntpcie_io_error_t vfio_io_device_wait_event(const struct pcie_io_handle_t* const io_handle,
+                                                        const uint32_t timeout_us);
+
+/// internal functions
+static uint16_t read_pci_id(const char * const _file_name);
+static bool read_link_basename(const char* const _link_name, char* const _basename, const size_t _size);
+static void vfio_dev_handle_reset(struct uxio_vfio_handle_t* const vfio);
+static void vfio_dev_handle_close_all(struct uxio_vfio_handle_t* const vfio);
+static bool vfio_bus_master_enable(const struct uxio_vfio_handle_t* const vfio);
+static bool vfio_irq_msi_setup(struct uxio_vfio_handle_t* const vfio);
+static uint64_t vfio_clock_ns(void);
+
+/// services public functions
+static enum ntpcie_io_error_t vfio_io_init(struct pcie_io_handle_t* const io_handle)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  if (io_handle == NULL || io_handle->_iox_handle != NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  // every init has own state: several cards may be used by process at the same time
+  struct uxio_vfio_handle_t* const vfio = (struct uxio_vfio_handle_t*)malloc(sizeof(*vfio));
+  if (vfio == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  vfio_dev_handle_reset(vfio);
+  io_handle->_iox_handle = vfio;
+  io_handle->_u32x_space = NTIA_PCIE_INVALID_SP;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_deinit(struct pcie_io_handle_t* const io_handle)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  if (io_handle == NULL || io_handle->_iox_handle == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  vfio_dev_handle_close_all(io_handle->_iox_handle);
+  vfio_dev_handle_reset(io_handle->_iox_handle);
+  free(io_handle->_iox_handle);
+  io_handle->_iox_handle = NULL;
+  io_handle->_u32x_space = NTIA_PCIE_INVALID_SP;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_device_scan(struct pcie_io_handle_t* const io_handle,
+                                                  struct nta_pcidev_list_t* const devs_list)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  DIR *sysfs_dir  = NULL;
+  struct dirent *dir_item = NULL;
+
+  uint16_t c_pci_bus, c_pci_slot, c_pci_func, c_pci_vendor, c_pci_device;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  devs_list->pci_id_vendor   = NTIA_PCIE_VENDORID;
+  devs_list->pci_id_device   = NTIA_PCIE_DEVICEID;
+  devs_list->devs_count      = 0;
+
+  sysfs_dir = opendir(dirbase_name_pci_devices);
+  if (sysfs_dir == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  while (((dir_item=readdir(sysfs_dir)) != NULL) && (devs_list->devs_count < NTIA_PCIE_MAX_CARDS))
+  {
+    uint16_t c_pci_domain;
+    size_t num_count;
+    num_count = sscanf(dir_item->d_name, "%04hx:%02hx:%02hx.%1hx",
+                &c_pci_domain, &c_pci_bus, &c_pci_slot, &c_pci_func);
+    if (num_count != 4)
+    {
+      continue;
+    }
+    char devmem_sys_fn[256];
+    snprintf(devmem_sys_fn, 256, devmem_sys_fn_template, c_pci_bus, c_pci_slot, c_pci_func, "vendor");
+    c_pci_vendor = read_pci_id(devmem_sys_fn);
+    snprintf(devmem_sys_fn, 256, devmem_sys_fn_template, c_pci_bus, c_pci_slot, c_pci_func, "device");
+    c_pci_device = read_pci_id(devmem_sys_fn);
+    if (c_pci_vendor != devs_list->pci_id_vendor || c_pci_device != devs_list->pci_id_device)
+    {
+      continue;
+    }
+    // only cards bound to vfio-pci driver are usable
+    char driver_name[64];
+    snprintf(devmem_sys_fn, 256, devmem_sys_fn_template, c_pci_bus, c_pci_slot, c_pci_func, "driver");
+    if (read_link_basename(devmem_sys_fn, driver_name, sizeof(driver_name)) != true ||
+        strcmp(driver_name, vfio_driver_name) != 0)
+    {
+      continue;
+    }
+    devs_list->devices[devs_list->devs_count].bus   = c_pci_bus;
+    devs_list->devices[devs_list->devs_count].slot  = c_pci_slot;
+    devs_list->devices[devs_list->devs_count].func  = c_pci_func;
+    devs_list->devs_count++;
+  }
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  closedir(sysfs_dir);
+  sysfs_dir = NULL;
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                  const uint16_t pci_bus,
+                                                  const uint16_t pci_slot,
+                                                  const uint16_t pci_func)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  struct uxio_vfio_handle_t* const vfio = io_handle->_iox_handle;
+
+  if (vfio->device_fd != (-1))
+  {
+    // single device per init
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  // --- IOMMU group of device
+  char devmem_sys_fn[256];
+  char group_id[32];
+  snprintf(devmem_sys_fn, 256, devmem_sys_fn_template, pci_bus, pci_slot, pci_func, "iommu_group");
+  if (read_link_basename(devmem_sys_fn, group_id, sizeof(group_id)) != true)
+  {
+    fprintf(stderr, "vfio: device has no IOMMU group (IOMMU disabled?)\n");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_result;
+  }
+
+  // --- container
+  vfio->container_fd = open(vfio_container_name, O_RDWR | O_CLOEXEC);
+  if (vfio->container_fd == (-1))
+  {
+    perror("vfio: open container failed");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+  if (ioctl(vfio->container_fd, VFIO_GET_API_VERSION) != VFIO_API_VERSION ||
+      ioctl(vfio->container_fd, VFIO_CHECK_EXTENSION, VFIO_TYPE1_IOMMU) <= 0)
+  {
+    fprintf(stderr, "vfio: unsupported API version or IOMMU type\n");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+
+  // --- group
+  char group_name[64];
+  snprintf(group_name, sizeof(group_name), vfio_group_name_template, group_id);
+  vfio->group_fd = open(group_name, O_RDWR | O_CLOEXEC);
+  if (vfio->group_fd == (-1))
+  {
+    perror("vfio: open group failed");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+
+  struct vfio_group_status group_status = { .argsz = sizeof(group_status) };
+  if (ioctl(vfio->group_fd, VFIO_GROUP_GET_STATUS, &group_status) != 0 ||
+      (group_status.flags & VFIO_GROUP_FLAGS_VIABLE) == 0)
+  {
+    fprintf(stderr, "vfio: group is not viable (all devices of group must be bound to vfio-pci)\n");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+  if (ioctl(vfio->group_fd, VFIO_GROUP_SET_CONTAINER, &vfio->container_fd) != 0 ||
+      ioctl(vfio->container_fd, VFIO_SET_IOMMU, VFIO_TYPE1_IOMMU) != 0)
+  {
+    perror("vfio: set container/IOMMU failed");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+
+  // --- device
+  char device_name[32];
+  snprintf(device_name, sizeof(device_name), device_name_template, pci_bus, pci_slot, pci_func);
+  vfio->device_fd = ioctl(vfio->group_fd, VFIO_GROUP_GET_DEVICE_FD, device_name);
+  if (vfio->device_fd < 0)
+  {
+    perror("vfio: get device fd failed");
+    vfio->device_fd = (-1);
+    io_result       = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+
+  // --- BAR0 (used fixed BAR0 only)
+  struct vfio_region_info region_info = { .argsz = sizeof(region_info), .index = VFIO_PCI_BAR0_REGION_INDEX };
+  if (ioctl(vfio->device_fd, VFIO_DEVICE_GET_REGION_INFO, &region_info) != 0 ||
+      (region_info.flags & VFIO_REGION_INFO_FLAG_MMAP) == 0 ||
+      region_info.size < NTIA_PCIE_MEM_SIZE)
+  {
+    fprintf(stderr, "vfio: BAR0 region is not mappable\n");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+
+  vfio->iomem_size = NTIA_PCIE_MEM_SIZE;
+  vfio->iomem      = mmap(NULL, vfio->iomem_size,
+                          PROT_READ | PROT_WRITE, MAP_SHARED,
+                          vfio->device_fd, (off_t)region_info.offset);
+  if (vfio->iomem == MAP_FAILED)
+  {
+    perror("vfio: mmap failed");
+    io_result = NTPCIE_IO_ERROR_UNKNOWN;
+    goto ret_close_all;
+  }
+
+  // --- interrupts: without MSI transport works in polling mode
+  if (vfio_bus_master_enable(vfio) != true || vfio_irq_msi_setup(vfio) != true)
+  {
+    fprintf(stderr, "vfio: MSI is not available, status register will be polled\n");
+  }
+
+  io_handle->_u32x_space = 0;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+  goto ret_result;
+
+ret_close_all:
+  vfio_dev_handle_close_all(vfio);
+  vfio_dev_handle_reset(vfio);
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_device_close(struct pcie_io_handle_t* const io_handle)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  vfio_dev_handle_close_all(io_handle->_iox_handle);
+  vfio_dev_handle_reset(io_handle->_iox_handle);
+  io_handle->_u32x_space = NTIA_PCIE_INVALID_SP;
+  io_result              = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+/// IO functions
+
+static enum ntpcie_io_error_t vfio_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  const struct uxio_vfio_handle_t* const vfio = io_handle->_iox_handle;
+  volatile uint32_t* const pcie_iomem_address = (volatile uint32_t*)vfio->iomem + (offset >> 2);
+
+  // transfer data
+  *data = *pcie_iomem_address;
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  const struct uxio_vfio_handle_t* const vfio = io_handle->_iox_handle;
+  volatile uint32_t* const pcie_iomem_address = (volatile uint32_t*)vfio->iomem + (offset >> 2);
+
+  // transfer data
+  *pcie_iomem_address = data;
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                      const uint32_t offset,
+                                                      void* const data,
+                                                      const uint32_t data_length)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+  else if ((data_length & 0x3) != 0)
+  {
+    io_result = NTPCIE_IO_ERROR_DATASIZE_MISMATCH;
+    goto ret_result;
+  }
+
+  const struct uxio_vfio_handle_t* const vfio = io_handle->_iox_handle;
+
+  if ((io_handle->io_flags & NTIA_PCIE_IO_FLAG_WIDE_READ) != 0)
+  {
+    mmio_read_block(data, (const uint8_t*)vfio->iomem + offset, data_length);
+    io_result = NTPCIE_IO_ERROR_SUCCESS;
+    goto ret_result;
+  }
+
+  volatile const uint32_t* pcie_iomem_address = (volatile const uint32_t*)vfio->iomem + (offset >> 2);
+  uint32_t* data_u32_poiner                   = (uint32_t*)data;
+  const uint32_t data_u32_length              = (data_length >> 2);
+
+  // transfer data
+  for (size_t ix = 0; ix < data_u32_length; ix++)
+  {
+    *(data_u32_poiner++) = *(pcie_iomem_address++);
+  }
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                      const uint32_t offset,
+                                                      const void* const data,
+                                                      const uint32_t data_length)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+  else if ((data_length & 0x3) != 0)
+  {
+    io_result = NTPCIE_IO_ERROR_DATASIZE_MISMATCH;
+    goto ret_result;
+  }
+
+  const struct uxio_vfio_handle_t* const vfio = io_handle->_iox_handle;
+  volatile uint32_t* pcie_iomem_address       = (volatile uint32_t*)vfio->iomem + (offset >> 2);
+  const uint32_t* data_u32_poiner             = (const uint32_t*)data;
+  const uint32_t data_u32_length              = (data_length >> 2);
+
+  // transfer data
+  for (size_t ix = 0; ix < data_u32_length; ix++)
+  {
+    *(pcie_iomem_address++) = *(data_u32_poiner++);
+  }
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+static enum ntpcie_io_error_t vfio_io_device_wait_event(const struct pcie_io_handle_t* const io_handle,
+                                                        const uint32_t timeout_us)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+  if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  const struct uxio_vfio_handle_t* const vfio = io_handle->_iox_handle;
+  if (vfio->event_fd == (-1))
+  {
+    // polling mode
+    io_result = NTPCIE_IO_ERROR_SUCCESS;
+    goto ret_result;
+  }
+
+  // status register is re-read first: wait is over as soon as status of card changes
+  const volatile uint32_t* const status_address = (const volatile uint32_t*)vfio->iomem + (NTPCIE_DEVICE_ADDRESS_STATUS >> 2);
+  const uint32_t status                         = *status_address;
+  const uint64_t timeout_ns                     = (uint64_t)timeout_us * 1000u;
+  const uint64_t spin_until_ns = vfio_clock_ns() + ((timeout_ns < NTIA_VFIO_WAIT_SPIN_NS) ? timeout_ns : NTIA_VFIO_WAIT_SPIN_NS);
+
+  while (vfio_clock_ns() < spin_until_ns)
+  {
+    if (*status_address != status)
+    {
+      io_result = NTPCIE_IO_ERROR_SUCCESS;
+      goto ret_result;
+    }
+  }
+
+  // timeout in microseconds: poll() would round every wait up to whole millisecond
+  const uint32_t wait_us          = (timeout_us < NTIA_VFIO_WAIT_EVENT_MAX_US) ? timeout_us : NTIA_VFIO_WAIT_EVENT_MAX_US;
+  const struct timespec wait_time = { .tv_sec = (time_t)(wait_us / 1000000u), .tv_nsec = (long)(wait_us % 1000000u) * 1000l };
+  struct pollfd event_poll        = { .fd = vfio->event_fd, .events = POLLIN, .revents = 0 };
+
+  // ATT: eventfd counter keeps interrupt arrived before ppoll(), so it can't be lost
+  const int poll_result = ppoll(&event_poll, 1, &wait_time, NULL);
+  if (poll_result > 0)
+  {
+    uint64_t event_count;
+    if (read(vfio->event_fd, &event_count, sizeof(event_count)) != sizeof(event_count) && errno != EAGAIN)
+    {
+      io_result = NTPCIE_IO_ERROR_DATA_READ;
+      goto ret_result;
+    }
+  }
+  else if (poll_result < 0 && errno != EINTR)
+  {
+    io_result = NTPCIE_IO_ERROR_DATA_READ;
+    goto ret_result;
+  }
+  io_result = NTPCIE_IO_ERROR_SUCCESS;
+
+ret_result:
+  return io_result;
+}
+
+const struct pcie_io_ops_t ntia_pcie_io_ops_vfio = {
+  .name              = "vfio",
+  .init              = vfio_io_init,
+  .deinit            = vfio_io_deinit,
+  .device_scan       = vfio_io_device_scan,
+  .device_open       = vfio_io_device_open,
+  .device_close      = vfio_io_device_close,
+  .device_rd32       = vfio_io_device_rd32,
+  .device_wr32       = vfio_io_device_wr32,
+  .device_mem_rd32   = vfio_io_device_mem_rd32,
+  .device_mem_wr32   = vfio_io_device_mem_wr32,
+  .device_wait_event = vfio_io_device_wait_event,
+};
+
+/// internal functions
+static uint16_t read_pci_id(const char * const _file_name)
+{
+  FILE *info_file = NULL;
+  uint16_t pci_id = 0;
+
+  info_file = fopen(_file_name, "r");
+  if (info_file == NULL)
+  {
+    return 0;
+  }
+  if (fscanf(info_file, "0x%hx", &pci_id) != 1)
+  {
+    pci_id = 0;
+  }
+  fclose(info_file);
+  return pci_id;
+}
+
+static bool read_link_basename(const char* const _link_name, char* const _basename, const size_t _size)
+{
+  char link_target[256];
+
+  const ssize_t link_length = readlink(_link_name, link_target, sizeof(link_target) - 1);
+  if (link_length <= 0)
+  {
+    return false;
+  }
+  link_target[link_length] = '\0';
+
+  const char* const last_slash = strrchr(link_target, '/');
+  const char* const basename   = (last_slash != NULL) ? last_slash + 1 : link_target;
+  if (strlen(basename) + 1 > _size)
+  {
+    return false;
+  }
+  strcpy(_basename, basename);
+  return true;
+}
+
+static void vfio_dev_handle_reset(struct uxio_vfio_handle_t* const vfio)
+{
+  vfio->container_fd = (-1);
+  vfio->group_fd     = (-1);
+  vfio->device_fd    = (-1);
+  vfio->event_fd     = (-1);
+  vfio->iomem        = MAP_FAILED;
+  vfio->iomem_size   = 0;
+}
+
+static void vfio_dev_handle_close_all(struct uxio_vfio_handle_t* const vfio)
+{
+  if (vfio->event_fd != (-1))
+  {
+    // disable MSI
+    struct vfio_irq_set irq_set = {
+      .argsz = sizeof(irq_set),
+      .flags = VFIO_IRQ_SET_DATA_NONE | VFIO_IRQ_SET_ACTION_TRIGGER,
+      .index = VFIO_PCI_MSI_IRQ_INDEX,
+      .start = 0,
+      .count = 0,
+    };
+    ioctl(vfio->device_fd, VFIO_DEVICE_SET_IRQS, &irq_set);
+    close(vfio->event_fd);
+  }
+  if (vfio->iomem != MAP_FAILED)
+  {
+    munmap(vfio->iomem, vfio->iomem_size);
+  }
+  if (vfio->device_fd != (-1))
+  {
+    close(vfio->device_fd);
+  }
+  if (vfio->group_fd != (-1))
+  {
+    ioctl(vfio->group_fd, VFIO_GROUP_UNSET_CONTAINER);
+    close(vfio->group_fd);
+  }
+  if (vfio->container_fd != (-1))
+  {
+    close(vfio->container_fd);
+  }
+}
+
+static bool vfio_bus_master_enable(const struct uxio_vfio_handle_t* const vfio)
+{
+  // MSI is memory write from device: "Bus Master" bit of PCI command register must be set
+  struct vfio_region_info region_info = { .argsz = sizeof(region_info), .index = VFIO_PCI_CONFIG_REGION_INDEX };
+  if (ioctl(vfio->device_fd, VFIO_DEVICE_GET_REGION_INFO, &region_info) != 0)
+  {
+    return false;
+  }
+
+  const off_t command_offset = (off_t)region_info.offset + 0x04;
+  uint16_t pci_command       = 0;
+  if (pread(vfio->device_fd, &pci_command, sizeof(pci_command), command_offset) != sizeof(pci_command))
+  {
+    return false;
+  }
+
+  pci_command |= 0x0004u;
+  return (pwrite(vfio->device_fd, &pci_command, sizeof(pci_command), command_offset) == sizeof(pci_command));
+}
+
+static bool vfio_irq_msi_setup(struct uxio_vfio_handle_t* const vfio)
+{
+  struct vfio_irq_info irq_info = { .argsz = sizeof(irq_info), .index = VFIO_PCI_MSI_IRQ_INDEX };
+  if (ioctl(vfio->device_fd, VFIO_DEVICE_GET_IRQ_INFO, &irq_info) != 0 ||
+      (irq_info.flags & VFIO_IRQ_INFO_EVENTFD) == 0 || irq_info.count < 1)
+  {
+    return false;
+  }
+
+  const int event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (event_fd == (-1))
+  {
+    return false;
+  }
+
+  // vfio_irq_set with single eventfd in data[]
+  uint8_t irq_set_buffer[sizeof(struct vfio_irq_set) + sizeof(int32_t)];
+  struct vfio_irq_set* const irq_set = (struct vfio_irq_set*)irq_set_buffer;
+  const int32_t irq_event_fd         = event_fd;
+
+  irq_set->argsz = sizeof(irq_set_buffer);
+  irq_set->flags = VFIO_IRQ_SET_DATA_EVENTFD | VFIO_IRQ_SET_ACTION_TRIGGER;
+  irq_set->index = VFIO_PCI_MSI_IRQ_INDEX;
+  irq_set->start = 0;
+  irq_set->count = 1;
+  memcpy(irq_set->data, &irq_event_fd, sizeof(irq_event_fd));
+
+  if (ioctl(vfio->device_fd, VFIO_DEVICE_SET_IRQS, irq_set) != 0)
+  {
+    close(event_fd);
+    return false;
+  }
+
+  vfio->event_fd = event_fd;
+  return true;
+}
+
+static uint64_t vfio_clock_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
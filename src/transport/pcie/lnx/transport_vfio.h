@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#pragma once
+#ifndef ONCE_INC_TRANSPORT_VFIO_H_
+#define ONCE_INC_TRANSPORT_VFIO_H_
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "sorry, tested only for LITTLE_ENDIAN"
+#endif // __BYTE_ORDER__
+
+#ifndef __linux__
+#error "sorry, this module for Linux ONLY"
+#endif // __linux__
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// max time of single wait for interrupt, status is re-read after timeout
+// (protects against lost/unsupported interrupts)
+#ifndef NTIA_VFIO_WAIT_EVENT_MAX_US
+#define NTIA_VFIO_WAIT_EVENT_MAX_US (1000u)
+#endif // NTIA_VFIO_WAIT_EVENT_MAX_US
+
+// max time of spin on status register before blocking wait for interrupt
+#ifndef NTIA_VFIO_WAIT_SPIN_NS
+#define NTIA_VFIO_WAIT_SPIN_NS (20000u)
+#endif // NTIA_VFIO_WAIT_SPIN_NS
+
+struct uxio_vfio_handle_t
+{
+  int    container_fd;                 ///< /dev/vfio/vfio
+  int    group_fd;                     ///< /dev/vfio/<iommu_group>
+  int    device_fd;                    ///< device fd from VFIO_GROUP_GET_DEVICE_FD
+  int    event_fd;                     ///< eventfd signaled by MSI (-1 - interrupts not available, polling)
+  void*  iomem;                        ///< mapping of BAR0 region
+  size_t iomem_size;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ONCE_INC_TRANSPORT_VFIO_H_
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#pragma once
+#ifndef ONCE_INC_TRANSPORT_MMIO_H_
+#define ONCE_INC_TRANSPORT_MMIO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__amd64__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif // __amd64__
+
+// helpers to transfer data blocks to/from memory mapped BAR of card (mmap based transports)
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+/**
+ * @brief         upload data pack to BAR: header through UC mapping, the rest through write-combining mapping
+ * @details       WC buffers may be flushed to card out of order, so header of pack is written by
+ *                ordinary (UC) stores and fenced before the rest of pack is streamed: card sees pack
+ *                in the same order as by UC writes; the rest of pack is written by widest non-temporal
+ *                stores available (AVX: 256 bit, SSE2: 128 bit) and flushed by store fence at the end
+ *                (i.e. pack is visible for card before any following access to UC mapping)
+ * @param[in]     wc_iomem destination address in WC mapping (must be 4 bytes aligned)
+ * @param[in]     uc_iomem destination address in UC mapping (the same offset of BAR as wc_iomem)
+ * @param[in]     data source data
+ * @param[in]     data_length length of data (bytes, must be multiple of 4)
+ * @param[in]     head_length length of header of pack (bytes, must be multiple of 4)
+ */
+static inline void mmio_wc_write_block(volatile void* const wc_iomem,
+                                       volatile void* const uc_iomem,
+                                       const void* const data,
+                                       const size_t data_length,
+                                       const size_t head_length)
+{
+  const size_t head = (head_length < data_length) ? head_length : data_length;
+
+  for (size_t ix = 0; ix < head; ix += sizeof(uint32_t))
+  {
+    uint32_t value;
+    __builtin_memcpy(&value, (const uint8_t*)data + ix, sizeof(value));
+    *(volatile uint32_t*)((volatile uint8_t*)uc_iomem + ix) = value;
+  }
+  if (head == data_length)
+  {
+    return;
+  }
+
+  uint8_t* dst       = (uint8_t*)wc_iomem + head;
+  const uint8_t* src = (const uint8_t*)data + head;
+  size_t length      = data_length - head;
+
+#if defined(__amd64__) || defined(__x86_64__)
+  // header is at card before any part of pack streamed through WC
+  _mm_sfence();
+
+  // 4 bytes stores up to alignment of destination for wide stores
+  while (length >= sizeof(uint32_t) && ((uintptr_t)dst & 0x0F) != 0)
+  {
+    int32_t value;
+    __builtin_memcpy(&value, src, sizeof(value));
+    _mm_stream_si32((int*)dst, value);
+    dst += sizeof(uint32_t);
+    src += sizeof(uint32_t);
+    length -= sizeof(uint32_t);
+  }
+#if defined(__AVX__)
+  if (((uintptr_t)dst & 0x1F) != 0 && length >= sizeof(__m128i))
+  {
+    _mm_stream_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+    dst += sizeof(__m128i);
+    src += sizeof(__m128i);
+    length -= sizeof(__m128i);
+  }
+  for (; length >= sizeof(__m256i); length -= sizeof(__m256i))
+  {
+    _mm256_stream_si256((__m256i*)dst, _mm256_loadu_si256((const __m256i*)src));
+    dst += sizeof(__m256i);
+    src += sizeof(__m256i);
+  }
+#endif // __AVX__
+  for (; length >= sizeof(__m128i); length -= sizeof(__m128i))
+  {
+    _mm_stream_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+    dst += sizeof(__m128i);
+    src += sizeof(__m128i);
+  }
+  for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t))
+  {
+    int32_t value;
+    __builtin_memcpy(&value, src, sizeof(value));
+    _mm_stream_si32((int*)dst, value);
+    dst += sizeof(uint32_t);
+    src += sizeof(uint32_t);
+  }
+  _mm_sfence();
+#else
+  __sync_synchronize();
+
+  // 64 bit stores (combined by WC buffers of CPU), then full barrier
+  for (; length >= sizeof(uint64_t) && ((uintptr_t)dst & 0x07) == 0; length -= sizeof(uint64_t))
+  {
+    uint64_t value;
+    __builtin_memcpy(&value, src, sizeof(value));
+    *(volatile uint64_t*)dst = value;
+    dst += sizeof(uint64_t);
+    src += sizeof(uint64_t);
+  }
+  for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t))
+  {
+    uint32_t value;
+    __builtin_memcpy(&value, src, sizeof(value));
+    *(volatile uint32_t*)dst = value;
+    dst += sizeof(uint32_t);
+    src += sizeof(uint32_t);
+  }
+  __sync_synchronize();
+#endif // __amd64__
+}
+
+/**
+ * @brief         read data block from (uncached) mapping of BAR with wide loads
+ * @details       every load is single PCIe read request: 128 bit (SSE2) or 64 bit loads
+ *                are used for aligned part of block instead of 32 bit loads
+ * @param[out]    data destination buffer
+ * @param[in]     iomem source address in mapping of BAR (must be 4 bytes aligned)
+ * @param[in]     data_length length of data (bytes, must be multiple of 4)
+ */
+static inline void mmio_read_block(void* const data, const volatile void* const iomem, const size_t data_length)
+{
+  uint8_t* dst       = (uint8_t*)data;
+  const uint8_t* src = (const uint8_t*)iomem;
+  size_t length      = data_length;
+
+#if defined(__amd64__) || defined(__x86_64__)
+  // 4 bytes loads up to alignment of source for wide loads
+  while (length >= sizeof(uint32_t) && ((uintptr_t)src & 0x0F) != 0)
+  {
+    const uint32_t value = *(const volatile uint32_t*)src;
+    __builtin_memcpy(dst, &value, sizeof(value));
+    dst += sizeof(uint32_t);
+    src += sizeof(uint32_t);
+    length -= sizeof(uint32_t);
+  }
+  for (; length >= sizeof(__m128i); length -= sizeof(__m128i))
+  {
+    _mm_storeu_si128((__m128i*)dst, _mm_load_si128((const __m128i*)src));
+    dst += sizeof(__m128i);
+    src += sizeof(__m128i);
+  }
+#endif // __amd64__
+  if (length >= sizeof(uint32_t) && ((uintptr_t)src & 0x07) != 0)
+  {
+    const uint32_t value = *(const volatile uint32_t*)src;
+    __builtin_memcpy(dst, &value, sizeof(value));
+    dst += sizeof(uint32_t);
+    src += sizeof(uint32_t);
+    length -= sizeof(uint32_t);
+  }
+  for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t))
+  {
+    const uint64_t value = *(const volatile uint64_t*)src;
+    __builtin_memcpy(dst, &value, sizeof(value));
+    dst += sizeof(uint64_t);
+    src += sizeof(uint64_t);
+  }
+  for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t))
+  {
+    const uint32_t value = *(const volatile uint32_t*)src;
+    __builtin_memcpy(dst, &value, sizeof(value));
+    dst += sizeof(uint32_t);
+    src += sizeof(uint32_t);
+  }
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // ONCE_INC_TRANSPORT_MMIO_H_
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "pcie/transport_pcie.h"
+
+// transports (backends) available at runtime, first one is default for platform
+static const struct pcie_io_ops_t* const io_ops_list[] = {
+#if defined(NTIA_PCIE_TRANSPORT_DEFAULT_EMU)
+  &ntia_pcie_io_ops_emu,
+#endif // NTIA_PCIE_TRANSPORT_DEFAULT_EMU
+#if defined(__linux__)
+  &ntia_pcie_io_ops_sysfs,
+  &ntia_pcie_io_ops_vfio,
+#endif // __linux__
+#if defined(_WIN32)
+  &ntia_pcie_io_ops_umdfv2,
+#endif // _WIN32
+  &ntia_pcie_io_ops_emu,
+};
+
+/// internal functions
+static const struct pcie_io_ops_t* io_ops_find(const char* const transport_name);
+
+/// services public functions
+enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handle,
+                                         const char* const transport_name,
+                                         const uint32_t io_flags)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  if (io_handle == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  const struct pcie_io_ops_t* const io_ops = io_ops_find(transport_name);
+  if (io_ops == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_NO_TRANSPORT;
+    goto ret_result;
+  }
+
+  io_handle->ops      = io_ops;
+  io_handle->io_flags = io_flags;
+  io_result           = io_ops->init(io_handle);
+  if (io_result != NTPCIE_IO_ERROR_SUCCESS)
+  {
+    io_handle->ops = NULL;
+  }
+
+ret_result:
+  return io_result;
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_deinit(struct pcie_io_handle_t* const io_handle)
+{
+  enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    io_result = NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+    goto ret_result;
+  }
+
+  io_result      = io_handle->ops->deinit(io_handle);
+  io_handle->ops = NULL;
+
+ret_result:
+  return io_result;
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_device_scan(struct pcie_io_handle_t* const io_handle,
+                                                struct nta_pcidev_list_t* const devs_list)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  return io_handle->ops->device_scan(io_handle, devs_list);
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                const uint16_t pci_bus,
+                                                const uint16_t pci_slot,
+                                                const uint16_t pci_func)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  return io_handle->ops->device_open(io_handle, pci_bus, pci_slot, pci_func);
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_device_close(struct pcie_io_handle_t* const io_handle)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  return io_handle->ops->device_close(io_handle);
+}
+
+/// IO functions
+
+enum ntpcie_io_error_t ntia_pcie_io_device_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                const uint32_t offset,
+                                                uint32_t* const data)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  return io_handle->ops->device_rd32(io_handle, offset, data);
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_device_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                const uint32_t offset,
+                                                const uint32_t data)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  return io_handle->ops->device_wr32(io_handle, offset, data);
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                    const uint32_t offset,
+                                                    void* const data,
+                                                    const uint32_t data_length)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  return io_handle->ops->device_mem_rd32(io_handle, offset, data, data_length);
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                    const uint32_t offset,
+                                                    const void* const data,
+                                                    const uint32_t data_length)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  return io_handle->ops->device_mem_wr32(io_handle, offset, data, data_length);
+}
+
+enum ntpcie_io_error_t ntia_pcie_io_device_wait_event(const struct pcie_io_handle_t* const io_handle,
+                                                      const uint32_t timeout_us)
+{
+  if (io_handle == NULL || io_handle->ops == NULL)
+  {
+    return NTPCIE_IO_ERROR_BAD_DEV_HANDLE;
+  }
+  else if (io_handle->ops->device_wait_event == NULL)
+  {
+    // polling mode
+    return NTPCIE_IO_ERROR_SUCCESS;
+  }
+  return io_handle->ops->device_wait_event(io_handle, timeout_us);
+}
+
+/// internal functions
+static const struct pcie_io_ops_t* io_ops_find(const char* const transport_name)
+{
+  const char* name = transport_name;
+
+  if (name == NULL || name[0] == '\0')
+  {
+    name = getenv("NTIA_PCIE_TRANSPORT");
+  }
+  if (name == NULL || name[0] == '\0')
+  {
+    return io_ops_list[0];
+  }
+
+  for (size_t ix = 0; ix < sizeof(io_ops_list) / sizeof(io_ops_list[0]); ++ix)
+  {
+    if (strcmp(io_ops_list[ix]->name, name) == 0)
+    {
+      return io_ops_list[ix];
+    }
+  }
+  return NULL;
+}
@@ -27,6 +27,10 @@
 
 #define NTIA_PCIE_INVALID_SP (0xFFFFFFFFul)
 
+// IO flags (options of transport, ignored by transports which don't support them)
+#define NTIA_PCIE_IO_FLAG_WRITE_COMBINING (0x00000001ul)  ///< upload data packs through WC mapping of BAR
+#define NTIA_PCIE_IO_FLAG_WIDE_READ       (0x00000002ul)  ///< read data blocks with 64/128 bit loads
+
 //--------------- TODO: move to appropriate place
 // general PCIe dev parameters
 #ifndef NTIA_PCIE_MAX_CARDS
@@ -58,13 +62,54 @@ enum ntpcie_io_error_t
   NTPCIE_IO_ERROR_DATA_WRITE,
   NTPCIE_IO_ERROR_DATASIZE_MISMATCH,
   NTPCIE_IO_ERROR_ALIGN_MISMATCH,
+  NTPCIE_IO_ERROR_NO_TRANSPORT,
 };
 
 
+struct pcie_io_ops_t;
+
 struct pcie_io_handle_t
 {
   void* _iox_handle;
   uint32_t _u32x_space;
+  const struct pcie_io_ops_t* ops;      ///< transport (backend) selected at ntia_pcie_io_init()
+  uint32_t io_flags;                    ///< NTIA_PCIE_IO_FLAG_...
+};
+
+// table of transport (backend) operations, semantic of every operation
+// is the same as semantic of appropriate ntia_pcie_io_* function
+struct pcie_io_ops_t
+{
+  const char* name;                     ///< transport name (for selection at runtime)
+
+  enum ntpcie_io_error_t (*init)(struct pcie_io_handle_t* const io_handle);
+  enum ntpcie_io_error_t (*deinit)(struct pcie_io_handle_t* const io_handle);
+  enum ntpcie_io_error_t (*device_scan)(struct pcie_io_handle_t* const io_handle,
+                                        struct nta_pcidev_list_t* const devs_list);
+  enum ntpcie_io_error_t (*device_open)(struct pcie_io_handle_t* const io_handle,
+                                        const uint16_t pci_bus,
+                                        const uint16_t pci_slot,
+                                        const uint16_t pci_func);
+  enum ntpcie_io_error_t (*device_close)(struct pcie_io_handle_t* const io_handle);
+
+  enum ntpcie_io_error_t (*device_rd32)(const struct pcie_io_handle_t* const io_handle,
+                                        const uint32_t offset,
+                                        uint32_t* const data);
+  enum ntpcie_io_error_t (*device_wr32)(const struct pcie_io_handle_t* const io_handle,
+                                        const uint32_t offset,
+                                        const uint32_t data);
+  enum ntpcie_io_error_t (*device_mem_rd32)(const struct pcie_io_handle_t* const io_handle,
+                                            const uint32_t offset,
+                                            void* const data,
+                                            const uint32_t data_length);
+  enum ntpcie_io_error_t (*device_mem_wr32)(const struct pcie_io_handle_t* const io_handle,
+                                            const uint32_t offset,
+                                            const void* const data,
+                                            const uint32_t data_length);
+
+  // optional (may be NULL): transport can't notify about completion, status must be polled
+  enum ntpcie_io_error_t (*device_wait_event)(const struct pcie_io_handle_t* const io_handle,
+                                              const uint32_t timeout_us);
 };
 
 #ifdef __cplusplus
@@ -72,14 +117,29 @@ extern "C"
 {
 #endif // __cplusplus
 
+  // transports (backends) built into library
+#if defined(__linux__)
+  extern const struct pcie_io_ops_t ntia_pcie_io_ops_sysfs;
+  extern const struct pcie_io_ops_t ntia_pcie_io_ops_vfio;
+#endif // __linux__
+#if defined(_WIN32)
+  extern const struct pcie_io_ops_t ntia_pcie_io_ops_umdfv2;
+#endif // _WIN32
+  extern const struct pcie_io_ops_t ntia_pcie_io_ops_emu;
+
   /**
-   * @brief         TODO
-   * @details       TODO
-   * @param[in]
-   * @param[out]
+   * @brief         select transport (backend) and init it
+   * @details       transport is selected by name ("sysfs", "vfio", "umdfv2", "emu"),
+   *                if name is NULL - by environment variable NTIA_PCIE_TRANSPORT
+   *                or (if variable is not set) default transport of platform
+   * @param[in/out] io_handle pointer to device handle instance
+   * @param[in]     transport_name name of transport (may be NULL)
+   * @param[in]     io_flags options of transport (NTIA_PCIE_IO_FLAG_...)
    * @return        error code (NTPCIE_IO_ERROR_SUCCESS is OK)
    */
-  enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handle);
+  enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handle,
+                                           const char* const transport_name,
+                                           const uint32_t io_flags);
 
   /**
    * @brief         TODO
@@ -170,6 +230,18 @@ extern "C"
                                                       const void* const data,
                                                       const uint32_t data_length);
 
+  /**
+   * @brief         wait for event (interrupt) from PCIe device
+   * @details       returns immediately if transport can't deliver events (status must be polled);
+   *                returns on event, on change of status register (transport may spin on it briefly
+   *                before blocking) or after timeout, in all cases caller must re-read status
+   * @param[in]     io_handle pointer to device handle instance
+   * @param[in]     timeout_us max time to wait (microseconds)
+   * @return        error code (NTPCIE_IO_ERROR_SUCCESS is OK)
+   */
+  enum ntpcie_io_error_t ntia_pcie_io_device_wait_event(const struct pcie_io_handle_t* const io_handle,
+                                                        const uint32_t timeout_us);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -51,7 +51,25 @@ struct uxio_device_list_t
     struct uxio_device_t devices[NTIA_PCIE_MAX_CARDS];
 };
 
-static struct uxio_device_list_t uio_dev_list;
+/// transport operations
+static enum ntpcie_io_error_t umdfv2_io_init(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t umdfv2_io_deinit(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t umdfv2_io_device_scan(struct pcie_io_handle_t* const io_handle, struct nta_pcidev_list_t* const devs_list);
+static enum ntpcie_io_error_t umdfv2_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                    const uint16_t pci_bus,
+                                                    const uint16_t pci_slot,
+                                                    const uint16_t pci_func);
+static enum ntpcie_io_error_t umdfv2_io_device_close(struct pcie_io_handle_t* const io_handle);
+static enum ntpcie_io_error_t umdfv2_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data);
+static enum ntpcie_io_error_t umdfv2_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data);
+static enum ntpcie_io_error_t umdfv2_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                        const uint32_t offset,
+                                                        void* const data,
+                                                        const uint32_t data_length_octets);
+static enum ntpcie_io_error_t umdfv2_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                        const uint32_t offset,
+                                                        const void* const data,
+                                                        const uint32_t data_length_octets);
 
 /// internal functions
 static bool uio_dev_scan_system(struct uxio_device_list_t * const dev_list, GUID const* const umdfv2_iface_guid);
@@ -73,7 +91,7 @@ static bool uio_dev_wr32(HANDLE sys_dev_handle,
                          const uint32_t data_length_octets);
 
 /// services public functions
-enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handle)
+static enum ntpcie_io_error_t umdfv2_io_init(struct pcie_io_handle_t* const io_handle)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
     if (io_handle == NULL || io_handle->_iox_handle != NULL)
@@ -82,9 +100,16 @@ enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handl
         goto ret_result;
     }
 
-    struct uxio_device_list_t * const int_devs_list = &uio_dev_list;
+    // every init has own list of devices: several cards may be used by process at the same time
+    struct uxio_device_list_t * const int_devs_list = (struct uxio_device_list_t*)malloc(sizeof(*int_devs_list));
     bool system_scan_result                         = false;
 
+    if (int_devs_list == NULL)
+    {
+        io_result = NTPCIE_IO_ERROR_UNKNOWN;
+        goto ret_result;
+    }
+
     uio_dev_handle_reset(int_devs_list);
     system_scan_result = uio_dev_scan_system(int_devs_list, &GUID_DEVINTERFACE_NTIA_PCIE);
 
@@ -97,6 +122,7 @@ enum ntpcie_io_error_t ntia_pcie_io_init(struct pcie_io_handle_t* const io_handl
     }
     else
     {
+        free(int_devs_list);
         io_handle->_iox_handle = NULL;
         io_result              = NTPCIE_IO_ERROR_UNKNOWN;
         goto ret_result;
@@ -106,7 +132,7 @@ ret_result:
     return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_deinit(struct pcie_io_handle_t* const io_handle)
+static enum ntpcie_io_error_t umdfv2_io_deinit(struct pcie_io_handle_t* const io_handle)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
     if (io_handle == NULL || io_handle->_iox_handle == NULL)
@@ -117,6 +143,7 @@ enum ntpcie_io_error_t ntia_pcie_io_deinit(struct pcie_io_handle_t* const io_han
 
     uio_dev_handle_close_all(io_handle->_iox_handle);
     uio_dev_handle_reset(io_handle->_iox_handle);
+    free(io_handle->_iox_handle);
     io_handle->_iox_handle = NULL;
     io_handle->_u32x_space = NTIA_PCIE_INVALID_SP;
     io_result              = NTPCIE_IO_ERROR_SUCCESS;
@@ -125,7 +152,7 @@ ret_result:
     return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_scan(struct pcie_io_handle_t* const io_handle, struct nta_pcidev_list_t* const devs_list)
+static enum ntpcie_io_error_t umdfv2_io_device_scan(struct pcie_io_handle_t* const io_handle, struct nta_pcidev_list_t* const devs_list)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -160,10 +187,10 @@ ret_result:
     return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_open(struct pcie_io_handle_t* const io_handle,
-                                                const uint16_t pci_bus,
-                                                const uint16_t pci_slot,
-                                                const uint16_t pci_func)
+static enum ntpcie_io_error_t umdfv2_io_device_open(struct pcie_io_handle_t* const io_handle,
+                                                    const uint16_t pci_bus,
+                                                    const uint16_t pci_slot,
+                                                    const uint16_t pci_func)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -200,7 +227,7 @@ ret_result:
     return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_close(struct pcie_io_handle_t* const io_handle)
+static enum ntpcie_io_error_t umdfv2_io_device_close(struct pcie_io_handle_t* const io_handle)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
     if (io_handle == NULL || io_handle->_iox_handle == NULL || io_handle->_u32x_space == NTIA_PCIE_INVALID_SP)
@@ -229,7 +256,7 @@ ret_result:
 
 /// IO functions
 
-enum ntpcie_io_error_t ntia_pcie_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data)
+static enum ntpcie_io_error_t umdfv2_io_device_rd32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, uint32_t* const data)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -251,7 +278,7 @@ ret_result:
     return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data)
+static enum ntpcie_io_error_t umdfv2_io_device_wr32(const struct pcie_io_handle_t* const io_handle, const uint32_t offset, const uint32_t data)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -273,10 +300,10 @@ ret_result:
     return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
-                                                    const uint32_t offset,
-                                                    void* const data,
-                                                    const uint32_t data_length_octets)
+static enum ntpcie_io_error_t umdfv2_io_device_mem_rd32(const struct pcie_io_handle_t* const io_handle,
+                                                        const uint32_t offset,
+                                                        void* const data,
+                                                        const uint32_t data_length_octets)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -303,10 +330,10 @@ ret_result:
     return io_result;
 }
 
-enum ntpcie_io_error_t ntia_pcie_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
-                                                    const uint32_t offset,
-                                                    const void* const data,
-                                                    const uint32_t data_length_octets)
+static enum ntpcie_io_error_t umdfv2_io_device_mem_wr32(const struct pcie_io_handle_t* const io_handle,
+                                                        const uint32_t offset,
+                                                        const void* const data,
+                                                        const uint32_t data_length_octets)
 {
     enum ntpcie_io_error_t io_result = NTPCIE_IO_ERROR_SUCCESS;
 
@@ -333,6 +360,19 @@ ret_result:
     return io_result;
 }
 
+const struct pcie_io_ops_t ntia_pcie_io_ops_umdfv2 = {
+    .name            = "umdfv2",
+    .init            = umdfv2_io_init,
+    .deinit          = umdfv2_io_deinit,
+    .device_scan     = umdfv2_io_device_scan,
+    .device_open     = umdfv2_io_device_open,
+    .device_close    = umdfv2_io_device_close,
+    .device_rd32     = umdfv2_io_device_rd32,
+    .device_wr32     = umdfv2_io_device_wr32,
+    .device_mem_rd32 = umdfv2_io_device_mem_rd32,
+    .device_mem_wr32 = umdfv2_io_device_mem_wr32,
+};
+
 /// internal functions
 static size_t uio_dev_handle_find(struct uxio_device_list_t const* const dev_list,
                                   const uint16_t pci_bus,
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// adaptive classify: decided vector is answered by the first query (answers_first responses),
+// uncertain vector and vector answered by degenerated neuron are classified again with all responses
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_COMPS_COUNT   (4u)
+#define TEST_RESP_COUNT    (4u)
+#define TEST_ANSWERS_FIRST (1u)
+#define TEST_MAXIF         (0x0100u)
+#define TEST_MINIF         (0x0002u)
+
+// contexts of knowledge bases (every case has its own)
+#define TEST_CONTEXT_DECIDED     (1u)
+#define TEST_CONTEXT_UNCERTAIN   (2u)
+#define TEST_CONTEXT_DEGENERATED (3u)
+
+/// internal functions
+static int test_adaptive_learn(struct nta_dev_handle_t* const dev_handle);
+static int test_adaptive_decided(struct nta_dev_handle_t* const dev_handle);
+static int test_adaptive_widened(struct nta_dev_handle_t* const dev_handle, const uint16_t context,
+                                 const nn_vector_comp_t value, const bool uncertain);
+static enum ntpcie_nn_error_t test_learn(struct nta_dev_handle_t* const dev_handle, const uint16_t context,
+                                         const uint16_t category, const nn_vector_comp_t value_first,
+                                         const nn_vector_comp_t value_last);
+static void test_vector_fill(nn_vector_comp_t data_vector[], const nn_vector_comp_t value);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  // the same checks for card served by caller thread and by IO thread of card
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      TEST_REQUIRE(ntpcie_device_queue_start(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+    }
+    test_adaptive_learn(&dev_handle);
+    test_adaptive_decided(&dev_handle);
+    test_adaptive_widened(&dev_handle, TEST_CONTEXT_UNCERTAIN, 50, true);
+    test_adaptive_widened(&dev_handle, TEST_CONTEXT_DEGENERATED, 0, false);
+  }
+
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// L1 distance of vectors filled by a and b is 4 * |a - b| (the last component may differ)
+static int test_adaptive_learn(struct nta_dev_handle_t* const dev_handle)
+{
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  // far neurons of different categories: only the closest one fires in RBF mode
+  TEST_REQUIRE(test_learn(dev_handle, TEST_CONTEXT_DECIDED, 1, 10, 10) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, TEST_CONTEXT_DECIDED, 2, 200, 200) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, TEST_CONTEXT_DECIDED, 3, 100, 100) == NTPCIE_ERROR_SUCCESS);
+
+  // influence fields (MAXIF) overlap: vector between neurons is uncertain
+  TEST_REQUIRE(test_learn(dev_handle, TEST_CONTEXT_UNCERTAIN, 1, 0, 0) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, TEST_CONTEXT_UNCERTAIN, 2, 100, 100) == NTPCIE_ERROR_SUCCESS);
+
+  // neurons at distance MINIF: both are degenerated, they don't fire for each other
+  TEST_REQUIRE(test_learn(dev_handle, TEST_CONTEXT_DEGENERATED, 1, 0, 0) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, TEST_CONTEXT_DEGENERATED, 2, 0, TEST_MINIF) == NTPCIE_ERROR_SUCCESS);
+
+  return 0;
+}
+
+// card fired more neurons (KNN), but the closest one is certain: the first query is enough
+static int test_adaptive_decided(struct nta_dev_handle_t* const dev_handle)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  struct response_neuron_state_t resp[TEST_RESP_COUNT];
+  struct nn_classify_status_t status;
+  size_t resp_count = TEST_RESP_COUNT;
+
+  test_vector_fill(data_vector, 10);
+  TEST_CHECK(ntpcie_nn_vector_classify_adaptive(dev_handle, NN_DIST_EVAL_L1, TEST_CONTEXT_DECIDED, NN_CLASSIFIER_KNN,
+                                                TEST_COMPS_COUNT, data_vector, TEST_ANSWERS_FIRST, &resp_count, resp,
+                                                &status) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(resp_count == TEST_ANSWERS_FIRST);
+  TEST_CHECK((status.ncount == 3) && status.identified && (status.uncertain == false));
+  TEST_CHECK((resp[0].category == 1) && (resp[0].distance == 0) && (resp[0].degenerated == 0));
+
+  // all responses fit to the first query: nothing to widen
+  resp_count = TEST_RESP_COUNT;
+  TEST_CHECK(ntpcie_nn_vector_classify_adaptive(dev_handle, NN_DIST_EVAL_L1, TEST_CONTEXT_DECIDED, NN_CLASSIFIER_KNN,
+                                                TEST_COMPS_COUNT, data_vector, TEST_RESP_COUNT, &resp_count, resp,
+                                                NULL) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK((resp_count == 3) && (resp[0].category == 1) && (resp[1].category == 3) && (resp[2].category == 2));
+
+  return 0;
+}
+
+// the first query isn't enough: responses and status are the ones of classify with all responses
+static int test_adaptive_widened(struct nta_dev_handle_t* const dev_handle, const uint16_t context,
+                                 const nn_vector_comp_t value, const bool uncertain)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  struct response_neuron_state_t resp[TEST_RESP_COUNT];
+  struct response_neuron_state_t resp_all[TEST_RESP_COUNT];
+  struct nn_classify_status_t status;
+  struct nn_classify_status_t status_all;
+  size_t resp_count     = TEST_RESP_COUNT;
+  size_t resp_count_all = TEST_RESP_COUNT;
+
+  test_vector_fill(data_vector, value);
+  TEST_REQUIRE(ntpcie_nn_vector_classify_ex(dev_handle, NN_DIST_EVAL_L1, context, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                            data_vector, &resp_count_all, resp_all, &status_all) ==
+               NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK((resp_count_all == 2) && (status_all.ncount == 2));
+  TEST_CHECK(status_all.uncertain == uncertain);
+  TEST_CHECK(uncertain || (resp_all[0].degenerated == 1));
+
+  TEST_CHECK(ntpcie_nn_vector_classify_adaptive(dev_handle, NN_DIST_EVAL_L1, context, NN_CLASSIFIER_KNN,
+                                                TEST_COMPS_COUNT, data_vector, TEST_ANSWERS_FIRST, &resp_count, resp,
+                                                &status) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(resp_count == resp_count_all);
+  TEST_CHECK(memcmp(resp, resp_all, resp_count_all * sizeof(resp[0])) == 0);
+  TEST_CHECK((status.ncount == status_all.ncount) && (status.uncertain == status_all.uncertain));
+
+  return 0;
+}
+
+// vector filled by value_first, the last component is value_last
+static enum ntpcie_nn_error_t test_learn(struct nta_dev_handle_t* const dev_handle, const uint16_t context,
+                                         const uint16_t category, const nn_vector_comp_t value_first,
+                                         const nn_vector_comp_t value_last)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  test_vector_fill(data_vector, value_first);
+  data_vector[TEST_COMPS_COUNT - 1] = value_last;
+  return ntpcie_nn_vector_learn(dev_handle, NN_DIST_EVAL_L1, context, category, TEST_MAXIF, TEST_MINIF,
+                                TEST_COMPS_COUNT, data_vector);
+}
+
+static void test_vector_fill(nn_vector_comp_t data_vector[], const nn_vector_comp_t value)
+{
+  for (size_t ix = 0; ix < TEST_COMPS_COUNT; ++ix)
+  {
+    data_vector[ix] = value;
+  }
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// asynchronous classify: completions are delivered in order of submission with the same responses
+// as synchronous classify, ring of requests is bounded, request over deadline is completed by poll
+// (run against slow card: NTIA_EMU_EXEC_NS)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_COMPS_COUNT   (16u)
+#define TEST_VECTORS_COUNT (32u)
+#define TEST_REQS_COUNT    (6u)
+#define TEST_RESP_COUNT    (4u)
+#define TEST_MAXIF         (0x0100u)
+#define TEST_MINIF         (0x0002u)
+#define TEST_TIMEOUT_NS    (20000u)
+#define TEST_POLLS_MAX     (100000000u)
+
+static struct response_neuron_state_t resp_async[NTPCIE_ASYNC_DEPTH][TEST_RESP_COUNT];
+static uint32_t tokens[NTPCIE_ASYNC_DEPTH];
+
+/// internal functions
+static int test_async_submit_poll(struct nta_dev_handle_t* const dev_handle);
+static int test_async_ring_full(struct nta_dev_handle_t* const dev_handle);
+static int test_async_deadline(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_submit(struct nta_dev_handle_t* const dev_handle, const size_t ix_vector,
+                                          const size_t ix_req);
+static size_t test_poll_all(struct nta_dev_handle_t* const dev_handle, struct nta_completion_t completions[],
+                            const size_t completions_max);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_REQUIRE(ntpcie_nn_vector_learn(&dev_handle, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), TEST_MAXIF, TEST_MINIF,
+                                        TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  // the same checks for card served by caller thread and by IO thread of card
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      TEST_REQUIRE(ntpcie_device_queue_start(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+    }
+    test_async_submit_poll(&dev_handle);
+    test_async_ring_full(&dev_handle);
+    test_async_deadline(&dev_handle);
+  }
+
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// tokens are increasing, completions come in order of submission, responses are the same as
+// responses of synchronous classify; card is busy for synchronous calls till everything is polled
+static int test_async_submit_poll(struct nta_dev_handle_t* const dev_handle)
+{
+  struct nta_completion_t completions[TEST_REQS_COUNT];
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  for (size_t ix = 0; ix < TEST_REQS_COUNT; ++ix)
+  {
+    TEST_REQUIRE(test_submit(dev_handle, ix * 5, ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK((ix == 0) || (tokens[ix] == tokens[ix - 1] + 1));
+  }
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 0);
+  TEST_CHECK(ntpcie_nn_vector_learn(dev_handle, NN_DIST_EVAL_L1, 1, 1, TEST_MAXIF, TEST_MINIF, TEST_COMPS_COUNT,
+                                    data_vector) == NTPCIE_ERROR_BUSY);
+
+  TEST_REQUIRE(test_poll_all(dev_handle, completions, TEST_REQS_COUNT) == TEST_REQS_COUNT);
+  for (size_t ix = 0; ix < TEST_REQS_COUNT; ++ix)
+  {
+    struct response_neuron_state_t resp[TEST_RESP_COUNT];
+    size_t resp_count = TEST_RESP_COUNT;
+
+    TEST_CHECK(completions[ix].token == tokens[ix]);
+    TEST_CHECK(completions[ix].result == NTPCIE_ERROR_SUCCESS);
+
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix * 5);
+    TEST_REQUIRE(ntpcie_nn_vector_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                           data_vector, &resp_count, resp) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(completions[ix].number_of_responses == resp_count);
+    TEST_CHECK(memcmp(resp_async[ix], resp, resp_count * sizeof(resp[0])) == 0);
+    TEST_CHECK(resp[0].category == ix * 5 + 1);
+  }
+
+  return 0;
+}
+
+// NTPCIE_ASYNC_DEPTH requests are accepted, the next one gets BUSY (ring is left intact)
+static int test_async_ring_full(struct nta_dev_handle_t* const dev_handle)
+{
+  struct nta_completion_t completions[NTPCIE_ASYNC_DEPTH];
+  struct response_neuron_state_t resp[TEST_RESP_COUNT];
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  uint32_t token = 0;
+
+  for (size_t ix = 0; ix < NTPCIE_ASYNC_DEPTH; ++ix)
+  {
+    TEST_REQUIRE(test_submit(dev_handle, ix, ix) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 0);
+  TEST_CHECK(ntpcie_submit_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                    TEST_RESP_COUNT, resp, &token) == NTPCIE_ERROR_BUSY);
+
+  TEST_REQUIRE(test_poll_all(dev_handle, completions, NTPCIE_ASYNC_DEPTH) == NTPCIE_ASYNC_DEPTH);
+  for (size_t ix = 0; ix < NTPCIE_ASYNC_DEPTH; ++ix)
+  {
+    TEST_CHECK((completions[ix].token == tokens[ix]) && (completions[ix].result == NTPCIE_ERROR_SUCCESS));
+    TEST_CHECK((completions[ix].number_of_responses > 0) && (resp_async[ix][0].category == ix + 1));
+  }
+
+  // the next request is accepted again
+  TEST_CHECK(test_submit(dev_handle, 0, 0) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_poll_all(dev_handle, completions, 1) == 1);
+
+  return 0;
+}
+
+// card slower than timeout: uploaded request is completed by poll with timeout, requests waiting
+// for upload get the same error; card is usable again after it
+static int test_async_deadline(struct nta_dev_handle_t* const dev_handle)
+{
+  struct nta_completion_t completions[TEST_REQS_COUNT];
+  struct response_neuron_state_t resp[TEST_RESP_COUNT];
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  size_t resp_count = TEST_RESP_COUNT;
+
+  TEST_REQUIRE(ntpcie_device_timeout_set(dev_handle, TEST_TIMEOUT_NS) == NTPCIE_ERROR_SUCCESS);
+  for (size_t ix = 0; ix < TEST_REQS_COUNT; ++ix)
+  {
+    TEST_REQUIRE(test_submit(dev_handle, ix, ix) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  TEST_REQUIRE(test_poll_all(dev_handle, completions, TEST_REQS_COUNT) == TEST_REQS_COUNT);
+  for (size_t ix = 0; ix < TEST_REQS_COUNT; ++ix)
+  {
+    TEST_CHECK(completions[ix].token == tokens[ix]);
+    TEST_CHECK(completions[ix].result == NTPCIE_ERROR_WAIT_TIMEOUT);
+    TEST_CHECK(completions[ix].number_of_responses == 0);
+  }
+
+  TEST_REQUIRE(ntpcie_device_timeout_set(dev_handle, 0) == NTPCIE_ERROR_SUCCESS);
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 3);
+  TEST_CHECK(ntpcie_nn_vector_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                       data_vector, &resp_count, resp) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK((resp_count > 0) && (resp[0].category == 4));
+
+  return 0;
+}
+
+// KNN classify of vector #ix_vector, responses to resp_async[ix_req], token to tokens[ix_req]
+static enum ntpcie_nn_error_t test_submit(struct nta_dev_handle_t* const dev_handle, const size_t ix_vector,
+                                          const size_t ix_req)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, ix_vector);
+  return ntpcie_submit_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                TEST_RESP_COUNT, resp_async[ix_req], &tokens[ix_req]);
+}
+
+// poll (by one completion at most) until completions_max requests are completed or polls are over
+static size_t test_poll_all(struct nta_dev_handle_t* const dev_handle, struct nta_completion_t completions[],
+                            const size_t completions_max)
+{
+  size_t done = 0;
+
+  for (size_t cnt = 0; (done < completions_max) && (cnt < TEST_POLLS_MAX); ++cnt)
+  {
+    size_t completed_count = 0;
+    if (ntpcie_poll_completions(dev_handle, &completions[done], 1, &completed_count) != NTPCIE_ERROR_SUCCESS)
+    {
+      break;
+    }
+    done += completed_count;
+  }
+  return done;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// batch classify: strided buffer and array of pointers give the same responses as single classify
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_COMPS_COUNT    (20u)
+#define TEST_VECTORS_STRIDE (TEST_COMPS_COUNT + 3u)
+#define TEST_NEURONS_COUNT  (100u)
+#define TEST_VECTORS_COUNT  (50u)
+#define TEST_RESP_COUNT     (5u)
+
+static nn_vector_comp_t data_vectors[TEST_VECTORS_COUNT * TEST_VECTORS_STRIDE];
+static const nn_vector_comp_t* vectors[TEST_VECTORS_COUNT];
+static struct response_neuron_state_t resp_single[TEST_VECTORS_COUNT * TEST_RESP_COUNT];
+static struct response_neuron_state_t resp_strided[TEST_VECTORS_COUNT * TEST_RESP_COUNT];
+static struct response_neuron_state_t resp_ptr[TEST_VECTORS_COUNT * TEST_RESP_COUNT];
+static size_t count_single[TEST_VECTORS_COUNT];
+static size_t count_strided[TEST_VECTORS_COUNT];
+static size_t count_ptr[TEST_VECTORS_COUNT];
+
+/// internal functions
+static int test_batch_vs_single(struct nta_dev_handle_t* const dev_handle);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  for (size_t ix = 0; ix < TEST_NEURONS_COUNT; ++ix)
+  {
+    nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_REQUIRE(ntpcie_nn_vector_learn(&dev_handle, NN_DIST_EVAL_L1, 1, (uint16_t)(ix % 10 + 1), NN_DEF_MAXIF,
+                                        NN_DEF_MINIF, TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  // strided buffer (padding between vectors) and pointers to vectors of the same buffer in reverse order
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    test_vector_make(&data_vectors[ix * TEST_VECTORS_STRIDE], TEST_COMPS_COUNT, ix * 2);
+    data_vectors[ix * TEST_VECTORS_STRIDE + 5] ^= (nn_vector_comp_t)(ix % 3);
+    memset(&data_vectors[ix * TEST_VECTORS_STRIDE + TEST_COMPS_COUNT], 0xA5, TEST_VECTORS_STRIDE - TEST_COMPS_COUNT);
+  }
+
+  // the same checks for card served by caller thread and by IO thread of card
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      TEST_REQUIRE(ntpcie_device_queue_start(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+    }
+    test_batch_vs_single(&dev_handle);
+  }
+
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+static int test_batch_vs_single(struct nta_dev_handle_t* const dev_handle)
+{
+  size_t vectors_done = 0;
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    count_single[ix] = TEST_RESP_COUNT;
+    TEST_REQUIRE(ntpcie_nn_vector_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                           &data_vectors[ix * TEST_VECTORS_STRIDE], &count_single[ix],
+                                           &resp_single[ix * TEST_RESP_COUNT]) == NTPCIE_ERROR_SUCCESS);
+    vectors[TEST_VECTORS_COUNT - 1 - ix] = &data_vectors[ix * TEST_VECTORS_STRIDE];
+  }
+
+  TEST_CHECK(ntpcie_nn_vectors_classify_batch(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                              TEST_VECTORS_COUNT, data_vectors, TEST_VECTORS_STRIDE, TEST_RESP_COUNT,
+                                              count_strided, resp_strided, &vectors_done) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(vectors_done == TEST_VECTORS_COUNT);
+
+  TEST_CHECK(ntpcie_nn_vectors_classify_batch_ptr(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                                  TEST_VECTORS_COUNT, vectors, TEST_RESP_COUNT,
+                                                  count_ptr, resp_ptr, &vectors_done) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(vectors_done == TEST_VECTORS_COUNT);
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    const size_t ix_ptr = TEST_VECTORS_COUNT - 1 - ix;
+
+    TEST_CHECK(count_strided[ix] == count_single[ix]);
+    TEST_CHECK(memcmp(&resp_strided[ix * TEST_RESP_COUNT], &resp_single[ix * TEST_RESP_COUNT],
+                      count_single[ix] * sizeof(resp_single[0])) == 0);
+    TEST_CHECK(count_ptr[ix_ptr] == count_single[ix]);
+    TEST_CHECK(memcmp(&resp_ptr[ix_ptr * TEST_RESP_COUNT], &resp_single[ix * TEST_RESP_COUNT],
+                      count_single[ix] * sizeof(resp_single[0])) == 0);
+  }
+
+  // empty batch, batch which responses don't fit into address space and NULL vector are rejected
+  TEST_CHECK(ntpcie_nn_vectors_classify_batch(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, 0,
+                                              data_vectors, 0, TEST_RESP_COUNT, count_strided, resp_strided,
+                                              NULL) == NTPCIE_ERROR_ARGS_VECTORS_COUNT);
+  TEST_CHECK(ntpcie_nn_vectors_classify_batch_ptr(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, 0,
+                                                  vectors, TEST_RESP_COUNT, count_ptr, resp_ptr,
+                                                  NULL) == NTPCIE_ERROR_ARGS_VECTORS_COUNT);
+  TEST_CHECK(ntpcie_nn_vectors_classify_batch(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                              SIZE_MAX / 2, data_vectors, 0, TEST_RESP_COUNT, count_strided,
+                                              resp_strided, NULL) == NTPCIE_ERROR_ARGS_VECTORS_COUNT);
+
+  vectors[1] = NULL;
+  TEST_CHECK(ntpcie_nn_vectors_classify_batch_ptr(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                                  TEST_VECTORS_COUNT, vectors, TEST_RESP_COUNT, count_ptr, resp_ptr,
+                                                  &vectors_done) == NTPCIE_ERROR_ARGS_NULL_POINTER);
+  TEST_CHECK(vectors_done == 0);
+
+  return 0;
+}
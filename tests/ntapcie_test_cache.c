@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// cache of classify results: every change of knowledge base (learn, NN reset, KB load, register
+// write, device reset) drops cached results, card owned by asynchronous requests isn't bypassed by cache
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+#include "ntia_api_ll.h"
+
+#define TEST_COMPS_COUNT   (16u)
+#define TEST_RESP_COUNT    (4u)
+#define TEST_CACHE_ENTRIES (64u)
+#define TEST_MAXIF         (0x0100u)
+#define TEST_MINIF         (0x0002u)
+
+static struct nn_neuron_t neurons[2];
+
+/// internal functions
+static int test_cache_invalidation(struct nta_dev_handle_t* const dev_handle);
+static int test_cache_async_busy(struct nta_dev_handle_t* const dev_handle);
+static size_t test_cache_miss_after(struct nta_dev_handle_t* const dev_handle, const char* const change_name,
+                                    enum ntpcie_nn_error_t (*change)(struct nta_dev_handle_t* const dev_handle));
+static enum ntpcie_nn_error_t test_classify(struct nta_dev_handle_t* const dev_handle, size_t* const resp_count);
+static uint64_t test_cache_hits(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_learn(struct nta_dev_handle_t* const dev_handle, const size_t ix_vector);
+static enum ntpcie_nn_error_t test_change_learn(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_change_nn_reset(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_change_kbase_load(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_change_register_write(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_change_device_reset(struct nta_dev_handle_t* const dev_handle);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  // the same checks for card served by caller thread and by IO thread of card
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      TEST_REQUIRE(ntpcie_device_queue_start(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+    }
+    TEST_REQUIRE(ntpcie_device_cache_start(&dev_handle, TEST_CACHE_ENTRIES) == NTPCIE_ERROR_SUCCESS);
+    test_cache_invalidation(&dev_handle);
+    test_cache_async_busy(&dev_handle);
+    TEST_CHECK(ntpcie_device_cache_stop(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// responses after change are responses of changed knowledge base (not cached ones)
+static int test_cache_invalidation(struct nta_dev_handle_t* const dev_handle)
+{
+  size_t neurons_count = 0;
+
+  // KB of vectors #0 (category 1) and #1 (category 2) is kept for KB load
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, 0) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, 1) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_kbase_store_all(dev_handle, neurons, 2, &neurons_count) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(neurons_count == 2);
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, 0) == NTPCIE_ERROR_SUCCESS);
+
+  TEST_CHECK(test_cache_miss_after(dev_handle, "learn", test_change_learn) == 2);
+  TEST_CHECK(test_cache_miss_after(dev_handle, "NN reset", test_change_nn_reset) == 0);
+  TEST_CHECK(test_cache_miss_after(dev_handle, "KB load", test_change_kbase_load) == 2);
+  TEST_CHECK(test_cache_miss_after(dev_handle, "register write", test_change_register_write) == 2);
+  TEST_CHECK(test_cache_miss_after(dev_handle, "device reset", test_change_device_reset) == 0);
+
+  return 0;
+}
+
+// request which would be answered by cache gets BUSY as request to card while asynchronous
+// requests are pending, it is answered by cache again after they are polled
+static int test_cache_async_busy(struct nta_dev_handle_t* const dev_handle)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  struct response_neuron_state_t resp_async[TEST_RESP_COUNT];
+  struct nta_completion_t completions[1];
+  size_t resp_count      = 0;
+  size_t completed_count = 0;
+  uint32_t token         = 0;
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_learn(dev_handle, 0) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_classify(dev_handle, &resp_count) == NTPCIE_ERROR_SUCCESS);
+
+  const uint64_t hits = test_cache_hits(dev_handle);
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 0);
+  TEST_REQUIRE(ntpcie_submit_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                      TEST_RESP_COUNT, resp_async, &token) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_classify(dev_handle, &resp_count) == NTPCIE_ERROR_BUSY);
+  TEST_CHECK(test_cache_hits(dev_handle) == hits);
+
+  for (size_t cnt = 0; (completed_count == 0) && (cnt < 1000000); ++cnt)
+  {
+    TEST_REQUIRE(ntpcie_poll_completions(dev_handle, completions, 1, &completed_count) == NTPCIE_ERROR_SUCCESS);
+  }
+  TEST_REQUIRE(completed_count == 1);
+  TEST_CHECK((completions[0].token == token) && (completions[0].result == NTPCIE_ERROR_SUCCESS));
+
+  TEST_CHECK(test_classify(dev_handle, &resp_count) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_cache_hits(dev_handle) == hits + 1);
+
+  return 0;
+}
+
+// request is cached (the second one is answered by cache), after change it is answered by card;
+// amount of responses after change is returned
+static size_t test_cache_miss_after(struct nta_dev_handle_t* const dev_handle, const char* const change_name,
+                                    enum ntpcie_nn_error_t (*change)(struct nta_dev_handle_t* const dev_handle))
+{
+  size_t resp_count = 0;
+
+  TEST_CHECK(test_classify(dev_handle, &resp_count) == NTPCIE_ERROR_SUCCESS);
+  const uint64_t hits = test_cache_hits(dev_handle);
+  TEST_CHECK(test_classify(dev_handle, &resp_count) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_cache_hits(dev_handle) == hits + 1);
+
+  TEST_CHECK(change(dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  TEST_CHECK(test_classify(dev_handle, &resp_count) == NTPCIE_ERROR_SUCCESS);
+  if (test_cache_hits(dev_handle) != hits + 1)
+  {
+    fprintf(stderr, "cached result is used after %s\n", change_name);
+    TEST_CHECK(test_cache_hits(dev_handle) == hits + 1);
+  }
+
+  return resp_count;
+}
+
+// KNN classify of vector #0 in context 1
+static enum ntpcie_nn_error_t test_classify(struct nta_dev_handle_t* const dev_handle, size_t* const resp_count)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  struct response_neuron_state_t resp[TEST_RESP_COUNT];
+
+  *resp_count = TEST_RESP_COUNT;
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 0);
+  return ntpcie_nn_vector_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                   resp_count, resp);
+}
+
+static uint64_t test_cache_hits(struct nta_dev_handle_t* const dev_handle)
+{
+  struct nn_stats_t stats;
+
+  TEST_CHECK(ntpcie_stats_get(dev_handle, &stats) == NTPCIE_ERROR_SUCCESS);
+  return stats.oper[NN_STATS_OPER_CLASSIFY].cache_hits;
+}
+
+// vector #ix_vector as category ix_vector + 1 of context 1
+static enum ntpcie_nn_error_t test_learn(struct nta_dev_handle_t* const dev_handle, const size_t ix_vector)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, ix_vector);
+  return ntpcie_nn_vector_learn(dev_handle, NN_DIST_EVAL_L1, 1, (uint16_t)(ix_vector + 1), TEST_MAXIF, TEST_MINIF,
+                                TEST_COMPS_COUNT, data_vector);
+}
+
+// changes of knowledge base: KNN classify of vector #0 gets 2 responses (vectors #0 and #1) or none
+
+static enum ntpcie_nn_error_t test_change_learn(struct nta_dev_handle_t* const dev_handle)
+{
+  return test_learn(dev_handle, 1);
+}
+
+static enum ntpcie_nn_error_t test_change_nn_reset(struct nta_dev_handle_t* const dev_handle)
+{
+  return ntpcie_nn_reset(dev_handle);
+}
+
+static enum ntpcie_nn_error_t test_change_kbase_load(struct nta_dev_handle_t* const dev_handle)
+{
+  return ntpcie_kbase_load_all(dev_handle, TEST_COMPS_COUNT, neurons, 2, NULL);
+}
+
+// register of NN is written directly: library can't know whether knowledge base is changed
+static enum ntpcie_nn_error_t test_change_register_write(struct nta_dev_handle_t* const dev_handle)
+{
+  return ntpcie_nn_register_write(dev_handle, CM_MINIF, TEST_MINIF);
+}
+
+static enum ntpcie_nn_error_t test_change_device_reset(struct nta_dev_handle_t* const dev_handle)
+{
+  return ntpcie_device_reset(dev_handle);
+}
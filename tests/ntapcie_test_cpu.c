@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// CPU engine: responses over KB read from card are the same as responses of card for every
+// distance kernel supported by build and CPU
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_NEURONS_COUNT (400u)
+#define TEST_RESP_COUNT    (10u)
+
+static struct nn_neuron_t neurons[TEST_NEURONS_COUNT];
+
+// SIMD kernels: vectors shorter than one register, with tails and of full length
+static const size_t test_comps_counts[] = { 1, 7, 16, 33, 100, NN_NEURON_COMPONENTS };
+
+static const enum nn_cpu_kernel_t test_kernels[] = { NN_CPU_KERNEL_SCALAR, NN_CPU_KERNEL_AVX2, NN_CPU_KERNEL_AVX512,
+                                                     NN_CPU_KERNEL_NEON, NN_CPU_KERNEL_AUTO };
+
+/// internal functions
+static int test_cpu_vs_card(struct nta_dev_handle_t* const dev_handle, const size_t comps_count);
+static int test_cpu_queries(struct nta_dev_handle_t* const dev_handle, const size_t comps_count, const size_t neurons_count);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  // scalar and detected kernels are always available, unknown one is rejected
+  TEST_CHECK(ntpcie_cpu_kernel_select(NN_CPU_KERNEL_SCALAR) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(ntpcie_cpu_kernel_select(NN_CPU_KERNEL_AUTO) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(ntpcie_cpu_kernel_select((enum nn_cpu_kernel_t)0xFFu) == NTPCIE_ERROR_ARGS_CPU_KERNEL);
+
+  for (size_t ix = 0; ix < sizeof(test_comps_counts) / sizeof(test_comps_counts[0]); ++ix)
+  {
+    test_cpu_vs_card(&dev_handle, test_comps_counts[ix]);
+  }
+
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// KB of two contexts (context 2 has smaller AIF) is classified by every kernel
+static int test_cpu_vs_card(struct nta_dev_handle_t* const dev_handle, const size_t comps_count)
+{
+  size_t neurons_count = 0;
+
+  nn_vector_comp_t data_vector[NN_NEURON_COMPONENTS];
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  for (size_t ix = 0; ix < TEST_NEURONS_COUNT; ++ix)
+  {
+    const uint16_t context = (uint16_t)(1 + ix % 2);
+    const uint16_t maxif   = (context == 1) ? NN_DEF_MAXIF : (uint16_t)(NN_DEF_MAXIF / 64);
+
+    test_vector_make(data_vector, comps_count, ix);
+    TEST_REQUIRE(ntpcie_nn_vector_learn(dev_handle, NN_DIST_EVAL_L1, context, (uint16_t)(ix % 50 + 1), maxif,
+                                        NN_DEF_MINIF, comps_count, data_vector) == NTPCIE_ERROR_SUCCESS);
+  }
+  TEST_REQUIRE(ntpcie_kbase_store_all(dev_handle, neurons, TEST_NEURONS_COUNT, &neurons_count) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(neurons_count > 0);
+
+  for (size_t ix_kernel = 0; ix_kernel < sizeof(test_kernels) / sizeof(test_kernels[0]); ++ix_kernel)
+  {
+    // kernel not supported by build or CPU
+    if (ntpcie_cpu_kernel_select(test_kernels[ix_kernel]) != NTPCIE_ERROR_SUCCESS)
+    {
+      continue;
+    }
+    test_cpu_queries(dev_handle, comps_count, neurons_count);
+  }
+
+  return 0;
+}
+
+// queries: learned vectors and vectors near them, all distances and classifiers
+static int test_cpu_queries(struct nta_dev_handle_t* const dev_handle, const size_t comps_count, const size_t neurons_count)
+{
+  nn_vector_comp_t data_vector[NN_NEURON_COMPONENTS];
+
+  for (int ix_dist = 0; ix_dist < 2; ++ix_dist)
+  {
+    const enum nn_dist_eval_t dist_eval = (ix_dist == 0) ? NN_DIST_EVAL_L1 : NN_DIST_EVAL_LSUP;
+
+    for (int ix_classifier = 0; ix_classifier < 2; ++ix_classifier)
+    {
+      const enum nn_classifier_t classifier = (ix_classifier == 0) ? NN_CLASSIFIER_KNN : NN_CLASSIFIER_RBF;
+
+      for (size_t ix = 0; ix < TEST_NEURONS_COUNT; ix += 3)
+      {
+        const uint16_t context = (uint16_t)(1 + ix % 2);
+        size_t count_card      = TEST_RESP_COUNT;
+        size_t count_cpu       = TEST_RESP_COUNT;
+        struct response_neuron_state_t resp_card[TEST_RESP_COUNT];
+        struct response_neuron_state_t resp_cpu[TEST_RESP_COUNT];
+
+        test_vector_make(data_vector, comps_count, ix);
+        if ((ix % 4) == 1)
+        {
+          data_vector[comps_count - 1] ^= 0x21u;
+        }
+
+        TEST_CHECK(ntpcie_nn_vector_classify(dev_handle, dist_eval, context, classifier, comps_count, data_vector,
+                                             &count_card, resp_card) == NTPCIE_ERROR_SUCCESS);
+        TEST_CHECK(ntpcie_cpu_vector_classify(neurons, neurons_count, dist_eval, context, classifier, comps_count,
+                                              data_vector, &count_cpu, resp_cpu) == NTPCIE_ERROR_SUCCESS);
+        TEST_CHECK(count_cpu == count_card);
+        TEST_CHECK(memcmp(resp_cpu, resp_card, ((count_cpu < count_card) ? count_cpu : count_card) * sizeof(resp_card[0])) == 0);
+      }
+    }
+  }
+
+  return 0;
+}
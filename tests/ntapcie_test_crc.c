@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// CRC32: every implementation supported by build and CPU gives the same CRC as bytewise table
+// for all lengths (folding blocks and their tails) and alignments of buffer
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+#include "crc32.h"
+
+#define TEST_LENGTH_MAX (3000u)
+#define TEST_OFFSET_MAX (8u)
+
+static uint8_t buffer[TEST_LENGTH_MAX + TEST_OFFSET_MAX];
+
+static const enum crc32_impl_t test_impls[] = { CRC32_IMPL_SLICE8, CRC32_IMPL_PCLMUL, CRC32_IMPL_ARMV8, CRC32_IMPL_AUTO };
+
+/// internal functions
+static int test_crc_impl(void);
+static uint32_t test_crc_bytewise(uint32_t crc_acc, const uint8_t* pointer, size_t count);
+
+int main(void)
+{
+  for (size_t ix = 0; ix < sizeof(buffer); ++ix)
+  {
+    buffer[ix] = (uint8_t)((ix * 131u) ^ (ix >> 3));
+  }
+
+  // slicing-by-8 and detected implementation are always available, unknown one is rejected
+  TEST_CHECK(crc32_impl_select(CRC32_IMPL_SLICE8));
+  TEST_CHECK(crc32_impl_select(CRC32_IMPL_AUTO));
+  TEST_CHECK(crc32_impl_select((enum crc32_impl_t)0xFF) == false);
+
+  for (size_t ix = 0; ix < sizeof(test_impls) / sizeof(test_impls[0]); ++ix)
+  {
+    // implementation not supported by build or CPU
+    if (crc32_impl_select(test_impls[ix]) == false)
+    {
+      continue;
+    }
+    test_crc_impl();
+  }
+
+  crc32_impl_select(CRC32_IMPL_AUTO);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// CRC of known string, then every length and offset; accumulator is continued from previous CRC
+static int test_crc_impl(void)
+{
+  static const char check[] = "123456789";
+
+  TEST_CHECK((crc32_update(0xFFFFFFFFu, check, sizeof(check) - 1) ^ 0xFFFFFFFFu) == 0xCBF43926u);
+
+  uint32_t crc_acc = 0xFFFFFFFFu;
+  for (size_t offset = 0; offset <= TEST_OFFSET_MAX; ++offset)
+  {
+    for (size_t length = 0; length <= TEST_LENGTH_MAX; ++length)
+    {
+      const uint32_t crc_test = crc32_update(crc_acc, &buffer[offset], length);
+      const uint32_t crc_ref  = test_crc_bytewise(crc_acc, &buffer[offset], length);
+      if (crc_test != crc_ref)
+      {
+        fprintf(stderr, "offset %zu, length %zu: 0x%08X != 0x%08X\n", offset, length, crc_test, crc_ref);
+        TEST_CHECK(crc_test == crc_ref);
+        return 0;
+      }
+      crc_acc = crc_ref;
+    }
+  }
+
+  return 0;
+}
+
+// reference: one table lookup per byte
+static uint32_t test_crc_bytewise(uint32_t crc_acc, const uint8_t* pointer, size_t count)
+{
+  while (count-- > 0)
+  {
+    crc_acc = (crc_acc >> 8) ^ ntia_crc32_table[(crc_acc ^ *pointer++) & 0xFF];
+  }
+  return crc_acc;
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// group of cards: merged responses are the same as of single card holding whole KB (KNN, and RBF
+// after learn of repeating categories), cards with pending asynchronous requests of application are rejected
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_GROUP_CARDS   (3u)
+#define TEST_COMPS_COUNT   (24u)
+#define TEST_VECTORS_COUNT (240u)
+#define TEST_RESP_COUNT    (8u)
+#define TEST_RBF_MAXIF     (0x0400u)
+
+/// internal functions
+static int test_group_vs_card(struct nta_card_group_t* const group, struct nta_dev_handle_t* const card);
+static int test_group_rbf_vs_card(struct nta_card_group_t* const group, struct nta_dev_handle_t* const card);
+static int test_group_busy(struct nta_card_group_t* const group);
+static void test_resp_sort(struct response_neuron_state_t resp[], const size_t count);
+static int test_resp_compare(const void* const resp_a, const void* const resp_b);
+
+int main(void)
+{
+  // cards 0 .. 2 form group, card 3 holds whole KB
+  struct nta_dev_handle_t dev_handles[TEST_GROUP_CARDS + 1];
+  struct nta_dev_handle_t* cards[TEST_GROUP_CARDS];
+  struct nta_card_group_t group;
+
+  TEST_REQUIRE(test_cards_open(dev_handles, TEST_GROUP_CARDS + 1));
+  for (size_t ix = 0; ix < TEST_GROUP_CARDS; ++ix)
+  {
+    cards[ix] = &dev_handles[ix];
+  }
+  TEST_REQUIRE(ntpcie_group_init(&group, cards, TEST_GROUP_CARDS) == NTPCIE_ERROR_SUCCESS);
+
+  // the same checks for cards served by caller thread and by IO threads of cards
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      for (size_t ix = 0; ix <= TEST_GROUP_CARDS; ++ix)
+      {
+        TEST_REQUIRE(ntpcie_device_queue_start(&dev_handles[ix]) == NTPCIE_ERROR_SUCCESS);
+      }
+    }
+    test_group_vs_card(&group, &dev_handles[TEST_GROUP_CARDS]);
+    test_group_busy(&group);
+    test_group_rbf_vs_card(&group, &dev_handles[TEST_GROUP_CARDS]);
+  }
+
+  for (size_t ix = 0; ix <= TEST_GROUP_CARDS; ++ix)
+  {
+    ntpcie_device_queue_stop(&dev_handles[ix]);
+  }
+  test_cards_close(dev_handles, TEST_GROUP_CARDS + 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// KNN responses: distances are the same, categories are the same up to order of equal distances
+// (and choice among neurons of the last distance which don't all fit into K responses)
+static int test_group_vs_card(struct nta_card_group_t* const group, struct nta_dev_handle_t* const card)
+{
+  size_t learned[TEST_GROUP_CARDS] = { 0 };
+
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  TEST_REQUIRE(ntpcie_group_nn_reset(group) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_nn_reset(card) == NTPCIE_ERROR_SUCCESS);
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    size_t card_ix = 0;
+
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_REQUIRE(ntpcie_group_vector_learn(group, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), NN_DEF_MAXIF, NN_DEF_MINIF,
+                                           TEST_COMPS_COUNT, data_vector, &card_ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_REQUIRE(card_ix < TEST_GROUP_CARDS);
+    ++learned[card_ix];
+    TEST_REQUIRE(ntpcie_nn_vector_learn(card, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), NN_DEF_MAXIF, NN_DEF_MINIF,
+                                        TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  // KB is spread over all cards of group
+  for (size_t ix = 0; ix < TEST_GROUP_CARDS; ++ix)
+  {
+    TEST_CHECK(learned[ix] > 0);
+  }
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    size_t count_group = TEST_RESP_COUNT;
+    size_t count_card  = TEST_RESP_COUNT;
+    size_t cards_ix[TEST_RESP_COUNT];
+    struct response_neuron_state_t resp_group[TEST_RESP_COUNT];
+    struct response_neuron_state_t resp_card[TEST_RESP_COUNT];
+
+    // learned vector (odd) or vector near it
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    if ((ix % 2) == 0)
+    {
+      data_vector[3] ^= 0x05u;
+    }
+
+    TEST_CHECK(ntpcie_group_vector_classify(group, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                            &count_group, resp_group, cards_ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(ntpcie_nn_vector_classify(card, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                         &count_card, resp_card) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(count_group == count_card);
+    if (count_group != count_card || count_card == 0)
+    {
+      continue;
+    }
+
+    TEST_CHECK((ix % 2) == 0 || ((resp_group[0].distance == 0) && (resp_group[0].category == ix + 1)));
+
+    test_resp_sort(resp_group, count_group);
+    test_resp_sort(resp_card, count_card);
+
+    const uint16_t distance_last = resp_card[count_card - 1].distance;
+    for (size_t ix_resp = 0; ix_resp < count_card; ++ix_resp)
+    {
+      TEST_CHECK(resp_group[ix_resp].distance == resp_card[ix_resp].distance);
+      TEST_CHECK((resp_card[ix_resp].distance == distance_last) ||
+                 (resp_group[ix_resp].category == resp_card[ix_resp].category));
+    }
+    for (size_t ix_resp = 0; ix_resp < count_group; ++ix_resp)
+    {
+      TEST_CHECK(cards_ix[ix_resp] < TEST_GROUP_CARDS);
+    }
+  }
+
+  return 0;
+}
+
+// clusters of near vectors with repeating categories: recognized vectors are not committed again,
+// fired neurons of other category shrink on every card, so RBF responses (fired neurons) are the same
+static int test_group_rbf_vs_card(struct nta_card_group_t* const group, struct nta_dev_handle_t* const card)
+{
+  size_t committed_group = 0;
+  size_t probes_fired    = 0;
+
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  TEST_REQUIRE(ntpcie_group_nn_reset(group) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_nn_reset(card) == NTPCIE_ERROR_SUCCESS);
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    // cluster: two vectors of one category, two of next one (categories repeat over clusters)
+    const uint16_t category = (uint16_t)(((ix / 4) + (ix % 4) / 2) % 3 + 1);
+    size_t card_ix          = 0;
+
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix / 4);
+    data_vector[ix % 4] ^= (nn_vector_comp_t)(0x04u * (ix % 4));
+    TEST_REQUIRE(ntpcie_group_vector_learn(group, NN_DIST_EVAL_L1, 1, category, TEST_RBF_MAXIF, NN_DEF_MINIF,
+                                           TEST_COMPS_COUNT, data_vector, &card_ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_REQUIRE(card_ix < TEST_GROUP_CARDS);
+    TEST_REQUIRE(ntpcie_nn_vector_learn(card, NN_DIST_EVAL_L1, 1, category, TEST_RBF_MAXIF, NN_DEF_MINIF,
+                                        TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  // group committed the same amount of neurons as single card (some vectors are recognized)
+  for (size_t ix = 0; ix < TEST_GROUP_CARDS; ++ix)
+  {
+    committed_group += group->cards[ix]->nn_state.neurons_committed;
+  }
+  TEST_CHECK(committed_group == card->nn_state.neurons_committed);
+  TEST_CHECK(committed_group < TEST_VECTORS_COUNT);
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    size_t count_group = TEST_RESP_COUNT;
+    size_t count_card  = TEST_RESP_COUNT;
+    struct response_neuron_state_t resp_group[TEST_RESP_COUNT];
+    struct response_neuron_state_t resp_card[TEST_RESP_COUNT];
+
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix / 4);
+    data_vector[(ix + 1) % 4] ^= (nn_vector_comp_t)(0x03u * (ix % 4));
+
+    TEST_CHECK(ntpcie_group_vector_classify(group, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_RBF, TEST_COMPS_COUNT, data_vector,
+                                            &count_group, resp_group, NULL) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(ntpcie_nn_vector_classify(card, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_RBF, TEST_COMPS_COUNT, data_vector,
+                                         &count_card, resp_card) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(count_group == count_card);
+    if (count_group != count_card || count_card == 0)
+    {
+      continue;
+    }
+    ++probes_fired;
+
+    test_resp_sort(resp_group, count_group);
+    test_resp_sort(resp_card, count_card);
+
+    const uint16_t distance_last = resp_card[count_card - 1].distance;
+    for (size_t ix_resp = 0; ix_resp < count_card; ++ix_resp)
+    {
+      TEST_CHECK(resp_group[ix_resp].distance == resp_card[ix_resp].distance);
+      TEST_CHECK((resp_card[ix_resp].distance == distance_last) ||
+                 (resp_group[ix_resp].category == resp_card[ix_resp].category));
+    }
+  }
+  TEST_CHECK(probes_fired > 0);
+
+  return 0;
+}
+
+// group classify is rejected while application request is pending on card of group,
+// and works again after request is polled
+static int test_group_busy(struct nta_card_group_t* const group)
+{
+  size_t count_group = TEST_RESP_COUNT;
+  size_t completions = 0;
+  uint32_t token     = 0;
+  struct nta_completion_t completion;
+  struct response_neuron_state_t resp_app[TEST_RESP_COUNT];
+  struct response_neuron_state_t resp_group[TEST_RESP_COUNT];
+
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  struct nta_dev_handle_t* const card_group = group->cards[1];
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 1);
+
+  TEST_REQUIRE(ntpcie_submit_classify(card_group, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                      TEST_RESP_COUNT, resp_app, &token) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(ntpcie_group_vector_classify(group, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                          &count_group, resp_group, NULL) == NTPCIE_ERROR_BUSY);
+
+  // request of application is completed by its own poll (group didn't consume it)
+  for (int ix = 0; (ix < 1000) && (completions == 0); ++ix)
+  {
+    TEST_REQUIRE(ntpcie_poll_completions(card_group, &completion, 1, &completions) == NTPCIE_ERROR_SUCCESS);
+  }
+  TEST_CHECK((completions == 1) && (completion.token == token) && (completion.result == NTPCIE_ERROR_SUCCESS));
+  TEST_CHECK((completion.number_of_responses > 0) && (resp_app[0].distance == 0) && (resp_app[0].category == 2));
+
+  count_group = TEST_RESP_COUNT;
+  TEST_CHECK(ntpcie_group_vector_classify(group, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                          &count_group, resp_group, NULL) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK((count_group > 0) && (resp_group[0].distance == 0) && (resp_group[0].category == 2));
+
+  return 0;
+}
+
+// responses in order of (distance, category)
+static void test_resp_sort(struct response_neuron_state_t resp[], const size_t count)
+{
+  qsort(resp, count, sizeof(resp[0]), test_resp_compare);
+}
+
+static int test_resp_compare(const void* const resp_a, const void* const resp_b)
+{
+  const struct response_neuron_state_t* const a = (const struct response_neuron_state_t*)resp_a;
+  const struct response_neuron_state_t* const b = (const struct response_neuron_state_t*)resp_b;
+
+  if (a->distance != b->distance)
+  {
+    return (a->distance < b->distance) ? -1 : 1;
+  }
+  return (int)a->category - (int)b->category;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// hybrid card/CPU: requests spilled to CPU engine right after learn get the same responses as card,
+// mirror is patched by learn without reading whole knowledge base back
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_COMPS_COUNT   (16u)
+#define TEST_VECTORS_COUNT (120u)
+#define TEST_PROBES_COUNT  (12u)
+#define TEST_RESP_COUNT    (10u)
+#define TEST_MAXIF         (0x0300u)
+#define TEST_MINIF         (0x0010u)
+
+static struct nn_neuron_t neurons[TEST_VECTORS_COUNT];
+
+/// internal functions
+static unsigned test_hybrid_vs_card(struct nta_card_hybrid_t* const hybrid, struct nta_dev_handle_t* const dev_handle);
+static void test_vector_near(nn_vector_comp_t data_vector[], const size_t ix_vector);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+  struct nta_card_hybrid_t hybrid;
+  struct nn_stats_t stats;
+
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  // zero budget: every request after the first one (which measures card) is spilled to free host slot
+  TEST_REQUIRE(ntpcie_hybrid_init(&hybrid, &dev_handle, 0, 1) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_stats_reset(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  // clusters of near vectors of different categories: learn commits neurons and shrinks AIF of others
+  // (down to MINIF, i.e. some neurons degenerate), mirror is checked after every learn
+  unsigned spilled = 0;
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    test_vector_near(data_vector, ix);
+    TEST_REQUIRE(ntpcie_hybrid_vector_learn(&hybrid, NN_DIST_EVAL_L1, (uint16_t)(1 + ix % 2), (uint16_t)(ix % 5 + 1),
+                                            TEST_MAXIF, TEST_MINIF, TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+    spilled += test_hybrid_vs_card(&hybrid, &dev_handle);
+  }
+  // only the first request (service time of card is not measured yet) is classified by card
+  TEST_CHECK(spilled == TEST_VECTORS_COUNT * TEST_PROBES_COUNT - 1);
+
+  // no request (or learn) read whole knowledge base from card
+  TEST_REQUIRE(ntpcie_stats_get(&dev_handle, &stats) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(stats.oper[NN_STATS_OPER_KBASE_STORE].count == 0);
+  TEST_CHECK(stats.oper[NN_STATS_OPER_NEURON_READ].count >= TEST_VECTORS_COUNT / 5);
+
+  // learned knowledge base has shrunk and degenerated neurons indeed
+  size_t neurons_count = 0;
+  size_t degenerated   = 0;
+  TEST_REQUIRE(ntpcie_kbase_store_all(&dev_handle, neurons, TEST_VECTORS_COUNT, &neurons_count) == NTPCIE_ERROR_SUCCESS);
+  for (size_t ix = 0; ix < neurons_count; ++ix)
+  {
+    degenerated += (neurons[ix].category >> 15) & 0x01u;
+  }
+  TEST_CHECK(degenerated > 0);
+
+  // knowledge base changed directly: mirror is valid again after explicit sync
+  test_vector_near(data_vector, TEST_VECTORS_COUNT);
+  TEST_REQUIRE(ntpcie_nn_vector_learn(&dev_handle, NN_DIST_EVAL_L1, 1, 6, TEST_MAXIF, TEST_MINIF,
+                                      TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_hybrid_mirror_sync(&hybrid) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_hybrid_vs_card(&hybrid, &dev_handle) > 0);
+
+  // empty knowledge base after reset
+  TEST_REQUIRE(ntpcie_hybrid_nn_reset(&hybrid) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_hybrid_vs_card(&hybrid, &dev_handle) > 0);
+
+  TEST_CHECK(ntpcie_hybrid_deinit(&hybrid) == NTPCIE_ERROR_SUCCESS);
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// probes near learned vectors are classified by hybrid and by card: responses are the same,
+// amount of probes classified by CPU engine is returned
+static unsigned test_hybrid_vs_card(struct nta_card_hybrid_t* const hybrid, struct nta_dev_handle_t* const dev_handle)
+{
+  unsigned spilled = 0;
+
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  for (size_t ix = 0; ix < TEST_PROBES_COUNT; ++ix)
+  {
+    const uint16_t context                = (uint16_t)(1 + ix % 2);
+    const enum nn_classifier_t classifier = (ix % 3) ? NN_CLASSIFIER_RBF : NN_CLASSIFIER_KNN;
+
+    size_t count_hybrid = TEST_RESP_COUNT;
+    size_t count_card   = TEST_RESP_COUNT;
+    bool on_host        = false;
+    struct response_neuron_state_t resp_hybrid[TEST_RESP_COUNT];
+    struct response_neuron_state_t resp_card[TEST_RESP_COUNT];
+
+    test_vector_near(data_vector, ix * 11);
+    data_vector[ix % TEST_COMPS_COUNT] ^= 0x03u;
+
+    TEST_CHECK(ntpcie_hybrid_vector_classify(hybrid, NN_DIST_EVAL_L1, context, classifier, TEST_COMPS_COUNT, data_vector,
+                                             &count_hybrid, resp_hybrid, &on_host) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(ntpcie_nn_vector_classify(dev_handle, NN_DIST_EVAL_L1, context, classifier, TEST_COMPS_COUNT, data_vector,
+                                         &count_card, resp_card) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(count_hybrid == count_card);
+    TEST_CHECK(memcmp(resp_hybrid, resp_card, ((count_hybrid < count_card) ? count_hybrid : count_card) * sizeof(resp_card[0])) == 0);
+
+    spilled += (on_host) ? 1u : 0u;
+  }
+
+  return spilled;
+}
+
+// vectors of cluster (5 vectors) differ by few components
+static void test_vector_near(nn_vector_comp_t data_vector[], const size_t ix_vector)
+{
+  test_vector_make(data_vector, TEST_COMPS_COUNT, ix_vector / 5);
+  data_vector[2 + ix_vector % 5] ^= (nn_vector_comp_t)(0x08u * (ix_vector % 5));
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// knowledge base file: save -> load round trip, failed save keeps existing file
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#define test_mkdir(_path) _mkdir(_path)
+#define test_rmdir(_path) _rmdir(_path)
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#define test_mkdir(_path) mkdir(_path, 0755)
+#define test_rmdir(_path) rmdir(_path)
+#endif // _WIN32
+
+#include "ntapcie_tests.h"
+
+#define TEST_COMPS_COUNT   (32u)
+#define TEST_VECTORS_COUNT (300u)
+#define TEST_FILE_PATH     "ntapcie_test_kbfile.bin"
+#define TEST_DIR_PATH      "ntapcie_test_kbfile_dir.bin"
+
+static struct nn_neuron_t neurons_card[TEST_VECTORS_COUNT + 1];
+static struct nn_neuron_t neurons_file[TEST_VECTORS_COUNT + 1];
+
+/// internal functions
+static int test_round_trip(struct nta_dev_handle_t* const dev_handle);
+static int test_failed_save(struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_vectors_learn(struct nta_dev_handle_t* const dev_handle, const size_t vectors_count);
+static bool test_file_exists(const char* const path);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  // the same checks for card served by caller thread and by IO thread of card
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      TEST_REQUIRE(ntpcie_device_queue_start(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+    }
+    test_round_trip(&dev_handle);
+    test_failed_save(&dev_handle);
+  }
+
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+  remove(TEST_FILE_PATH);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// KB loaded from file is the same as KB saved: records, NCOUNT and responses of classify
+static int test_round_trip(struct nta_dev_handle_t* const dev_handle)
+{
+  size_t neurons_count = 0;
+  size_t comps_count   = 0;
+  uint16_t ncount      = 0;
+
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(test_vectors_learn(dev_handle, TEST_VECTORS_COUNT) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_kbase_store_all(dev_handle, neurons_card, TEST_VECTORS_COUNT, &neurons_count) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(neurons_count == TEST_VECTORS_COUNT);
+
+  TEST_REQUIRE(ntpcie_kbase_save_file(dev_handle, TEST_COMPS_COUNT, TEST_FILE_PATH) == NTPCIE_ERROR_SUCCESS);
+
+  TEST_CHECK(ntpcie_kbase_file_read(TEST_FILE_PATH, neurons_file, TEST_VECTORS_COUNT, &neurons_count, &comps_count) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(neurons_count == TEST_VECTORS_COUNT);
+  TEST_CHECK(comps_count == TEST_COMPS_COUNT);
+  TEST_CHECK(memcmp(neurons_card, neurons_file, TEST_VECTORS_COUNT * sizeof(neurons_file[0])) == 0);
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_kbase_load_file(dev_handle, TEST_FILE_PATH) == NTPCIE_ERROR_SUCCESS);
+
+  TEST_CHECK(ntpcie_nn_register_read(dev_handle, CM_NCOUNT, &ncount) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(ncount == TEST_VECTORS_COUNT);
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    size_t number_of_responses = 1;
+    struct response_neuron_state_t resp[1];
+
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_CHECK(ntpcie_nn_vector_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT,
+                                         data_vector, &number_of_responses, resp) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK((number_of_responses == 1) && (resp[0].distance == 0) && (resp[0].category == ix + 1));
+  }
+
+  return 0;
+}
+
+// save which fails leaves existing file intact and removes only its temporary file
+static int test_failed_save(struct nta_dev_handle_t* const dev_handle)
+{
+  size_t neurons_count = 0;
+
+  // KB of card differs from KB in file
+  TEST_REQUIRE(test_vectors_learn(dev_handle, TEST_VECTORS_COUNT + 1) == NTPCIE_ERROR_SUCCESS);
+
+  // temporary file can't be created
+  TEST_REQUIRE(test_mkdir(TEST_FILE_PATH ".tmp") == 0);
+  TEST_CHECK(ntpcie_kbase_save_file(dev_handle, TEST_COMPS_COUNT, TEST_FILE_PATH) == NTPCIE_ERROR_KBASE_FILE_IO);
+  TEST_CHECK(test_rmdir(TEST_FILE_PATH ".tmp") == 0);
+
+  TEST_CHECK(ntpcie_kbase_file_read(TEST_FILE_PATH, neurons_file, TEST_VECTORS_COUNT + 1, &neurons_count, NULL) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(neurons_count == TEST_VECTORS_COUNT);
+  TEST_CHECK(memcmp(neurons_card, neurons_file, TEST_VECTORS_COUNT * sizeof(neurons_file[0])) == 0);
+
+  // complete temporary file can't replace destination (directory)
+  TEST_REQUIRE(test_mkdir(TEST_DIR_PATH) == 0);
+  TEST_CHECK(ntpcie_kbase_save_file(dev_handle, TEST_COMPS_COUNT, TEST_DIR_PATH) == NTPCIE_ERROR_KBASE_FILE_IO);
+  TEST_CHECK(test_file_exists(TEST_DIR_PATH ".tmp") != true);
+  TEST_CHECK(test_rmdir(TEST_DIR_PATH) == 0);
+
+  return 0;
+}
+
+// vectors are learned from the first one (already learned vectors don't change KB)
+static enum ntpcie_nn_error_t test_vectors_learn(struct nta_dev_handle_t* const dev_handle, const size_t vectors_count)
+{
+  enum ntpcie_nn_error_t nn_result = NTPCIE_ERROR_SUCCESS;
+
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  for (size_t ix = 0; (ix < vectors_count) && (nn_result == NTPCIE_ERROR_SUCCESS); ++ix)
+  {
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    nn_result = ntpcie_nn_vector_learn(dev_handle, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), NN_DEF_MAXIF, NN_DEF_MINIF,
+                                       TEST_COMPS_COUNT, data_vector);
+  }
+  return nn_result;
+}
+
+static bool test_file_exists(const char* const path)
+{
+  FILE* const file = fopen(path, "rb");
+  if (file == NULL)
+  {
+    return false;
+  }
+  fclose(file);
+  return true;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// outcome of learn: every flag (and combination) inferred from answer of card, counter examples,
+// recognition which hides shrink of farther neuron of other category, full NN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_COMPS_COUNT (4u)
+#define TEST_MAXIF       (0x0100u)
+#define TEST_MINIF       (0x0002u)
+
+/// internal functions
+static int test_learn_outcome(struct nta_dev_handle_t* const dev_handle);
+static int test_learn_full(struct nta_dev_handle_t* const dev_handle);
+static uint16_t test_learn(struct nta_dev_handle_t* const dev_handle,
+                           const uint16_t context,
+                           const uint16_t category,
+                           const nn_vector_comp_t data_vector[],
+                           struct nn_learn_result_t* const result);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  // the same checks for card served by caller thread and by IO thread of card
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      TEST_REQUIRE(ntpcie_device_queue_start(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+    }
+    test_learn_outcome(&dev_handle);
+    test_learn_full(&dev_handle);
+  }
+
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// A (category 1) and B (category 2) are near each other, other vectors are placed around them (L1 distances)
+static int test_learn_outcome(struct nta_dev_handle_t* const dev_handle)
+{
+  static const nn_vector_comp_t vector_a[TEST_COMPS_COUNT]      = { 10, 10, 10, 10 };
+  static const nn_vector_comp_t vector_b[TEST_COMPS_COUNT]      = { 10, 10, 10, 30 };  // A + 20
+  static const nn_vector_comp_t vector_near_a[TEST_COMPS_COUNT] = { 10, 10, 10, 14 };  // A + 4, B - 16
+  static const nn_vector_comp_t vector_near_b[TEST_COMPS_COUNT] = { 10, 10, 10, 28 };  // B - 2, A + 18
+  static const nn_vector_comp_t vector_far[TEST_COMPS_COUNT]    = { 200, 200, 200, 200 };
+
+  struct nn_learn_result_t result;
+  struct nn_neuron_t neuron;
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  // nothing fires: neuron is committed, no shrink
+  TEST_CHECK(test_learn(dev_handle, 1, 1, vector_a, &result) == NN_LEARN_COMMITTED);
+  TEST_CHECK((result.category == 0) && (result.ncount == 1));
+
+  // the same vector again: recognized, nothing committed
+  TEST_CHECK(test_learn(dev_handle, 1, 1, vector_a, &result) == NN_LEARN_RECOGNIZED);
+  TEST_CHECK((result.category == 1) && (result.ncount == 1));
+
+  // A of other category fires: A is shrunk and B is committed (both flags)
+  TEST_CHECK(test_learn(dev_handle, 1, 2, vector_b, &result) == (NN_LEARN_COMMITTED | NN_LEARN_SHRUNK));
+  TEST_CHECK((result.category == 1) && (result.ncount == 2));
+  TEST_REQUIRE(ntpcie_nn_neuron_read(dev_handle, 0, &neuron) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(neuron.aif == 20);
+
+  // A (category 1) is the closest, B (category 2) fires too and is shrunk: card reports recognition only
+  TEST_CHECK(test_learn(dev_handle, 1, 1, vector_near_a, &result) == NN_LEARN_RECOGNIZED);
+  TEST_CHECK((result.category == 1) && (result.ncount == 2));
+  TEST_REQUIRE(ntpcie_nn_neuron_read(dev_handle, 1, &neuron) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(neuron.aif == 16);
+
+  // counter example: the closest fired B is shrunk (down to MINIF, it degenerates), never committed
+  TEST_CHECK(test_learn(dev_handle, 1, 0, vector_near_b, &result) == NN_LEARN_SHRUNK);
+  TEST_CHECK((result.category == 2) && (result.ncount == 2));
+  TEST_REQUIRE(ntpcie_nn_neuron_read(dev_handle, 1, &neuron) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK((neuron.aif == TEST_MINIF) && ((neuron.category & 0x8000u) != 0));
+
+  // counter example which fires nothing: no flag at all (and not recognized)
+  TEST_CHECK(test_learn(dev_handle, 1, 0, vector_far, &result) == NN_LEARN_NONE);
+  TEST_CHECK((result.category == 0) && (result.ncount == 2));
+
+  // nothing fires in other context
+  TEST_CHECK(test_learn(dev_handle, 2, 2, vector_a, &result) == NN_LEARN_COMMITTED);
+  TEST_CHECK((result.category == 0) && (result.ncount == 3));
+
+  return 0;
+}
+
+// NN is filled by vectors which don't fire each other, the next one gets FULL; the one which fires
+// other category gets FULL and SHRUNK; recognized vector is not FULL (no neuron is needed)
+static int test_learn_full(struct nta_dev_handle_t* const dev_handle)
+{
+  struct nn_learn_result_t result;
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  size_t ix = 0;
+  for (; ix < dev_handle->nn_state.neurons_overall; ++ix)
+  {
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_REQUIRE(ntpcie_nn_vector_learn_ex(dev_handle, NN_DIST_EVAL_L1, 1, 1, 1, 1, TEST_COMPS_COUNT, data_vector,
+                                           &result) == NTPCIE_ERROR_SUCCESS);
+    TEST_REQUIRE(result.outcome == NN_LEARN_COMMITTED);
+  }
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+  TEST_CHECK(test_learn(dev_handle, 1, 1, data_vector, &result) == NN_LEARN_FULL);
+  TEST_CHECK(result.ncount == 0xFFFFu);
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 0);
+  TEST_CHECK(test_learn(dev_handle, 1, 2, data_vector, &result) == (NN_LEARN_FULL | NN_LEARN_SHRUNK));
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 1);
+  TEST_CHECK(test_learn(dev_handle, 1, 1, data_vector, &result) == NN_LEARN_RECOGNIZED);
+
+  return 0;
+}
+
+// outcome of learn (0xFFFF - learn failed)
+static uint16_t test_learn(struct nta_dev_handle_t* const dev_handle,
+                           const uint16_t context,
+                           const uint16_t category,
+                           const nn_vector_comp_t data_vector[],
+                           struct nn_learn_result_t* const result)
+{
+  memset(result, 0xFF, sizeof(*result));
+  if (ntpcie_nn_vector_learn_ex(dev_handle, NN_DIST_EVAL_L1, context, category, TEST_MAXIF, TEST_MINIF,
+                                TEST_COMPS_COUNT, data_vector, result) != NTPCIE_ERROR_SUCCESS)
+  {
+    return 0xFFFFu;
+  }
+  return result->outcome;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// paged classify over KB larger than card: responses are the same as of card holding whole KB
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#if defined(_WIN32)
+#define test_setenv(_name, _value) _putenv_s(_name, _value)
+#else
+#define test_setenv(_name, _value) setenv(_name, _value, 1)
+#endif // _WIN32
+
+#define TEST_COMPS_COUNT   (16u)
+#define TEST_NEURONS_COUNT (1500u)  // partitions of small card: 576 + 576 + 348
+#define TEST_VECTORS_COUNT (200u)
+#define TEST_RESP_COUNT    (10u)
+
+static struct nn_neuron_t neurons[TEST_NEURONS_COUNT];
+static nn_vector_comp_t data_vectors[TEST_VECTORS_COUNT * TEST_COMPS_COUNT];
+static struct response_neuron_state_t resp_card[TEST_VECTORS_COUNT * TEST_RESP_COUNT];
+static struct response_neuron_state_t resp_paged[TEST_VECTORS_COUNT * TEST_RESP_COUNT];
+static size_t count_card[TEST_VECTORS_COUNT];
+static size_t count_paged[TEST_VECTORS_COUNT];
+
+int main(void)
+{
+  size_t neurons_count = 0;
+
+  // card 0 holds one chip (576 neurons), card 1 holds whole KB (4 chips)
+  struct nta_dev_handle_t card_small;
+  struct nta_dev_handle_t card_large;
+
+  test_setenv("NTIA_EMU_CHIPS", "1");
+  TEST_REQUIRE(test_card_open(&card_small, 0));
+  test_setenv("NTIA_EMU_CHIPS", "4");
+  TEST_REQUIRE(test_card_open(&card_large, 1));
+  TEST_REQUIRE(card_small.nn_state.neurons_overall < TEST_NEURONS_COUNT);
+  TEST_REQUIRE(card_large.nn_state.neurons_overall >= TEST_NEURONS_COUNT);
+
+  // KB is learned by large card and read back
+  for (size_t ix = 0; ix < TEST_NEURONS_COUNT; ++ix)
+  {
+    nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_REQUIRE(ntpcie_nn_vector_learn(&card_large, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), NN_DEF_MAXIF,
+                                        NN_DEF_MINIF, TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+  }
+  TEST_REQUIRE(ntpcie_kbase_store_all(&card_large, neurons, TEST_NEURONS_COUNT, &neurons_count) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(neurons_count > card_small.nn_state.neurons_overall);
+
+  // learned vectors (exact matches) and vectors between them (ties and misses)
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    test_vector_make(&data_vectors[ix * TEST_COMPS_COUNT], TEST_COMPS_COUNT, ix * 7);
+    if (ix % 2)
+    {
+      data_vectors[ix * TEST_COMPS_COUNT + 2] ^= 0x11u;
+    }
+  }
+
+  for (int ix_dist = 0; ix_dist < 2; ++ix_dist)
+  {
+    const enum nn_dist_eval_t dist_eval = (ix_dist == 0) ? NN_DIST_EVAL_L1 : NN_DIST_EVAL_LSUP;
+
+    for (int ix_classifier = 0; ix_classifier < 2; ++ix_classifier)
+    {
+      const enum nn_classifier_t classifier = (ix_classifier == 0) ? NN_CLASSIFIER_KNN : NN_CLASSIFIER_RBF;
+
+      TEST_CHECK(ntpcie_nn_vectors_classify_batch(&card_large, dist_eval, 1, classifier, TEST_COMPS_COUNT,
+                                                  TEST_VECTORS_COUNT, data_vectors, 0, TEST_RESP_COUNT,
+                                                  count_card, resp_card, NULL) == NTPCIE_ERROR_SUCCESS);
+      TEST_CHECK(ntpcie_kbase_paged_classify_batch(&card_small, neurons, neurons_count, dist_eval, 1, classifier,
+                                                   TEST_COMPS_COUNT, TEST_VECTORS_COUNT, data_vectors, 0,
+                                                   TEST_RESP_COUNT, count_paged, resp_paged) == NTPCIE_ERROR_SUCCESS);
+
+      // every learned vector is recognized (exact match is the first response)
+      for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ix += 2)
+      {
+        TEST_CHECK((count_card[ix] > 0) && (resp_card[ix * TEST_RESP_COUNT].distance == 0));
+      }
+
+      for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+      {
+        TEST_CHECK(count_paged[ix] == count_card[ix]);
+        TEST_CHECK(memcmp(&resp_paged[ix * TEST_RESP_COUNT], &resp_card[ix * TEST_RESP_COUNT],
+                          count_card[ix] * sizeof(resp_card[0])) == 0);
+      }
+    }
+  }
+
+  // empty batch and batch which responses don't fit into address space are rejected
+  TEST_CHECK(ntpcie_kbase_paged_classify_batch(&card_small, neurons, neurons_count, NN_DIST_EVAL_L1, 1,
+                                               NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, 0, data_vectors, 0,
+                                               TEST_RESP_COUNT, count_paged, resp_paged) == NTPCIE_ERROR_ARGS_VECTORS_COUNT);
+  TEST_CHECK(ntpcie_kbase_paged_classify_batch(&card_small, neurons, neurons_count, NN_DIST_EVAL_L1, 1,
+                                               NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, SIZE_MAX / 2, data_vectors, 0,
+                                               TEST_RESP_COUNT, count_paged, resp_paged) == NTPCIE_ERROR_ARGS_VECTORS_COUNT);
+
+  ntpcie_device_close(&card_large);
+  ntpcie_sys_deinit(&card_large);
+  ntpcie_device_close(&card_small);
+  ntpcie_sys_deinit(&card_small);
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// card pool: init rejects bad and repeated cards (IO threads it started are stopped), requests are
+// routed to every replica, card which failed learn is excluded till reset
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_CARDS_COUNT   (3u)
+#define TEST_COMPS_COUNT   (16u)
+#define TEST_VECTORS_COUNT (20u)
+#define TEST_RESP_COUNT    (4u)
+#define TEST_MAXIF         (0x0100u)
+#define TEST_MINIF         (0x0002u)
+
+static struct nta_dev_handle_t dev_handles[TEST_CARDS_COUNT];
+
+/// internal functions
+static int test_pool_init_errors(void);
+static int test_pool_routing(void);
+static int test_pool_exclusion(void);
+static bool test_queue_is_started(const struct nta_dev_handle_t* const dev_handle);
+static enum ntpcie_nn_error_t test_pool_classify(struct nta_card_pool_t* const pool, const size_t ix_vector,
+                                                 size_t* const card_ix);
+
+int main(void)
+{
+  TEST_REQUIRE(test_cards_open(dev_handles, TEST_CARDS_COUNT));
+
+  test_pool_init_errors();
+  test_pool_routing();
+  test_pool_exclusion();
+
+  test_cards_close(dev_handles, TEST_CARDS_COUNT);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// failed init leaves cards as they were: IO threads started by init are stopped, IO thread
+// started by application keeps running
+static int test_pool_init_errors(void)
+{
+  struct nta_card_pool_t pool;
+  struct nta_dev_handle_t handle_copy = dev_handles[1];
+  struct nta_dev_handle_t handle_bad;
+
+  memset(&handle_bad, 0, sizeof(handle_bad));
+
+  struct nta_dev_handle_t* cards_repeated[] = { &dev_handles[0], &dev_handles[1], &dev_handles[0] };
+  struct nta_dev_handle_t* cards_copied[]   = { &dev_handles[0], &dev_handles[1], &handle_copy };
+  struct nta_dev_handle_t* cards_invalid[]  = { &dev_handles[0], &dev_handles[1], &handle_bad };
+
+  TEST_CHECK(ntpcie_pool_init(&pool, cards_repeated, 3) == NTPCIE_ERROR_INVALID_HANDLE);
+  TEST_CHECK(ntpcie_pool_init(&pool, cards_copied, 3) == NTPCIE_ERROR_INVALID_HANDLE);
+  TEST_CHECK(ntpcie_pool_init(&pool, cards_invalid, 3) == NTPCIE_ERROR_INVALID_HANDLE);
+  TEST_CHECK(pool._pool_handle == NULL);
+  TEST_CHECK(!test_queue_is_started(&dev_handles[0]) && !test_queue_is_started(&dev_handles[1]));
+
+  TEST_REQUIRE(ntpcie_device_queue_start(&dev_handles[1]) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(ntpcie_pool_init(&pool, cards_invalid, 3) == NTPCIE_ERROR_INVALID_HANDLE);
+  TEST_CHECK(!test_queue_is_started(&dev_handles[0]) && test_queue_is_started(&dev_handles[1]));
+  TEST_CHECK(ntpcie_device_queue_stop(&dev_handles[1]) == NTPCIE_ERROR_SUCCESS);
+
+  TEST_CHECK(ntpcie_pool_init(&pool, cards_invalid, 0) == NTPCIE_ERROR_ARGS_CARDS_COUNT);
+  TEST_CHECK(ntpcie_pool_init(&pool, cards_invalid, NTIA_PCIE_MAX_CARDS + 1) == NTPCIE_ERROR_ARGS_CARDS_COUNT);
+
+  return 0;
+}
+
+// cards not measured yet are the cheapest: first requests visit every card once; replicas are
+// identical, responses don't depend on card
+static int test_pool_routing(void)
+{
+  struct nta_card_pool_t pool;
+  struct nta_dev_handle_t* cards[TEST_CARDS_COUNT];
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  size_t card_ix = 0;
+
+  for (size_t ix = 0; ix < TEST_CARDS_COUNT; ++ix)
+  {
+    cards[ix] = &dev_handles[ix];
+  }
+
+  TEST_REQUIRE(ntpcie_pool_init(&pool, cards, TEST_CARDS_COUNT) == NTPCIE_ERROR_SUCCESS);
+  for (size_t ix = 0; ix < TEST_CARDS_COUNT; ++ix)
+  {
+    TEST_CHECK(test_queue_is_started(&dev_handles[ix]));
+  }
+
+  TEST_REQUIRE(ntpcie_pool_nn_reset(&pool) == NTPCIE_ERROR_SUCCESS);
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_REQUIRE(ntpcie_pool_vector_learn(&pool, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), TEST_MAXIF, TEST_MINIF,
+                                          TEST_COMPS_COUNT, data_vector, &card_ix) == NTPCIE_ERROR_SUCCESS);
+  }
+
+  for (size_t ix = 0; ix < TEST_CARDS_COUNT; ++ix)
+  {
+    TEST_CHECK(test_pool_classify(&pool, ix, &card_ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(card_ix == ix);
+  }
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    TEST_CHECK(test_pool_classify(&pool, ix, &card_ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(card_ix < TEST_CARDS_COUNT);
+  }
+
+  // IO threads belong to cards (not to pool)
+  TEST_CHECK(ntpcie_pool_deinit(&pool) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_queue_is_started(&dev_handles[0]));
+
+  return 0;
+}
+
+// lost card fails learn: it is excluded (other replicas learn the vector), reset can't bring it
+// back; pool without cards is inconsistent
+static int test_pool_exclusion(void)
+{
+  struct nta_card_pool_t pool;
+  struct nta_dev_handle_t* cards[TEST_CARDS_COUNT];
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  size_t card_ix = 0;
+
+  for (size_t ix = 0; ix < TEST_CARDS_COUNT; ++ix)
+  {
+    cards[ix] = &dev_handles[ix];
+  }
+
+  TEST_REQUIRE(ntpcie_pool_init(&pool, cards, TEST_CARDS_COUNT) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_pool_nn_reset(&pool) == NTPCIE_ERROR_SUCCESS);
+
+  TEST_REQUIRE(ntpcie_device_close(&dev_handles[1]) == NTPCIE_ERROR_SUCCESS);
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 0);
+  card_ix = TEST_CARDS_COUNT;
+  TEST_CHECK(ntpcie_pool_vector_learn(&pool, NN_DIST_EVAL_L1, 1, 1, TEST_MAXIF, TEST_MINIF, TEST_COMPS_COUNT,
+                                      data_vector, &card_ix) != NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(card_ix == 1);
+
+  // the next learn is done by the rest of cards
+  test_vector_make(data_vector, TEST_COMPS_COUNT, 1);
+  TEST_CHECK(ntpcie_pool_vector_learn(&pool, NN_DIST_EVAL_L1, 1, 2, TEST_MAXIF, TEST_MINIF, TEST_COMPS_COUNT,
+                                      data_vector, &card_ix) == NTPCIE_ERROR_SUCCESS);
+
+  for (size_t ix = 0; ix < 4 * TEST_CARDS_COUNT; ++ix)
+  {
+    TEST_CHECK(test_pool_classify(&pool, ix % 2, &card_ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(card_ix != 1);
+  }
+
+  TEST_CHECK(ntpcie_pool_nn_reset(&pool) != NTPCIE_ERROR_SUCCESS);
+  for (size_t ix = 0; ix < 2; ++ix)
+  {
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_CHECK(ntpcie_pool_vector_learn(&pool, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), TEST_MAXIF, TEST_MINIF,
+                                        TEST_COMPS_COUNT, data_vector, &card_ix) == NTPCIE_ERROR_SUCCESS);
+  }
+  for (size_t ix = 0; ix < 4 * TEST_CARDS_COUNT; ++ix)
+  {
+    TEST_CHECK(test_pool_classify(&pool, ix % 2, &card_ix) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(card_ix != 1);
+  }
+
+  // every card is lost
+  TEST_REQUIRE(ntpcie_device_close(&dev_handles[0]) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_device_close(&dev_handles[2]) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(ntpcie_pool_vector_learn(&pool, NN_DIST_EVAL_L1, 1, 3, TEST_MAXIF, TEST_MINIF, TEST_COMPS_COUNT,
+                                      data_vector, &card_ix) != NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_pool_classify(&pool, 0, &card_ix) == NTPCIE_ERROR_POOL_INCONSISTENT);
+  TEST_CHECK(ntpcie_pool_vector_learn(&pool, NN_DIST_EVAL_L1, 1, 3, TEST_MAXIF, TEST_MINIF, TEST_COMPS_COUNT,
+                                      data_vector, &card_ix) == NTPCIE_ERROR_POOL_INCONSISTENT);
+
+  TEST_CHECK(ntpcie_pool_deinit(&pool) == NTPCIE_ERROR_SUCCESS);
+
+  return 0;
+}
+
+static bool test_queue_is_started(const struct nta_dev_handle_t* const dev_handle)
+{
+  bool started = false;
+  TEST_CHECK(ntpcie_device_queue_is_started(dev_handle, &started) == NTPCIE_ERROR_SUCCESS);
+  return started;
+}
+
+// KNN classify of learned vector by pool, responses are checked against learned category
+static enum ntpcie_nn_error_t test_pool_classify(struct nta_card_pool_t* const pool, const size_t ix_vector,
+                                                 size_t* const card_ix)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  struct response_neuron_state_t resp[TEST_RESP_COUNT];
+  size_t resp_count = TEST_RESP_COUNT;
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, ix_vector);
+  const enum ntpcie_nn_error_t nn_result = ntpcie_pool_vector_classify(pool, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN,
+                                                                       TEST_COMPS_COUNT, data_vector, &resp_count,
+                                                                       resp, card_ix);
+  if (nn_result == NTPCIE_ERROR_SUCCESS)
+  {
+    TEST_CHECK((resp_count > 0) && (resp[0].distance == 0) && (resp[0].category == ix_vector + 1));
+  }
+  return nn_result;
+}
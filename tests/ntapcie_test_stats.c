@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+// statistics of operations: latency is taken from API call (covers every phase), requests answered
+// by cache of classify results are counted too
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ntapcie_tests.h"
+
+#define TEST_COMPS_COUNT   (16u)
+#define TEST_VECTORS_COUNT (8u)
+#define TEST_RESP_COUNT    (4u)
+#define TEST_MAXIF         (0x0100u)
+#define TEST_MINIF         (0x0002u)
+
+/// internal functions
+static int test_stats_latency(struct nta_dev_handle_t* const dev_handle);
+static int test_stats_cache_hits(struct nta_dev_handle_t* const dev_handle);
+static bool test_classify(struct nta_dev_handle_t* const dev_handle, const size_t ix_vector);
+
+int main(void)
+{
+  struct nta_dev_handle_t dev_handle;
+
+  TEST_REQUIRE(test_cards_open(&dev_handle, 1));
+
+  // the same checks for card served by caller thread and by IO thread of card
+  for (int queued = 0; queued < 2; ++queued)
+  {
+    if (queued)
+    {
+      TEST_REQUIRE(ntpcie_device_queue_start(&dev_handle) == NTPCIE_ERROR_SUCCESS);
+    }
+    test_stats_latency(&dev_handle);
+    test_stats_cache_hits(&dev_handle);
+  }
+
+  ntpcie_device_queue_stop(&dev_handle);
+  test_cards_close(&dev_handle, 1);
+
+  return TEST_RESULT();
+}
+
+/// internal functions
+
+// every operation is counted once, its latency is not less than sum of its phases
+static int test_stats_latency(struct nta_dev_handle_t* const dev_handle)
+{
+  struct nn_stats_t stats;
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_stats_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+  {
+    test_vector_make(data_vector, TEST_COMPS_COUNT, ix);
+    TEST_REQUIRE(ntpcie_nn_vector_learn(dev_handle, NN_DIST_EVAL_L1, 1, (uint16_t)(ix + 1), TEST_MAXIF, TEST_MINIF,
+                                        TEST_COMPS_COUNT, data_vector) == NTPCIE_ERROR_SUCCESS);
+    TEST_CHECK(test_classify(dev_handle, ix));
+  }
+
+  TEST_REQUIRE(ntpcie_stats_get(dev_handle, &stats) == NTPCIE_ERROR_SUCCESS);
+  static const enum nn_stats_oper_t opers[] = { NN_STATS_OPER_LEARN, NN_STATS_OPER_CLASSIFY };
+  for (size_t ix = 0; ix < sizeof(opers) / sizeof(opers[0]); ++ix)
+  {
+    const struct nn_oper_stats_t* const oper = &stats.oper[opers[ix]];
+
+    uint64_t phases_ns = 0;
+    uint64_t buckets   = 0;
+    for (size_t ix_phase = 0; ix_phase < NN_STATS_PHASE_COUNT; ++ix_phase)
+    {
+      phases_ns += oper->phase_total_ns[ix_phase];
+    }
+    for (size_t ix_bucket = 0; ix_bucket < NN_STATS_BUCKETS; ++ix_bucket)
+    {
+      buckets += oper->buckets[ix_bucket];
+    }
+    TEST_CHECK(oper->count == TEST_VECTORS_COUNT);
+    TEST_CHECK(buckets == TEST_VECTORS_COUNT);
+    TEST_CHECK(oper->cache_hits == 0);
+    TEST_CHECK(oper->time_total_ns >= phases_ns);
+    TEST_CHECK(oper->time_max_ns <= oper->time_total_ns);
+  }
+
+  return 0;
+}
+
+// requests answered by cache are counted in count and in cache_hits, change of knowledge base
+// drops cache (the next request is answered by card)
+static int test_stats_cache_hits(struct nta_dev_handle_t* const dev_handle)
+{
+  struct nn_stats_t stats;
+
+  TEST_REQUIRE(ntpcie_device_cache_start(dev_handle, 64) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_stats_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  for (int pass = 0; pass < 3; ++pass)
+  {
+    for (size_t ix = 0; ix < TEST_VECTORS_COUNT; ++ix)
+    {
+      TEST_CHECK(test_classify(dev_handle, ix));
+    }
+  }
+
+  TEST_REQUIRE(ntpcie_stats_get(dev_handle, &stats) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(stats.oper[NN_STATS_OPER_CLASSIFY].count == 3 * TEST_VECTORS_COUNT);
+  TEST_CHECK(stats.oper[NN_STATS_OPER_CLASSIFY].cache_hits == 2 * TEST_VECTORS_COUNT);
+
+  TEST_REQUIRE(ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(test_classify(dev_handle, 0));
+  TEST_REQUIRE(ntpcie_stats_get(dev_handle, &stats) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK(stats.oper[NN_STATS_OPER_CLASSIFY].count == 3 * TEST_VECTORS_COUNT + 1);
+  TEST_CHECK(stats.oper[NN_STATS_OPER_CLASSIFY].cache_hits == 2 * TEST_VECTORS_COUNT);
+
+  TEST_CHECK(ntpcie_stats_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+  TEST_REQUIRE(ntpcie_stats_get(dev_handle, &stats) == NTPCIE_ERROR_SUCCESS);
+  TEST_CHECK((stats.oper[NN_STATS_OPER_CLASSIFY].count == 0) && (stats.oper[NN_STATS_OPER_CLASSIFY].cache_hits == 0));
+
+  TEST_CHECK(ntpcie_device_cache_stop(dev_handle) == NTPCIE_ERROR_SUCCESS);
+
+  return 0;
+}
+
+// KNN classify of learned vector
+static bool test_classify(struct nta_dev_handle_t* const dev_handle, const size_t ix_vector)
+{
+  nn_vector_comp_t data_vector[TEST_COMPS_COUNT];
+  struct response_neuron_state_t resp[TEST_RESP_COUNT];
+  size_t resp_count = TEST_RESP_COUNT;
+
+  test_vector_make(data_vector, TEST_COMPS_COUNT, ix_vector);
+  return (ntpcie_nn_vector_classify(dev_handle, NN_DIST_EVAL_L1, 1, NN_CLASSIFIER_KNN, TEST_COMPS_COUNT, data_vector,
+                                    &resp_count, resp) == NTPCIE_ERROR_SUCCESS);
+}
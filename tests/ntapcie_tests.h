@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2017-2019 NeuroTechnologijos UAB
+ * (https://www.neurotechnologijos.com)
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#ifndef NTAPCIE_TESTS_H
+#define NTAPCIE_TESTS_H
+
+// helpers of behaviour tests: tests are run by ctest against software emulator of card
+// (NTIA_PCIE_TRANSPORT=emu, see tests/CMakeLists.txt)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ntia_api.h"
+#include "ntia_api_ll.h"
+
+static unsigned test_failures = 0;
+
+// failed check is reported and counted, test goes on
+#define TEST_CHECK(_cond)                                                           \
+  do                                                                                \
+  {                                                                                 \
+    if (!(_cond))                                                                   \
+    {                                                                               \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #_cond);     \
+      ++test_failures;                                                              \
+    }                                                                               \
+  } while (0)
+
+// step without which test (or its part) can't go on
+#define TEST_REQUIRE(_cond)                                                         \
+  do                                                                                \
+  {                                                                                 \
+    if (!(_cond))                                                                   \
+    {                                                                               \
+      fprintf(stderr, "%s:%d: required: %s\n", __FILE__, __LINE__, #_cond);         \
+      ++test_failures;                                                              \
+      return 1;                                                                     \
+    }                                                                               \
+  } while (0)
+
+#define TEST_RESULT() ((test_failures == 0) ? 0 : 1)
+
+// open card number ix_card of emulator (NN is reset)
+static inline bool test_card_open(struct nta_dev_handle_t* const dev_handle, const size_t ix_card)
+{
+  struct nta_pcidev_list_t devs_list;
+
+  if (ntpcie_sys_init(dev_handle, &devs_list) != NTPCIE_ERROR_SUCCESS)
+  {
+    return false;
+  }
+  else if (devs_list.devs_count <= ix_card)
+  {
+    fprintf(stderr, "card %zu is required (NTIA_EMU_CARDS)\n", ix_card);
+    return false;
+  }
+  else if (ntpcie_device_open(dev_handle, devs_list.devices[ix_card].bus, devs_list.devices[ix_card].slot,
+                              devs_list.devices[ix_card].func) != NTPCIE_ERROR_SUCCESS)
+  {
+    return false;
+  }
+  return (ntpcie_nn_reset(dev_handle) == NTPCIE_ERROR_SUCCESS);
+}
+
+// open first cards_count cards (handles must be closed by test_cards_close)
+static inline bool test_cards_open(struct nta_dev_handle_t dev_handles[], const size_t cards_count)
+{
+  for (size_t ix = 0; ix < cards_count; ++ix)
+  {
+    if (test_card_open(&dev_handles[ix], ix) != true)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static inline void test_cards_close(struct nta_dev_handle_t dev_handles[], const size_t cards_count)
+{
+  for (size_t ix = 0; ix < cards_count; ++ix)
+  {
+    ntpcie_device_close(&dev_handles[ix]);
+    ntpcie_sys_deinit(&dev_handles[ix]);
+  }
+}
+
+// deterministic vector number ix_vector (distinct vectors for distinct numbers)
+static inline void test_vector_make(nn_vector_comp_t data_vector[], const size_t comps_count, const size_t ix_vector)
+{
+  for (size_t ix = 0; ix < comps_count; ++ix)
+  {
+    data_vector[ix] = (nn_vector_comp_t)((ix_vector * 53u + ix * 17u + ix_vector * ix) & 0xFFu);
+  }
+  data_vector[0] = (nn_vector_comp_t)(ix_vector & 0xFFu);
+  data_vector[1] = (nn_vector_comp_t)((ix_vector >> 8) & 0xFFu);
+}
+
+#endif // NTAPCIE_TESTS_H